@@ -39,6 +39,10 @@ namespace Xapian {
 
 #ifndef XAPIAN_HAS_REMOTE_BACKEND
     namespace Remote {
+	static Database open(const string &, unsigned int, unsigned, unsigned, int) {
+	    throw FeatureUnavailableError("Remote backend not supported");
+	}
+
 	static Database open(const string &, unsigned int, unsigned = 0, unsigned = 0) {
 	    throw FeatureUnavailableError("Remote backend not supported");
 	}
@@ -458,6 +458,12 @@ class Remote {
     Remote();
     ~Remote();
   public:
+    static Database open(const std::string &host,
+			 unsigned int port,
+			 unsigned timeout,
+			 unsigned connect_timeout,
+			 int flags);
+
     static Database open(const std::string &host,
 			 unsigned int port,
 			 unsigned timeout = 10000,
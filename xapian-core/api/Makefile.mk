@@ -51,6 +51,7 @@ lib_src +=\
 	api/valueiterator.cc\
 	api/valuerangeproc.cc\
 	api/valuesetmatchdecider.cc\
+	api/vectorpostingsource.cc\
 	api/vectortermlist.cc
 
 if BUILD_BACKEND_REMOTE
@@ -387,6 +387,12 @@ Database::keep_alive()
     internal->keep_alive();
 }
 
+void
+Database::cache_values(Xapian::valueno slot) const
+{
+    internal->cache_values(slot);
+}
+
 string
 Database::get_description() const
 {
@@ -1,13 +1,14 @@
 /** @file
  * @brief Edit distance calculation algorithm.
  *
- *  Based on that described in:
+ *  We use the bit-vector algorithm described in:
  *
- *  "An extension of Ukkonen's enhanced dynamic programming ASM algorithm"
- *  by Hal Berghel, University of Arkansas
- *  and David Roach, Acxiom Corporation
+ *  "A Bit-Vector Algorithm for Computing Levenshtein and Damerau Edit
+ *  Distances" by Heikki Hyyrö, Nordic Journal of Computing 10 (2003)
  *
- *  http://berghel.net/publications/asm/asm.php
+ *  which extends Myers' bit-parallel algorithm to allow transpositions of
+ *  adjacent characters.  This processes one character of the candidate per
+ *  step for up to 64 characters of target at once.
  */
 /* Copyright (C) 2003 Richard Boulton
  * Copyright (C) 2007,2008,2009,2017,2019,2020 Olly Betts
@@ -31,165 +32,135 @@
 
 #include "editdistance.h"
 
-#include "omassert.h"
 #include "popcount.h"
 
 #include <algorithm>
-#include <climits>
-#include <cstdlib>
-#include <cstring>
 
 using namespace std;
 
-template<class Char>
-struct edist_seq {
-    edist_seq(const Char* ptr_, int len_) : ptr(ptr_), len(len_) { }
-    const Char* ptr;
-    int len;
-};
-
-template<class Char>
-class edist_state {
-    /// Don't allow assignment.
-    edist_state& operator=(const edist_state&) = delete;
-
-    /// Don't allow copying.
-    edist_state(const edist_state&) = delete;
-
-    edist_seq<Char> seq1;
-    edist_seq<Char> seq2;
-
-    /* Array of f(k,p) values, where f(k,p) = the largest index i such that
-     * d(i,j) = p and d(i,j) is on diagonal k.
-     * ie: f(k,p) = largest i s.t. d(i,k+i) = p
-     * Where: d(i,j) = edit distance between substrings of length i and j.
-     */
-    int* fkp;
-    int fkp_rows;
-
-    /* Maximum possible edit distance (this is referred to as ZERO_K in
-     * the algorithm description by Berghel and Roach). */
-    int maxdist;
-
-    int calc_index(int k, int p) const {
-	return k + maxdist + fkp_rows * (p + 1);
-    }
-
-  public:
-    edist_state(const Char* ptr1, int len1, const Char* ptr2, int len2,
-		int* fkp_)
-	: seq1(ptr1, len1), seq2(ptr2, len2), fkp(fkp_), maxdist(len2) {
-	Assert(len2 >= len1);
-	// fkp is stored as a rectangular array, column by column.  Each entry
-	// represents a value of p, from -1 to maxdist or a special value
-	// close-ish to INT_MIN.
-	fkp_rows = 2 * maxdist + 1;
-	// It's significantly faster to memset() than std::fill_n() with an int
-	// value, so fill with the msb of INT_MIN, which for 32-bit 2's
-	// complement int means -2139062144 instead of -2147483648, which is
-	// fine what we need here.
-	memset(fkp, unsigned(INT_MIN) >> (8 * (sizeof(int) - 1)),
-	       sizeof(int) * (calc_index(maxdist, maxdist - 2) + 1));
-	set_f_kp(0, -1, -1);
-	for (int k = 1; k <= maxdist; ++k) {
-	    set_f_kp(k, k - 1, -1);
-	    set_f_kp(-k, k - 1, k - 1);
-	}
-    }
-
-    int get_f_kp(int k, int p) const {
-	return fkp[calc_index(k, p)];
-    }
-
-    void set_f_kp(int k, int p, int val) {
-	fkp[calc_index(k, p)] = val;
-    }
-
-    bool is_transposed(int pos1, int pos2) const {
-	if (pos1 <= 0 || pos2 <= 0 || pos1 >= seq1.len || pos2 >= seq2.len)
-	    return false;
-	return (seq1.ptr[pos1 - 1] == seq2.ptr[pos2] &&
-		seq1.ptr[pos1] == seq2.ptr[pos2 - 1]);
-    }
-
-    void edist_calc_f_kp(int k, int p);
-};
-
-template<class Char>
-void edist_state<Char>::edist_calc_f_kp(int k, int p)
+void
+EditDistanceCalculator::init_pm()
 {
-    int maxlen = get_f_kp(k, p - 1) + 1; /* dist if do substitute */
-    int maxlen2 = get_f_kp(k - 1, p - 1); /* dist if do insert */
-    int maxlen3 = get_f_kp(k + 1, p - 1) + 1; /* dist if delete */
+    words = (target.size() + PM_WORD_BITS - 1) / PM_WORD_BITS;
+    // Ensure there's always at least one word so the all-zero entry exists.
+    if (words == 0) words = 1;
 
-    if (is_transposed(maxlen, maxlen + k)) {
-	// Transposition.
-	++maxlen;
+    pm_other_chars.clear();
+    for (unsigned ch : target) {
+	if (ch >= 128) pm_other_chars.push_back(ch);
     }
-
-    if (maxlen >= maxlen2) {
-	if (maxlen >= maxlen3) {
-	    // Transposition or Substitution.
+    sort(pm_other_chars.begin(), pm_other_chars.end());
+    pm_other_chars.erase(unique(pm_other_chars.begin(), pm_other_chars.end()),
+			 pm_other_chars.end());
+
+    pm_ascii.assign(129 * words, 0);
+    pm_other.assign(pm_other_chars.size() * words, 0);
+    for (size_t i = 0; i != target.size(); ++i) {
+	unsigned ch = target[i];
+	pm_word* pm;
+	if (ch < 128) {
+	    pm = &pm_ascii[ch * words];
 	} else {
-	    // Deletion.
-	    maxlen = maxlen3;
-	}
-    } else {
-	if (maxlen2 >= maxlen3) {
-	    // Insertion.
-	    maxlen = maxlen2;
-	} else {
-	    // Deletion.
-	    maxlen = maxlen3;
+	    auto it = lower_bound(pm_other_chars.begin(), pm_other_chars.end(),
+				  ch);
+	    pm = &pm_other[(it - pm_other_chars.begin()) * words];
 	}
+	pm[i / PM_WORD_BITS] |= pm_word(1) << (i % PM_WORD_BITS);
     }
+}
 
-    /* Check for exact matches, and increase the length until we don't have
-     * one. */
-    while (maxlen < seq1.len &&
-	   maxlen + k < seq2.len &&
-	   seq1.ptr[maxlen] == seq2.ptr[maxlen + k]) {
-	++maxlen;
+int
+EditDistanceCalculator::calc_single(const unsigned* ptr, int len,
+				    int max_distance) const
+{
+    const pm_word last = pm_word(1) << (target.size() - 1);
+    // Vertical positive and negative deltas for the current column.
+    pm_word vp = ~pm_word(0);
+    pm_word vn = 0;
+    pm_word d0 = 0;
+    pm_word pm_prev = 0;
+    int score = int(target.size());
+    for (int j = 0; j != len; ++j) {
+	pm_word pm = *get_pm(ptr[j]);
+	// Transposition of the previous and current candidate characters.
+	pm_word tr = (((~d0) & pm) << 1) & pm_prev;
+	d0 = (((pm & vp) + vp) ^ vp) | pm | vn | tr;
+	pm_word hp = vn | ~(d0 | vp);
+	pm_word hn = d0 & vp;
+	if (hp & last) {
+	    ++score;
+	} else if (hn & last) {
+	    --score;
+	}
+	// Each remaining candidate character can reduce score by at most 1.
+	int lb = score - (len - 1 - j);
+	if (lb > max_distance) return lb;
+	pm_word x = (hp << 1) | 1;
+	vn = x & d0;
+	vp = (hn << 1) | ~(x | d0);
+	pm_prev = pm;
     }
-    set_f_kp(k, p, maxlen);
+    return score;
 }
 
-template<class Char>
-static int
-seqcmp_editdist(const Char* ptr1, int len1, const Char* ptr2, int len2,
-		int* fkp_, int max_distance)
+int
+EditDistanceCalculator::calc_blocked(const unsigned* ptr, int len,
+				     int max_distance) const
 {
-    int lendiff = len2 - len1;
-    /* Make sure second sequence is longer (or same length). */
-    if (lendiff < 0) {
-	lendiff = -lendiff;
-	swap(ptr1, ptr2);
-	swap(len1, len2);
+    // This is the same algorithm as calc_single(), but with the bit-vectors
+    // split into blocks of words, with the carries from shifts and additions
+    // propagated from each block to the next.
+    const unsigned last_block = words - 1;
+    const pm_word last = pm_word(1) << ((target.size() - 1) % PM_WORD_BITS);
+    // For each block we store vp, vn, d0 and pm_prev.
+    block_state.assign(words * 4, 0);
+    for (size_t b = 0; b != words; ++b) {
+	block_state[b * 4] = ~pm_word(0);
     }
-
-    /* Special case for if one or both sequences are empty. */
-    if (len1 == 0) return len2;
-
-    edist_state<Char> state(ptr1, len1, ptr2, len2, fkp_);
-
-    int p = lendiff; /* This is the minimum possible edit distance. */
-    while (p <= max_distance) {
-	for (int temp_p = 0; temp_p != p; ++temp_p) {
-	    int inc = p - temp_p;
-	    if (abs(lendiff - inc) <= temp_p) {
-		state.edist_calc_f_kp(lendiff - inc, temp_p);
-	    }
-	    if (abs(lendiff + inc) <= temp_p) {
-		state.edist_calc_f_kp(lendiff + inc, temp_p);
+    int score = int(target.size());
+    for (int j = 0; j != len; ++j) {
+	const pm_word* pms = get_pm(ptr[j]);
+	pm_word hp_carry = 1;
+	pm_word hn_carry = 0;
+	pm_word tr_carry = 0;
+	pm_word add_carry = 0;
+	for (unsigned b = 0; b != words; ++b) {
+	    pm_word* state = &block_state[b * 4];
+	    pm_word vp = state[0];
+	    pm_word vn = state[1];
+	    pm_word pm = pms[b];
+	    pm_word tr_bits = ~state[2] & pm;
+	    pm_word tr = ((tr_bits << 1) | tr_carry) & state[3];
+	    tr_carry = tr_bits >> (PM_WORD_BITS - 1);
+	    pm_word eq = pm & vp;
+	    pm_word sum = eq + vp;
+	    pm_word carry_out = (sum < eq);
+	    sum += add_carry;
+	    carry_out |= (sum < add_carry);
+	    add_carry = carry_out;
+	    pm_word d0 = (sum ^ vp) | pm | vn | tr;
+	    pm_word hp = vn | ~(d0 | vp);
+	    pm_word hn = d0 & vp;
+	    if (b == last_block) {
+		if (hp & last) {
+		    ++score;
+		} else if (hn & last) {
+		    --score;
+		}
 	    }
+	    pm_word x = (hp << 1) | hp_carry;
+	    hp_carry = hp >> (PM_WORD_BITS - 1);
+	    pm_word hn_shifted = (hn << 1) | hn_carry;
+	    hn_carry = hn >> (PM_WORD_BITS - 1);
+	    state[0] = hn_shifted | ~(x | d0);
+	    state[1] = x & d0;
+	    state[2] = d0;
+	    state[3] = pm;
 	}
-	state.edist_calc_f_kp(lendiff, p);
-
-	if (state.get_f_kp(lendiff, p) == len1) break;
-	++p;
+	int lb = score - (len - 1 - j);
+	if (lb > max_distance) return lb;
     }
-
-    return p;
+    return score;
 }
 
 int
@@ -214,17 +185,10 @@ EditDistanceCalculator::calc(const unsigned* ptr, int len,
 	return ed_lower_bound;
     }
 
-    if (!array) {
-	// Allocate space for the largest case we need to consider, which is
-	// when the second sequence is len + max_distance long.  Any second
-	// sequence which is longer must be more than max_distance edits
-	// away.
-	int maxdist = target.size() + max_distance;
-	int max_cols = maxdist * 2;
-	int max_rows = maxdist * 2 + 1;
-	array = new int[max_rows * max_cols];
-    }
+    if (target.empty()) return len;
 
-    return seqcmp_editdist<unsigned>(ptr, len, &target[0], target.size(),
-				     array, max_distance);
+    if (words == 1) {
+	return calc_single(ptr, len, max_distance);
+    }
+    return calc_blocked(ptr, len, max_distance);
 }
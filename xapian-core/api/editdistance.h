@@ -22,8 +22,10 @@
 #ifndef XAPIAN_INCLUDED_EDITDISTANCE_H
 #define XAPIAN_INCLUDED_EDITDISTANCE_H
 
+#include <algorithm>
 #include <cstdlib>
 #include <climits>
+#include <string>
 #include <vector>
 
 #include "omassert.h"
@@ -55,7 +57,35 @@ class EditDistanceCalculator {
     /// Current candidate in UTF-32.
     mutable std::vector<unsigned> utf32;
 
-    mutable int* array = nullptr;
+    /** The type to use for the bit-vectors.
+     *
+     *  Each bit represents one position in the target, so targets of up to
+     *  64 characters are handled with a single word per column, and longer
+     *  targets by a block of words with carries propagated between them.
+     */
+    typedef unsigned long long pm_word;
+
+    static constexpr unsigned PM_WORD_BITS = sizeof(pm_word) * 8;
+
+    /// Number of pm_word-s needed to hold one bit per target character.
+    size_t words;
+
+    /** Match bitmaps for ASCII characters.
+     *
+     *  For each ASCII character there are @a words entries with bit i set if
+     *  target[i] is that character.  There's one extra all-zero set at the
+     *  end which is used for characters which don't occur in target.
+     */
+    std::vector<pm_word> pm_ascii;
+
+    /// Sorted non-ASCII characters which occur in target.
+    std::vector<unsigned> pm_other_chars;
+
+    /// Match bitmaps for pm_other_chars, laid out like pm_ascii.
+    std::vector<pm_word> pm_other;
+
+    /// Per-block state for targets longer than PM_WORD_BITS.
+    mutable std::vector<pm_word> block_state;
 
     /** The type to use for the occurrence bitmaps.
      *
@@ -86,6 +116,27 @@ class EditDistanceCalculator {
 
     static constexpr unsigned FREQS_MASK = sizeof(freqs_bitmap) * 8 - 1;
 
+    /// Build the match bitmaps for target.
+    void init_pm();
+
+    /// Return the match bitmaps for character @a ch.
+    const pm_word* get_pm(unsigned ch) const {
+	if (ch < 128) return &pm_ascii[ch * words];
+	auto it = std::lower_bound(pm_other_chars.begin(),
+				   pm_other_chars.end(), ch);
+	if (it == pm_other_chars.end() || *it != ch) {
+	    // Use the all-zero entry.
+	    return &pm_ascii[128 * words];
+	}
+	return &pm_other[(it - pm_other_chars.begin()) * words];
+    }
+
+    /// Bit-parallel edit distance for a target of at most PM_WORD_BITS.
+    int calc_single(const unsigned* ptr, int len, int max_distance) const;
+
+    /// Bit-parallel edit distance for a target longer than PM_WORD_BITS.
+    int calc_blocked(const unsigned* ptr, int len, int max_distance) const;
+
     /** Calculate edit distance.
      *
      *  Internal helper - the cheap case is inlined from the header.
@@ -106,10 +157,7 @@ class EditDistanceCalculator {
 	    target.push_back(ch);
 	    target_freqs |= freqs_bitmap(1) << (ch & FREQS_MASK);
 	}
-    }
-
-    ~EditDistanceCalculator() {
-	delete [] array;
+	init_pm();
     }
 
     /** Calculate edit distance for a sequence.
@@ -120,9 +168,7 @@ class EditDistanceCalculator {
      *				max_distance, any value > max_distance may be
      *				returned instead (which allows the edit
      *				distance algorithm to avoid work for poor
-     *				matches).  The value passed for subsequent
-     *				calls to this method on the same object must be
-     *				the same or less.
+     *				matches).
      *
      *  @return The edit distance between candidate and the target.
      */
@@ -196,6 +196,12 @@ Enquire::set_time_limit(double time_limit)
     internal->time_limit = time_limit;
 }
 
+void
+Enquire::set_remote_time_limit(double time_limit)
+{
+    internal->remote_time_limit = time_limit;
+}
+
 MSet
 Enquire::get_mset(doccount first,
 		  doccount maxitems,
@@ -306,6 +312,7 @@ Enquire::Internal::get_mset(doccount first,
 		    sort_by,
 		    sort_val_reverse,
 		    time_limit,
+		    remote_time_limit,
 		    matchspies);
 
     MSet mset = match.get_mset(first,
@@ -79,6 +79,8 @@ class Enquire::Internal : public Xapian::Internal::intrusive_base {
 
     double time_limit = 0.0;
 
+    double remote_time_limit = 0.0;
+
     enum { EXPAND_TRAD, EXPAND_BO1 } eweight = EXPAND_TRAD;
 
     double expand_k = 1.0;
@@ -110,8 +112,11 @@ class Enquire::Internal : public Xapian::Internal::intrusive_base {
 	return db.get_document(did, Xapian::DOC_ASSUME_VALID);
     }
 
-    void request_document(docid did) const {
-	db.internal->request_document(did);
+    void open_documents(const std::vector<docid>& dids,
+			const std::vector<valueno>& slots,
+			std::vector<Document>& docs) const {
+	// This is called by MSet::fetch(), so we know the documents exist.
+	db.internal->open_documents(dids, slots, docs);
     }
 };
 
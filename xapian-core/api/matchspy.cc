@@ -28,9 +28,11 @@
 #include <xapian/queryparser.h>
 #include <xapian/registry.h>
 
+#include <algorithm>
 #include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "debuglog.h"
@@ -82,6 +84,44 @@ MatchSpy::get_description() const {
     return "Xapian::MatchSpy()";
 }
 
+/// Internals of a ValueCountMatchSpy.
+struct ValueCountMatchSpy::Internal : public Xapian::Internal::intrusive_base {
+    /// The slot to count.
+    Xapian::valueno slot;
+
+    /// Total number of documents seen by the match spy.
+    Xapian::doccount total = 0;
+
+    /// The values seen so far, together with their frequency.
+    map<string, Xapian::doccount> values;
+
+    /** Values tallied which haven't been added to values yet.
+     *
+     *  Counting into a hash table during the match is cheaper than
+     *  counting into an ordered map, so values is only brought up to
+     *  date when the counts are next needed.
+     */
+    unordered_map<string, Xapian::doccount> new_values;
+
+    explicit Internal(Xapian::valueno slot_) : slot(slot_) {}
+
+    /// Add the counts in new_values to values.
+    void update_values();
+};
+
+ValueCountMatchSpy::ValueCountMatchSpy() {}
+
+ValueCountMatchSpy::ValueCountMatchSpy(Xapian::valueno slot_)
+    : internal(new Internal(slot_)) {}
+
+ValueCountMatchSpy::~ValueCountMatchSpy() {}
+
+size_t
+ValueCountMatchSpy::get_total() const noexcept
+{
+    return internal ? internal->total : 0;
+}
+
 [[noreturn]]
 static void unsupported_method() {
     throw Xapian::InvalidOperationError("Method not supported for this type of termlist");
@@ -295,18 +335,40 @@ get_most_frequent_items(vector<StringAndFrequency> & result,
     }
 }
 
+void
+ValueCountMatchSpy::Internal::update_values()
+{
+    if (new_values.empty()) return;
+    if (values.empty()) {
+	// Sort first so each entry can be appended to the map in O(1).
+	vector<pair<string, Xapian::doccount>> sorted(new_values.begin(),
+						     new_values.end());
+	sort(sorted.begin(), sorted.end());
+	for (auto&& item : sorted) {
+	    values.emplace_hint(values.end(), std::move(item.first),
+				item.second);
+	}
+    } else {
+	for (auto&& item : new_values) {
+	    values[item.first] += item.second;
+	}
+    }
+    new_values.clear();
+}
+
 void
 ValueCountMatchSpy::operator()(const Document &doc, double) {
     Assert(internal);
     ++(internal->total);
     string val(doc.get_value(internal->slot));
-    if (!val.empty()) ++(internal->values[val]);
+    if (!val.empty()) ++(internal->new_values[val]);
 }
 
 TermIterator
 ValueCountMatchSpy::values_begin() const
 {
     Assert(internal);
+    internal->update_values();
     return Xapian::TermIterator(new ValueCountTermList(internal.get()));
 }
 
@@ -316,6 +378,7 @@ ValueCountMatchSpy::top_values_begin(size_t maxvalues) const
     Assert(internal);
     unique_ptr<StringAndFreqTermList> termlist(nullptr);
     if (usual(maxvalues > 0)) {
+	internal->update_values();
 	termlist.reset(new StringAndFreqTermList);
 	get_most_frequent_items(termlist->values, internal->values, maxvalues);
 	termlist->init();
@@ -360,6 +423,7 @@ string
 ValueCountMatchSpy::serialise_results() const {
     LOGCALL(REMOTE, string, "ValueCountMatchSpy::serialise_results", NO_ARGS);
     Assert(internal);
+    internal->update_values();
     string result;
     pack_uint(result, internal->total);
     for (auto&& item : internal->values) {
@@ -389,7 +453,7 @@ ValueCountMatchSpy::merge_results(const string & s) {
 	    !unpack_uint(&p, end, &freq)) {
 	    unpack_throw_serialisation_error(p);
 	}
-	internal->values[val] += freq;
+	internal->new_values[val] += freq;
     }
 }
 
@@ -397,6 +461,7 @@ string
 ValueCountMatchSpy::get_description() const {
     string d = "ValueCountMatchSpy(";
     if (internal) {
+	internal->update_values();
 	d += str(internal->total);
 	d += " docs seen, looking in ";
 	d += str(internal->values.size());
@@ -35,6 +35,8 @@
 #include <algorithm>
 #include <cfloat>
 #include <string>
+#include <utility>
+#include <vector>
 
 using namespace std;
 
@@ -57,9 +59,14 @@ MSet::MSet(Internal* internal_) : internal(internal_) {}
 MSet::~MSet() {}
 
 void
-MSet::fetch_(Xapian::doccount first, Xapian::doccount last) const
+MSet::fetch_(Xapian::doccount first, Xapian::doccount last,
+	     const vector<Xapian::valueno>* slots) const
 {
-    internal->fetch(first, last);
+    if (slots) {
+	internal->fetch(first, last, *slots);
+    } else {
+	internal->fetch(first, last, vector<Xapian::valueno>());
+    }
 }
 
 void
@@ -162,6 +169,12 @@ MSet::get_uncollapsed_matches_upper_bound() const
     return internal->uncollapsed_upper_bound;
 }
 
+Xapian::doccount
+MSet::get_timed_out_shards() const
+{
+    return internal->timed_out_shards;
+}
+
 double
 MSet::get_max_attained() const
 {
@@ -210,24 +223,48 @@ MSet::Internal::get_document(Xapian::doccount index) const
 	msg += str(items.size());
 	throw Xapian::RangeError(msg);
     }
+    auto i = documents.find(index);
+    if (i != documents.end()) {
+	return i->second;
+    }
     Assert(enquire);
     return enquire->get_document(items[index].get_docid());
 }
 
 void
-MSet::Internal::fetch(Xapian::doccount first_, Xapian::doccount last) const
+MSet::Internal::fetch(Xapian::doccount first_, Xapian::doccount last,
+		      const vector<Xapian::valueno>& slots) const
 {
-    if (items.empty() || !enquire) {
+    if (!enquire) {
 	return;
     }
-    if (last > items.size() - 1) {
-	last = items.size() - 1;
+    last = min(last, Xapian::doccount(items.size()));
+    if (first_ >= last) {
+	return;
     }
-    if (first_ <= last) {
-	Xapian::doccount n = last - first_;
-	for (Xapian::doccount i = 0; i <= n; ++i) {
-	    enquire->request_document(items[i].get_docid());
-	}
+
+    // Read the documents in ascending docid order.  If no extra values are
+    // wanted, there's no need to reread documents we already have.
+    vector<pair<Xapian::docid, Xapian::doccount>> to_fetch;
+    to_fetch.reserve(last - first_);
+    for (Xapian::doccount i = first_; i != last; ++i) {
+	if (slots.empty() && documents.count(i)) continue;
+	to_fetch.emplace_back(items[i].get_docid(), i);
+    }
+    if (to_fetch.empty()) {
+	return;
+    }
+    sort(to_fetch.begin(), to_fetch.end());
+
+    vector<Xapian::docid> dids;
+    dids.reserve(to_fetch.size());
+    for (auto&& item : to_fetch) {
+	dids.push_back(item.first);
+    }
+    vector<Xapian::Document> docs;
+    enquire->open_documents(dids, slots, docs);
+    for (size_t j = 0; j != docs.size(); ++j) {
+	documents[to_fetch[j].second] = std::move(docs[j]);
     }
 }
 
@@ -310,6 +347,7 @@ MSet::Internal::merge_stats(const Internal* o, bool collapsing)
     uncollapsed_lower_bound += o->uncollapsed_lower_bound;
     uncollapsed_estimated += o->uncollapsed_estimated;
     uncollapsed_upper_bound += o->uncollapsed_upper_bound;
+    timed_out_shards += o->timed_out_shards;
     max_possible = max(max_possible, o->max_possible);
     if (o->max_attained > max_attained) {
 	max_attained = o->max_attained;
@@ -26,6 +26,7 @@
 #include "result.h"
 #include "weight/weightinternal.h"
 
+#include "xapian/document.h"
 #include "xapian/intrusive_ptr.h"
 #include "xapian/mset.h"
 #include "xapian/types.h"
@@ -57,6 +58,9 @@ class MSet::Internal : public Xapian::Internal::intrusive_base {
     /// The items in the MSet.
     std::vector<Result> items;
 
+    /// Documents read by fetch(), keyed by index into items.
+    mutable std::unordered_map<Xapian::doccount, Xapian::Document> documents;
+
     /// For looking up query term frequencies and weights.
     std::unique_ptr<Xapian::Weight::Internal> stats;
 
@@ -74,6 +78,13 @@ class MSet::Internal : public Xapian::Internal::intrusive_base {
 
     Xapian::doccount uncollapsed_upper_bound = 0;
 
+    /** Number of remote shards which didn't return results in time.
+     *
+     *  This is only set by the Matcher when merging results, so isn't
+     *  serialised.
+     */
+    Xapian::doccount timed_out_shards = 0;
+
     Xapian::doccount first = 0;
 
     double max_possible = 0;
@@ -123,7 +134,12 @@ class MSet::Internal : public Xapian::Internal::intrusive_base {
 
     Xapian::Document get_document(Xapian::doccount index) const;
 
-    void fetch(Xapian::doccount first, Xapian::doccount last) const;
+    /** Read and cache the documents for items [first, last).
+     *
+     *  @param slots	Value slots to read for each document too.
+     */
+    void fetch(Xapian::doccount first, Xapian::doccount last,
+	       const std::vector<Xapian::valueno>& slots) const;
 
     void set_item_weight(Xapian::doccount i, double weight);
 
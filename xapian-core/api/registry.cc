@@ -36,6 +36,7 @@
 #include <algorithm>
 #include <map>
 #include <string>
+#include <vector>
 
 using namespace std;
 
@@ -283,6 +284,8 @@ Registry::Internal::add_defaults()
     postingsources[source->name()] = source;
     source = new Xapian::FixedWeightPostingSource(0.0);
     postingsources[source->name()] = source;
+    source = new Xapian::VectorPostingSource(0, vector<float>(1, 1.0f));
+    postingsources[source->name()] = source;
     source = new Xapian::LatLongDistancePostingSource(0,
 	Xapian::LatLongCoords(),
 	Xapian::GreatCircleMetric());
@@ -0,0 +1,845 @@
+/** @file
+ * @brief VectorPostingSource and VectorIndex implementation.
+ */
+/* Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+
+#include <config.h>
+
+#include "xapian/postingsource.h"
+
+#include "xapian/document.h"
+#include "xapian/error.h"
+
+#include "omassert.h"
+#include "pack.h"
+#include "serialise-double.h"
+#include "str.h"
+#include "stringutils.h"
+#include "wordaccess.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+
+using namespace std;
+
+/// The most vectors per cluster to use when choosing the clusters.
+#define TRAINING_VECTORS_PER_CLUSTER 64
+
+/// The most iterations of k-means to perform.
+#define MAX_KMEANS_ITERATIONS 20
+
+/** Allowance for rounding errors in angles between vectors, in radians.
+ *
+ *  The angles used for the cluster bounds are calculated from vectors which
+ *  have been normalised and stored as floats, so are slightly out.  We
+ *  subtract this before calculating a bound so it's always an upper bound.
+ */
+#define ANGLE_SLACK 1e-5
+
+namespace Xapian {
+
+static_assert(numeric_limits<float>::is_iec559 && sizeof(float) == 4,
+	      "VectorPostingSource assumes IEEE single precision floats");
+
+/// Decode vector component stored at p by serialise_vector().
+static inline float
+read_vector_component(const char* p)
+{
+    uint32_t bits = unaligned_read4(reinterpret_cast<const unsigned char*>(p));
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+/// Scale @a v to unit length, returning false if it's all zeros.
+static bool
+normalise(vector<float>& v)
+{
+    double norm2 = 0.0;
+    for (float x : v) {
+	norm2 += double(x) * double(x);
+    }
+    if (!(norm2 > 0.0)) {
+	return false;
+    }
+    double scale = 1.0 / sqrt(norm2);
+    for (float& x : v) {
+	x = float(double(x) * scale);
+    }
+    return true;
+}
+
+/** Return the dot product of two vectors with the same number of dimensions.
+ *
+ *  Keeping four separate sums lets the compiler use SIMD instructions for
+ *  this without having to reorder floating point additions.
+ */
+static float
+dot_product(const vector<float>& a, const vector<float>& b)
+{
+    AssertEq(a.size(), b.size());
+    const float* p = a.data();
+    const float* q = b.data();
+    size_t n = a.size();
+    float s0 = 0.0f, s1 = 0.0f, s2 = 0.0f, s3 = 0.0f;
+    size_t i = 0;
+    for ( ; i + 4 <= n; i += 4) {
+	s0 += p[i] * q[i];
+	s1 += p[i + 1] * q[i + 1];
+	s2 += p[i + 2] * q[i + 2];
+	s3 += p[i + 3] * q[i + 3];
+    }
+    for ( ; i != n; ++i) {
+	s0 += p[i] * q[i];
+    }
+    return (s0 + s1) + (s2 + s3);
+}
+
+/** Return the angle in radians between two unit vectors.
+ *
+ *  This is calculated from the distance between them, which is more accurate
+ *  than acos() of the dot product for small angles.
+ */
+static double
+angle_between(const vector<float>& a, const vector<float>& b)
+{
+    AssertEq(a.size(), b.size());
+    double dist2 = 0.0;
+    for (size_t i = 0; i != a.size(); ++i) {
+	double d = double(a[i]) - double(b[i]);
+	dist2 += d * d;
+    }
+    return 2.0 * asin(min(sqrt(dist2) * 0.5, 1.0));
+}
+
+/// Return the index of the centroid nearest to unit vector @a v.
+static unsigned
+nearest_centroid(const vector<vector<float>>& centroids,
+		 const vector<float>& v)
+{
+    unsigned best = 0;
+    float best_dot = -numeric_limits<float>::infinity();
+    for (unsigned c = 0; c != centroids.size(); ++c) {
+	float dot = dot_product(centroids[c], v);
+	if (dot > best_dot) {
+	    best_dot = dot;
+	    best = c;
+	}
+    }
+    return best;
+}
+
+/** Choose @a k clusters for some unit vectors using spherical k-means.
+ *
+ *  Returns the centroids of the clusters, normalised to unit length.
+ */
+static vector<vector<float>>
+choose_centroids(const vector<vector<float>>& vectors, unsigned k)
+{
+    Assert(k > 0);
+    AssertRel(k, <=, vectors.size());
+    // Train on a sample spread evenly through the vectors, which gives good
+    // enough clusters for much less work than using all of them.
+    size_t n = vectors.size();
+    size_t n_sample = min(n, size_t(k) * TRAINING_VECTORS_PER_CLUSTER);
+    vector<const vector<float>*> sample;
+    sample.reserve(n_sample);
+    for (size_t i = 0; i != n_sample; ++i) {
+	sample.push_back(&vectors[size_t(double(i) * n / n_sample)]);
+    }
+
+    // Pick the initial centroids "farthest first": each is the vector least
+    // similar to its nearest centroid so far.  This spreads them across the
+    // data, even if the order of the documents follows some pattern, and
+    // doesn't need a random number generator.
+    vector<vector<float>> centroids;
+    centroids.reserve(k);
+    centroids.push_back(*sample[0]);
+    vector<float> nearest(n_sample, -numeric_limits<float>::infinity());
+    while (centroids.size() != k) {
+	size_t farthest = 0;
+	for (size_t i = 0; i != n_sample; ++i) {
+	    float dot = dot_product(centroids.back(), *sample[i]);
+	    nearest[i] = max(nearest[i], dot);
+	    if (nearest[i] < nearest[farthest]) farthest = i;
+	}
+	centroids.push_back(*sample[farthest]);
+    }
+
+    size_t dimensions = centroids[0].size();
+    vector<unsigned> assignment(n_sample, k);
+    vector<vector<double>> sums(k);
+    for (unsigned iteration = 0;
+	 iteration != MAX_KMEANS_ITERATIONS;
+	 ++iteration) {
+	bool changed = false;
+	for (auto& sum : sums) {
+	    sum.assign(dimensions, 0.0);
+	}
+	for (size_t i = 0; i != n_sample; ++i) {
+	    const vector<float>& v = *sample[i];
+	    unsigned c = nearest_centroid(centroids, v);
+	    if (c != assignment[i]) {
+		assignment[i] = c;
+		changed = true;
+	    }
+	    vector<double>& sum = sums[c];
+	    for (size_t j = 0; j != dimensions; ++j) {
+		sum[j] += double(v[j]);
+	    }
+	}
+	if (!changed) break;
+
+	// Move each centroid to the mean direction of its cluster.  A cluster
+	// which is empty keeps its current centroid.
+	for (unsigned c = 0; c != k; ++c) {
+	    vector<float> centroid(sums[c].begin(), sums[c].end());
+	    if (normalise(centroid)) {
+		swap(centroids[c], centroid);
+	    }
+	}
+    }
+    return centroids;
+}
+
+/// Return true if @a term is a cluster term for the index with @a prefix.
+static bool
+is_cluster_term(const string& term, const string& prefix)
+{
+    if (term.size() <= prefix.size() || !startswith(term, prefix))
+	return false;
+    return all_of(term.begin() + prefix.size(), term.end(), C_isdigit);
+}
+
+/// Return the term (and metadata key) for a cluster.
+static string
+cluster_term(const string& prefix, unsigned cluster)
+{
+    return prefix + str(cluster);
+}
+
+/// Return the data stored in the user metadata for a cluster.
+static string
+encode_cluster(double radius, const vector<float>& centroid)
+{
+    string result = serialise_double(radius);
+    result += VectorPostingSource::serialise_vector(centroid);
+    return result;
+}
+
+/// Decode the data stored in the user metadata for an index.
+static void
+decode_header(const string& header, valueno& slot, unsigned& dimensions,
+	      unsigned& n_clusters)
+{
+    const char* p = header.data();
+    const char* end = p + header.size();
+    if (!unpack_uint(&p, end, &slot) ||
+	!unpack_uint(&p, end, &dimensions) ||
+	!unpack_uint_last(&p, end, &n_clusters)) {
+	unpack_throw_serialisation_error(p);
+    }
+}
+
+/** Make @a term the only cluster term in a document.
+ *
+ *  If @a term is empty, any cluster terms are removed.  Returns true if the
+ *  document was changed.
+ */
+static bool
+set_cluster_term(Document& doc, const string& prefix, const string& term)
+{
+    vector<string> old_terms;
+    bool found = false;
+    TermIterator t = doc.termlist_begin();
+    t.skip_to(prefix);
+    while (t != doc.termlist_end() && startswith(*t, prefix)) {
+	if (*t == term) {
+	    found = true;
+	} else if (is_cluster_term(*t, prefix)) {
+	    old_terms.push_back(*t);
+	}
+	++t;
+    }
+    for (const string& old_term : old_terms) {
+	doc.remove_term(old_term);
+    }
+    if (!found && !term.empty()) {
+	doc.add_boolean_term(term);
+	return true;
+    }
+    return !old_terms.empty();
+}
+
+VectorIndex::VectorIndex(const Database& db, const string& prefix_)
+    : prefix(prefix_), slot(BAD_VALUENO), dimensions(0)
+{
+    if (prefix.empty()) {
+	throw InvalidArgumentError("VectorIndex prefix must not be empty");
+    }
+    string header = db.get_metadata(prefix);
+    if (header.empty()) {
+	// No index built yet.
+	return;
+    }
+    unsigned n_clusters;
+    decode_header(header, slot, dimensions, n_clusters);
+    centroids.reserve(n_clusters);
+    radii.reserve(n_clusters);
+    for (unsigned c = 0; c != n_clusters; ++c) {
+	string data = db.get_metadata(cluster_term(prefix, c));
+	const char* p = data.data();
+	const char* end = p + data.size();
+	radii.push_back(unserialise_double(&p, end));
+	string serialised(p, end - p);
+	centroids.push_back(VectorPostingSource::unserialise_vector(serialised));
+	if (centroids.back().size() != dimensions) {
+	    throw SerialisationError("Bad VectorIndex cluster");
+	}
+    }
+}
+
+unsigned
+VectorIndex::nearest_cluster(const vector<float>& v) const
+{
+    return nearest_centroid(centroids, v);
+}
+
+void
+VectorIndex::build(WritableDatabase& db, valueno slot_, unsigned n_clusters)
+{
+    if (n_clusters == 0) {
+	throw InvalidArgumentError("VectorIndex needs at least one cluster");
+    }
+
+    // Read the vectors to index, normalised to unit length.
+    vector<docid> docids;
+    vector<vector<float>> vectors;
+    size_t new_dimensions = 0;
+    for (auto i = db.valuestream_begin(slot_);
+	 i != db.valuestream_end(slot_);
+	 ++i) {
+	string value = *i;
+	if (new_dimensions == 0 && value.size() % 4 == 0) {
+	    new_dimensions = value.size() / 4;
+	}
+	if (value.size() != new_dimensions * 4 || value.empty()) {
+	    continue;
+	}
+	vector<float> v = VectorPostingSource::unserialise_vector(value);
+	if (!normalise(v)) {
+	    continue;
+	}
+	docids.push_back(i.get_docid());
+	vectors.push_back(std::move(v));
+    }
+
+    vector<vector<float>> new_centroids;
+    if (!vectors.empty()) {
+	n_clusters = unsigned(min(size_t(n_clusters), vectors.size()));
+	new_centroids = choose_centroids(vectors, n_clusters);
+    }
+
+    // Assign each vector to its nearest cluster, and find the furthest
+    // vector in each cluster from its centroid.
+    vector<unsigned> assignment;
+    assignment.reserve(vectors.size());
+    vector<double> new_radii(new_centroids.size(), 0.0);
+    for (const vector<float>& v : vectors) {
+	unsigned c = nearest_centroid(new_centroids, v);
+	assignment.push_back(c);
+	new_radii[c] = max(new_radii[c], angle_between(new_centroids[c], v));
+    }
+
+    // Find documents with a term from an existing index, which need it
+    // removing if they no longer have a vector.
+    vector<docid> old_docids;
+    for (auto t = db.allterms_begin(prefix); t != db.allterms_end(prefix); ++t) {
+	if (!is_cluster_term(*t, prefix)) continue;
+	for (auto p = db.postlist_begin(*t); p != db.postlist_end(*t); ++p) {
+	    old_docids.push_back(*p);
+	}
+    }
+    sort(old_docids.begin(), old_docids.end());
+
+    // Update the documents in ascending docid order.
+    auto update = [&](docid did, const string& term) {
+	Document doc = db.get_document(did);
+	if (set_cluster_term(doc, prefix, term)) {
+	    db.replace_document(did, doc);
+	}
+    };
+    auto old_it = old_docids.begin();
+    for (size_t i = 0; i != docids.size(); ++i) {
+	docid did = docids[i];
+	while (old_it != old_docids.end() && *old_it <= did) {
+	    if (*old_it != did) update(*old_it, string());
+	    ++old_it;
+	}
+	update(did, cluster_term(prefix, assignment[i]));
+    }
+    while (old_it != old_docids.end()) {
+	update(*old_it++, string());
+    }
+
+    // Replace the clusters stored in the user metadata, removing any left
+    // over from an existing index with more clusters.
+    string old_header = db.get_metadata(prefix);
+    if (!old_header.empty()) {
+	valueno old_slot;
+	unsigned old_dimensions, old_n_clusters;
+	decode_header(old_header, old_slot, old_dimensions, old_n_clusters);
+	for (unsigned c = unsigned(new_centroids.size());
+	     c < old_n_clusters;
+	     ++c) {
+	    db.set_metadata(cluster_term(prefix, c), string());
+	}
+    }
+    for (unsigned c = 0; c != new_centroids.size(); ++c) {
+	db.set_metadata(cluster_term(prefix, c),
+			encode_cluster(new_radii[c], new_centroids[c]));
+    }
+    string header;
+    pack_uint(header, slot_);
+    pack_uint(header, new_dimensions);
+    pack_uint_last(header, new_centroids.size());
+    db.set_metadata(prefix, header);
+
+    slot = slot_;
+    dimensions = unsigned(new_dimensions);
+    swap(centroids, new_centroids);
+    swap(radii, new_radii);
+}
+
+void
+VectorIndex::index(WritableDatabase& db, Document& doc, const vector<float>& v)
+{
+    if (centroids.empty()) {
+	throw InvalidOperationError("VectorIndex hasn't been built");
+    }
+    if (v.size() != dimensions) {
+	throw InvalidArgumentError("Vector has a different number of "
+				   "dimensions to the VectorIndex");
+    }
+    vector<float> unit = v;
+    if (!normalise(unit)) {
+	throw InvalidArgumentError("Can't index a vector of all zeros");
+    }
+    unsigned c = nearest_cluster(unit);
+    double angle = angle_between(centroids[c], unit);
+    if (angle > radii[c]) {
+	// Another VectorIndex object may have widened the cluster since we
+	// read it, so don't reduce the stored radius.
+	const string key = cluster_term(prefix, c);
+	string data = db.get_metadata(key);
+	const char* p = data.data();
+	double stored_radius = unserialise_double(&p, p + data.size());
+	radii[c] = max(angle, stored_radius);
+	db.set_metadata(key, encode_cluster(radii[c], centroids[c]));
+    }
+    doc.add_value(slot, VectorPostingSource::serialise_vector(v));
+    set_cluster_term(doc, prefix, cluster_term(prefix, c));
+}
+
+VectorPostingSource::VectorPostingSource(Xapian::valueno slot_,
+					 const vector<float>& query_,
+					 double min_similarity_)
+	: ValuePostingSource(slot_),
+	  query(query_),
+	  min_similarity(min_similarity_),
+	  similarity(0.0),
+	  current(0)
+{
+    if (!(min_similarity >= 0.0 && min_similarity <= 1.0)) {
+	throw InvalidArgumentError("VectorPostingSource min_similarity must "
+				   "be between 0 and 1");
+    }
+    // Normalise the query vector now so the per-document work is just a dot
+    // product and the document vector's norm.  This also rejects an empty
+    // query vector.
+    if (!normalise(query)) {
+	throw InvalidArgumentError("VectorPostingSource query vector must be "
+				   "non-zero");
+    }
+}
+
+void
+VectorPostingSource::set_index(const VectorIndex& index, unsigned n_probe)
+{
+    if (n_probe == 0) {
+	throw InvalidArgumentError("VectorPostingSource n_probe must be > 0");
+    }
+    if (index.centroids.empty()) {
+	throw InvalidArgumentError("VectorIndex hasn't been built");
+    }
+    if (index.slot != get_slot()) {
+	throw InvalidArgumentError("VectorIndex is for a different value "
+				   "slot");
+    }
+    if (index.dimensions != query.size()) {
+	throw InvalidArgumentError("VectorIndex has a different number of "
+				   "dimensions to the query vector");
+    }
+
+    // Find the clusters whose centroids are most similar to the query.
+    vector<pair<float, unsigned>> ranked;
+    ranked.reserve(index.centroids.size());
+    for (unsigned c = 0; c != index.centroids.size(); ++c) {
+	ranked.emplace_back(-dot_product(index.centroids[c], query), c);
+    }
+    n_probe = unsigned(min(size_t(n_probe), ranked.size()));
+    partial_sort(ranked.begin(), ranked.begin() + n_probe, ranked.end());
+
+    cluster_terms.clear();
+    cluster_bounds.clear();
+    for (unsigned i = 0; i != n_probe; ++i) {
+	unsigned c = ranked[i].second;
+	// The angle between the query and any vector in the cluster is at
+	// least the angle between the query and the centroid less the
+	// cluster's radius, which bounds the similarity.
+	double gap = angle_between(index.centroids[c], query);
+	gap -= index.radii[c] + ANGLE_SLACK;
+	double bound = gap > 0.0 ? max(cos(gap), 0.0) : 1.0;
+	cluster_terms.push_back(cluster_term(index.prefix, c));
+	cluster_bounds.push_back(bound);
+    }
+}
+
+string
+VectorPostingSource::serialise_vector(const vector<float>& v)
+{
+    string result;
+    result.resize(v.size() * 4);
+    unsigned char* p = reinterpret_cast<unsigned char*>(&result[0]);
+    for (float x : v) {
+	uint32_t bits;
+	memcpy(&bits, &x, sizeof(bits));
+	unaligned_write4(p, bits);
+	p += 4;
+    }
+    return result;
+}
+
+vector<float>
+VectorPostingSource::unserialise_vector(const string& serialised)
+{
+    if (serialised.size() % 4 != 0) {
+	throw SerialisationError("Bad serialised vector");
+    }
+    vector<float> v;
+    v.reserve(serialised.size() / 4);
+    for (size_t i = 0; i != serialised.size(); i += 4) {
+	v.push_back(read_vector_component(serialised.data() + i));
+    }
+    return v;
+}
+
+void
+VectorPostingSource::calc_similarity()
+{
+    const string& value = get_value();
+    if (value.size() != query.size() * 4) {
+	// Wrong number of dimensions.
+	similarity = -1.0;
+	return;
+    }
+    const char* p = value.data();
+    double dot = 0.0, norm2 = 0.0;
+    for (float q : query) {
+	double x = double(read_vector_component(p));
+	p += 4;
+	dot += double(q) * x;
+	norm2 += x * x;
+    }
+    if (!(norm2 > 0.0)) {
+	// An all zeros vector has no direction.
+	similarity = -1.0;
+	return;
+    }
+    // Clamp to allow for rounding errors.
+    similarity = min(dot / sqrt(norm2), 1.0);
+}
+
+void
+VectorPostingSource::skip_dissimilar(double min_wt)
+{
+    // Documents with a weight below min_wt can't make it into the results,
+    // so we can skip those too.
+    double threshold = max(min_similarity, min_wt);
+    while (!ValuePostingSource::at_end()) {
+	calc_similarity();
+	if (similarity >= threshold)
+	    break;
+	ValuePostingSource::next(min_wt);
+    }
+}
+
+void
+VectorPostingSource::skip_clusters(Xapian::docid target)
+{
+    bool dropped = false;
+    size_t i = 0;
+    while (i != cluster_lists.size()) {
+	Xapian::PostingIterator& pl = cluster_lists[i].first;
+	if (*pl < target) {
+	    pl.skip_to(target);
+	    if (pl == Xapian::PostingIterator()) {
+		cluster_lists[i] = std::move(cluster_lists.back());
+		cluster_lists.pop_back();
+		dropped = true;
+		continue;
+	    }
+	}
+	++i;
+    }
+    if (dropped) {
+	// The documents left are all in the clusters which have documents
+	// left, so their bounds give a tighter bound on the weight.
+	double max_bound = 0.0;
+	for (const auto& cluster : cluster_lists) {
+	    max_bound = max(max_bound, cluster.second);
+	}
+	set_maxweight(max_bound);
+    }
+}
+
+void
+VectorPostingSource::skip_to_candidate(Xapian::docid target, double min_wt)
+{
+    // Documents with a weight below min_wt can't make it into the results,
+    // so we can skip those too.
+    double threshold = max(min_similarity, min_wt);
+    while (true) {
+	skip_clusters(target);
+	if (cluster_lists.empty() || threshold > get_maxweight()) {
+	    done();
+	    return;
+	}
+	Xapian::docid candidate = *cluster_lists[0].first;
+	for (const auto& cluster : cluster_lists) {
+	    candidate = min(candidate, *cluster.first);
+	}
+	// Usually the candidate has a vector, but it may have been removed
+	// since the document was indexed.
+	ValuePostingSource::skip_to(candidate, min_wt);
+	if (ValuePostingSource::at_end())
+	    return;
+	Xapian::docid did = ValuePostingSource::get_docid();
+	if (did == candidate) {
+	    calc_similarity();
+	    if (similarity >= threshold) {
+		current = did;
+		return;
+	    }
+	    ++did;
+	}
+	target = did;
+    }
+}
+
+void
+VectorPostingSource::next(double min_wt)
+{
+    if (!cluster_terms.empty()) {
+	skip_to_candidate(current + 1, min_wt);
+	return;
+    }
+    ValuePostingSource::next(min_wt);
+    skip_dissimilar(min_wt);
+}
+
+void
+VectorPostingSource::skip_to(Xapian::docid min_docid, double min_wt)
+{
+    if (!cluster_terms.empty()) {
+	skip_to_candidate(max(min_docid, current), min_wt);
+	return;
+    }
+    ValuePostingSource::skip_to(min_docid, min_wt);
+    skip_dissimilar(min_wt);
+}
+
+bool
+VectorPostingSource::check(Xapian::docid min_docid, double min_wt)
+{
+    if (!cluster_terms.empty()) {
+	current = min_docid;
+	skip_clusters(min_docid);
+	if (cluster_lists.empty() ||
+	    max(min_similarity, min_wt) > get_maxweight()) {
+	    done();
+	    return true;
+	}
+	bool candidate = false;
+	for (const auto& cluster : cluster_lists) {
+	    if (*cluster.first == min_docid) {
+		candidate = true;
+		break;
+	    }
+	}
+	if (!candidate) {
+	    // Not in any of the clusters being searched.
+	    return false;
+	}
+    }
+
+    if (!ValuePostingSource::check(min_docid, min_wt)) {
+	// check returned false, so we know the document is not in the source.
+	return false;
+    }
+    if (ValuePostingSource::at_end()) {
+	// return true, since we're definitely at the end of the list.
+	return true;
+    }
+    if (ValuePostingSource::get_docid() != min_docid) {
+	// The value stream skipped past min_docid, so it has no vector.
+	return false;
+    }
+
+    calc_similarity();
+    return similarity >= max(min_similarity, min_wt);
+}
+
+double
+VectorPostingSource::get_weight() const
+{
+    Assert(!at_end());
+    Assert(get_started());
+    // The clusters' bounds could be out of date if the VectorIndex used
+    // wasn't reread after other documents were indexed, so make sure we
+    // don't exceed the bound we've told the matcher about.
+    return min(similarity, get_maxweight());
+}
+
+VectorPostingSource *
+VectorPostingSource::clone() const
+{
+    unique_ptr<VectorPostingSource> res(
+	new VectorPostingSource(get_slot(), query, min_similarity));
+    res->cluster_terms = cluster_terms;
+    res->cluster_bounds = cluster_bounds;
+    return res.release();
+}
+
+string
+VectorPostingSource::name() const
+{
+    return string("Xapian::VectorPostingSource");
+}
+
+string
+VectorPostingSource::serialise() const
+{
+    string result;
+    pack_uint(result, get_slot());
+    result += serialise_double(min_similarity);
+    pack_uint(result, cluster_terms.size());
+    for (size_t i = 0; i != cluster_terms.size(); ++i) {
+	pack_string(result, cluster_terms[i]);
+	result += serialise_double(cluster_bounds[i]);
+    }
+    result += serialise_vector(query);
+    return result;
+}
+
+VectorPostingSource *
+VectorPostingSource::unserialise(const string &s) const
+{
+    const char * p = s.data();
+    const char * end = p + s.size();
+
+    Xapian::valueno new_slot;
+    if (!unpack_uint(&p, end, &new_slot)) {
+	unpack_throw_serialisation_error(p);
+    }
+    double new_min_similarity = unserialise_double(&p, end);
+    size_t n_clusters;
+    if (!unpack_uint(&p, end, &n_clusters)) {
+	unpack_throw_serialisation_error(p);
+    }
+    vector<string> new_cluster_terms;
+    vector<double> new_cluster_bounds;
+    for (size_t i = 0; i != n_clusters; ++i) {
+	string term;
+	if (!unpack_string(&p, end, term)) {
+	    unpack_throw_serialisation_error(p);
+	}
+	new_cluster_terms.push_back(std::move(term));
+	new_cluster_bounds.push_back(unserialise_double(&p, end));
+    }
+    vector<float> new_query = unserialise_vector(string(p, end - p));
+    unique_ptr<VectorPostingSource> res(
+	new VectorPostingSource(new_slot, new_query, new_min_similarity));
+    swap(res->cluster_terms, new_cluster_terms);
+    swap(res->cluster_bounds, new_cluster_bounds);
+    return res.release();
+}
+
+void
+VectorPostingSource::init(const Database & db_)
+{
+    ValuePostingSource::init(db_);
+    // Possible that no documents are similar enough, or have a vector with
+    // the right number of dimensions.
+    set_termfreq_min(0);
+    current = 0;
+    if (cluster_terms.empty()) {
+	// Cosine similarity can't exceed 1.
+	set_maxweight(1.0);
+	return;
+    }
+
+    cluster_lists.clear();
+    double max_bound = 0.0;
+    Xapian::doccount candidates = 0;
+    for (size_t i = 0; i != cluster_terms.size(); ++i) {
+	const string& term = cluster_terms[i];
+	Xapian::PostingIterator pl = db_.postlist_begin(term);
+	if (pl == db_.postlist_end(term)) continue;
+	cluster_lists.emplace_back(std::move(pl), cluster_bounds[i]);
+	max_bound = max(max_bound, cluster_bounds[i]);
+	candidates += db_.get_termfreq(term);
+    }
+    set_maxweight(max_bound);
+    // Only documents in the clusters which also have a vector can match.
+    candidates = min(candidates, get_termfreq_max());
+    set_termfreq_est(candidates);
+    set_termfreq_max(candidates);
+}
+
+string
+VectorPostingSource::get_description() const
+{
+    string desc("Xapian::VectorPostingSource(slot=");
+    desc += str(get_slot());
+    desc += ", dimensions=";
+    desc += str(query.size());
+    if (!cluster_terms.empty()) {
+	desc += ", clusters=";
+	desc += str(cluster_terms.size());
+    }
+    desc += ")";
+    return desc;
+}
+
+}
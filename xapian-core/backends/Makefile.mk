@@ -8,6 +8,7 @@ noinst_HEADERS +=\
 	backends/databasereplicator.h\
 	backends/documentinternal.h\
 	backends/empty_database.h\
+	backends/fetcheddocument.h\
 	backends/flint_lock.h\
 	backends/leafpostlist.h\
 	backends/multi.h\
@@ -16,6 +17,7 @@ noinst_HEADERS +=\
 	backends/prefix_compressed_strings.h\
 	backends/slowvaluelist.h\
 	backends/uuids.h\
+	backends/valuecache.h\
 	backends/valuelist.h\
 	backends/valuestats.h
 
@@ -31,10 +33,12 @@ lib_src +=\
 	backends/dbfactory.cc\
 	backends/documentinternal.cc\
 	backends/empty_database.cc\
+	backends/fetcheddocument.cc\
 	backends/leafpostlist.cc\
 	backends/postlist.cc\
 	backends/slowvaluelist.cc\
 	backends/uuids.cc\
+	backends/valuecache.cc\
 	backends/valuelist.cc
 
 if BUILD_BACKEND_REMOTE
@@ -24,16 +24,19 @@
 #include "databaseinternal.h"
 
 #include "api/termlist.h"
+#include "fetcheddocument.h"
 #include "heap.h"
 #include "omassert.h"
 #include "postlist.h"
 #include "slowvaluelist.h"
 #include "stringutils.h"
+#include "valuecache.h"
 #include "xapian/error.h"
 
 #include <algorithm>
 #include <memory>
 #include <string>
+#include <vector>
 
 using namespace std;
 using Xapian::Internal::intrusive_ptr;
@@ -46,6 +49,13 @@ static void invalid_operation(const char* msg)
     throw InvalidOperationError(msg);
 }
 
+// These are out of line so that ValueCache doesn't need to be a complete type
+// where databaseinternal.h is included.
+Database::Internal::Internal(transaction_state transaction_support)
+    : state(transaction_support) {}
+
+Database::Internal::~Internal() {}
+
 Database::Internal::size_type
 Database::Internal::size() const
 {
@@ -63,6 +73,26 @@ Database::Internal::readahead_for_query(const Xapian::Query &) const
 {
 }
 
+ValueList*
+Database::Internal::open_cached_value_list(valueno slot) const
+{
+    if (usual(value_caches.empty())) return open_value_list(slot);
+    auto i = value_caches.find(slot);
+    if (i == value_caches.end()) return open_value_list(slot);
+    Xapian::rev revision = get_revision();
+    if (!i->second || i->second->get_revision() != revision) {
+	i->second = new ValueCache(open_value_list(slot), revision);
+    }
+    return new CachedValueList(i->second.get(), slot);
+}
+
+void
+Database::Internal::cache_values(valueno slot) const
+{
+    if (!is_read_only()) return;
+    value_caches.emplace(slot, nullptr);
+}
+
 Xapian::termcount
 Database::Internal::get_unique_terms_lower_bound() const
 {
@@ -274,6 +304,42 @@ Database::Internal::open_value_list(Xapian::valueno slot) const
     return new SlowValueList(this, slot);
 }
 
+void
+Database::Internal::open_documents(const vector<Xapian::docid>& dids,
+				   const vector<Xapian::valueno>& slots,
+				   vector<Xapian::Document>& docs) const
+{
+    for (Xapian::docid did : dids) {
+	request_document(did);
+    }
+
+    vector<FetchedDocument*> fetched;
+    fetched.reserve(dids.size());
+    docs.reserve(docs.size() + dids.size());
+    for (Xapian::docid did : dids) {
+	AssertRel(did,>,0);
+	FetchedDocument* doc = new FetchedDocument(open_document(did, true));
+	docs.emplace_back(doc);
+	fetched.push_back(doc);
+    }
+
+    for (Xapian::valueno slot : slots) {
+	unique_ptr<ValueList> vl(open_cached_value_list(slot));
+	for (FetchedDocument* doc : fetched) {
+	    Xapian::docid did = doc->get_docid();
+	    string value;
+	    if (vl && vl->check(did)) {
+		if (vl->at_end()) {
+		    vl.reset();
+		} else if (vl->get_docid() == did) {
+		    value = vl->get_value();
+		}
+	    }
+	    doc->set_fetched_value(slot, std::move(value));
+	}
+    }
+}
+
 TermList *
 Database::Internal::open_spelling_termlist(const string &) const
 {
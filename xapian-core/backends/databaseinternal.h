@@ -33,13 +33,16 @@
 #include <xapian/types.h>
 #include <xapian/valueiterator.h>
 
+#include <map>
 #include <string>
+#include <vector>
 
 typedef Xapian::TermIterator::Internal TermList;
 typedef Xapian::PositionIterator::Internal PositionList;
 typedef Xapian::ValueIterator::Internal ValueList;
 
 class LeafPostList;
+class ValueCache;
 
 namespace Xapian {
 namespace Internal {
@@ -83,12 +86,19 @@ class Database::Internal : public Xapian::Internal::intrusive_base {
      *	* TRANSACTION_UNIMPLEMENTED - writable but no transaction support
      *	* TRANSACTION_NONE - writable with transaction support
      */
-    Internal(transaction_state transaction_support)
-	: state(transaction_support) {}
+    Internal(transaction_state transaction_support);
 
     /// Current transaction state.
     transaction_state state;
 
+    /** The slots cache_values() has been called for, and their cached values.
+     *
+     *  The values for a slot are read when first needed, and reread if the
+     *  revision has changed since.
+     */
+    mutable std::map<Xapian::valueno,
+		     Xapian::Internal::intrusive_ptr<ValueCache>> value_caches;
+
     /// Test if this shard is read-only.
     bool is_read_only() const {
 	return state == TRANSACTION_READONLY;
@@ -120,7 +130,7 @@ class Database::Internal : public Xapian::Internal::intrusive_base {
     /** We have virtual methods and want to be able to delete derived classes
      *  using a pointer to the base class, so we need a virtual destructor.
      */
-    virtual ~Internal() {}
+    virtual ~Internal();
 
     typedef Xapian::doccount size_type;
 
@@ -241,6 +251,25 @@ class Database::Internal : public Xapian::Internal::intrusive_base {
      */
     virtual ValueList* open_value_list(valueno slot) const;
 
+    /** Open a value stream, using the in-memory cache if there is one.
+     *
+     *  If cache_values() has been called for @a slot then the values are
+     *  read from the cache (which is first loaded if necessary), otherwise
+     *  this is the same as open_value_list().
+     *
+     *  @param slot	The value slot.
+     *
+     *  @return	Pointer to a new ValueList object which should be deleted by
+     *		the caller once it is no longer needed.
+     */
+    ValueList* open_cached_value_list(valueno slot) const;
+
+    /** Cache the values in a slot in memory.
+     *
+     *  This is ignored for writable shards, since the values may change.
+     */
+    virtual void cache_values(valueno slot) const;
+
     virtual TermList* open_term_list(docid did) const = 0;
 
     /** Like open_term_list() but without MultiTermList wrapper.
@@ -271,6 +300,23 @@ class Database::Internal : public Xapian::Internal::intrusive_base {
      */
     virtual Document::Internal* open_document(docid did, bool lazy) const = 0;
 
+    /** Open several documents and read their data and some values.
+     *
+     *  The default implementation reads the data for each document in turn,
+     *  then makes a pass through the value stream for each slot in @a slots,
+     *  which is much cheaper than looking up each value separately.
+     *  Backends can override this if they can do better still.
+     *
+     *  @param dids	The document ids to open, in ascending order.  These
+     *			documents should exist.
+     *  @param slots	The value slots to read for each document.
+     *  @param docs	The documents are appended to this, in the same order
+     *			as @a dids.
+     */
+    virtual void open_documents(const std::vector<docid>& dids,
+				const std::vector<valueno>& slots,
+				std::vector<Document>& docs) const;
+
     /** Create a termlist tree from trigrams of @a word.
      *
      *  You can assume word.size() > 1.
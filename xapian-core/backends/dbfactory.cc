@@ -60,16 +60,30 @@ using namespace std;
 
 namespace Xapian {
 
+#ifdef XAPIAN_HAS_GLASS_BACKEND
+/// Apply flags which affect opening a glass database read-only.
+static GlassDatabase*
+glass_read_only(GlassDatabase* db, int flags)
+{
+    if (flags & DB_CACHE_DOCLENS)
+	db->cache_doclengths();
+    return db;
+}
+#endif
+
 static void
-open_stub(Database& db, const string& file)
+open_stub(Database& db, const string& file, int flags)
 {
     read_stub_file(file,
-		   [&db](const string& path) {
-		       db.add_database(Database(path));
+		   [&db, flags](const string& path) {
+		       db.add_database(Database(path,
+						flags & DB_CACHE_DOCLENS));
 		   },
-		   [&db](const string& path) {
+		   [&db, flags](const string& path) {
 #ifdef XAPIAN_HAS_GLASS_BACKEND
-		       db.add_database(Database(new GlassDatabase(path)));
+		       db.add_database(
+			   Database(glass_read_only(new GlassDatabase(path),
+						    flags)));
 #else
 		       (void)path;
 #endif
@@ -166,7 +180,7 @@ Database::Database(const string& path, int flags)
 	    throw FeatureUnavailableError("Chert backend no longer supported");
 	case DB_BACKEND_GLASS:
 #ifdef XAPIAN_HAS_GLASS_BACKEND
-	    internal = new GlassDatabase(path);
+	    internal = glass_read_only(new GlassDatabase(path), flags);
 	    return;
 #else
 	    throw FeatureUnavailableError("Glass backend disabled");
@@ -179,7 +193,7 @@ Database::Database(const string& path, int flags)
 	    throw FeatureUnavailableError("Honey backend disabled");
 #endif
 	case DB_BACKEND_STUB:
-	    open_stub(*this, path);
+	    open_stub(*this, path, flags);
 	    return;
 	case DB_BACKEND_INMEMORY:
 #ifdef XAPIAN_HAS_INMEMORY_BACKEND
@@ -208,7 +222,7 @@ Database::Database(const string& path, int flags)
 	    case BACKEND_GLASS:
 #ifdef XAPIAN_HAS_GLASS_BACKEND
 		// Single file glass format.
-		internal = new GlassDatabase(fd);
+		internal = glass_read_only(new GlassDatabase(fd), flags);
 		return;
 #else
 		throw FeatureUnavailableError("Glass backend disabled");
@@ -223,7 +237,7 @@ Database::Database(const string& path, int flags)
 #endif
 	}
 
-	open_stub(*this, path);
+	open_stub(*this, path, flags);
 	return;
     }
 
@@ -233,7 +247,7 @@ Database::Database(const string& path, int flags)
 
 #ifdef XAPIAN_HAS_GLASS_BACKEND
     if (file_exists(path + "/iamglass")) {
-	internal = new GlassDatabase(path);
+	internal = glass_read_only(new GlassDatabase(path), flags);
 	return;
     }
 #endif
@@ -249,7 +263,7 @@ Database::Database(const string& path, int flags)
     string stub_file = path;
     stub_file += "/XAPIANDB";
     if (usual(file_exists(stub_file))) {
-	open_stub(*this, stub_file);
+	open_stub(*this, stub_file, flags);
 	return;
     }
 
@@ -301,7 +315,7 @@ database_factory(int fd, int flags)
     switch (type) {
 #ifdef XAPIAN_HAS_GLASS_BACKEND
 	case DB_BACKEND_GLASS:
-	    return new GlassDatabase(fd);
+	    return glass_read_only(new GlassDatabase(fd), flags);
 #endif
 #ifdef XAPIAN_HAS_HONEY_BACKEND
 	case DB_BACKEND_HONEY:
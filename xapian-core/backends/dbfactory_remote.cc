@@ -2,6 +2,7 @@
  * @brief Database factories for remote databases.
  */
 /* Copyright (C) 2006,2007,2008,2010,2011,2014 Olly Betts
+ * Copyright (C) 2026 agent
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License as
@@ -34,13 +35,25 @@ namespace Xapian {
 
 Database
 Remote::open(const string &host, unsigned int port, unsigned timeout_,
-	     unsigned connect_timeout)
+	     unsigned connect_timeout, int flags)
 {
-    LOGCALL_STATIC(API, Database, "Remote::open", host | port | timeout_ | connect_timeout);
+    LOGCALL_STATIC(API, Database, "Remote::open", host | port | timeout_ | connect_timeout | flags);
+    if (flags & DB_POOL_CONNECTION) {
+	RETURN(Database(RemoteTcpClient::open_pooled(host, port,
+						     timeout_ * 1e-3,
+						     connect_timeout * 1e-3)));
+    }
     RETURN(Database(new RemoteTcpClient(host, port, timeout_ * 1e-3,
 					connect_timeout * 1e-3, false, 0)));
 }
 
+Database
+Remote::open(const string &host, unsigned int port, unsigned timeout_,
+	     unsigned connect_timeout)
+{
+    return Remote::open(host, port, timeout_, connect_timeout, 0);
+}
+
 WritableDatabase
 Remote::open_writable(const string &host, unsigned int port,
 		      unsigned timeout_, unsigned connect_timeout,
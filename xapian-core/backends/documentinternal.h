@@ -37,6 +37,7 @@
 
 class DocumentTermList;
 class DocumentValueList;
+class FetchedDocument;
 class GlassValueManager;
 class HoneyValueManager;
 class ValueStreamDocument;
@@ -48,6 +49,7 @@ class Document::Internal : public Xapian::Internal::intrusive_base {
     friend class ::DocumentTermList;
     friend class ::DocumentValueList;
     // For ensure_values_fetched():
+    friend class ::FetchedDocument;
     friend class ::GlassValueManager;
     friend class ::HoneyValueManager;
     friend class ::ValueStreamDocument;
@@ -0,0 +1,54 @@
+/** @file
+ * @brief A document with its data and some values already read
+ */
+/* Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <config.h>
+
+#include "fetcheddocument.h"
+
+using namespace std;
+
+FetchedDocument::FetchedDocument(Xapian::Document::Internal* doc_)
+    : Internal(doc_->database, doc_->did), doc(doc_)
+{
+    doc_data = doc->get_data();
+}
+
+string
+FetchedDocument::fetch_value(Xapian::valueno slot) const
+{
+    auto i = slot_values.find(slot);
+    if (i != slot_values.end()) {
+	return i->second;
+    }
+    return doc->get_value(slot);
+}
+
+void
+FetchedDocument::fetch_all_values(map<Xapian::valueno, string> & values_) const
+{
+    doc->ensure_values_fetched();
+    values_ = *doc->values;
+}
+
+string
+FetchedDocument::fetch_data() const
+{
+    return doc_data;
+}
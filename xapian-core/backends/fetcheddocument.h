@@ -0,0 +1,73 @@
+/** @file
+ * @brief A document with its data and some values already read
+ */
+/* Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifndef XAPIAN_INCLUDED_FETCHEDDOCUMENT_H
+#define XAPIAN_INCLUDED_FETCHEDDOCUMENT_H
+
+#include "backends/documentinternal.h"
+#include "xapian/intrusive_ptr.h"
+#include "xapian/types.h"
+
+#include <map>
+#include <string>
+
+/** A document with its data and some values already read.
+ *
+ *  Used by Database::Internal::open_documents() so that the reads can be
+ *  done in a single pass in docid order.  Anything else is read from the
+ *  wrapped document on demand.
+ */
+class FetchedDocument : public Xapian::Document::Internal {
+    /// Don't allow assignment.
+    void operator=(const FetchedDocument &) = delete;
+
+    /// Don't allow copying.
+    FetchedDocument(const FetchedDocument &) = delete;
+
+    /// The document we're wrapping.
+    Xapian::Internal::intrusive_ptr<Xapian::Document::Internal> doc;
+
+    /// The document data.
+    std::string doc_data;
+
+    /// The slots which have been read, and their values.
+    std::map<Xapian::valueno, std::string> slot_values;
+
+  public:
+    /** Construct and read the document data.
+     *
+     *  @param doc_	The document to wrap, as returned by open_document().
+     */
+    explicit FetchedDocument(Xapian::Document::Internal* doc_);
+
+    /// Set the value read for @a slot (which may be empty).
+    void set_fetched_value(Xapian::valueno slot, std::string&& value) {
+	slot_values[slot] = std::move(value);
+    }
+
+  protected:
+    /** Implementation of virtual methods @{ */
+    std::string fetch_value(Xapian::valueno slot) const;
+    void fetch_all_values(std::map<Xapian::valueno, std::string> & values_) const;
+    std::string fetch_data() const;
+    /** @} */
+};
+
+#endif // XAPIAN_INCLUDED_FETCHEDDOCUMENT_H
@@ -357,6 +357,15 @@ GlassDatabase::set_revision_number(int flags, glass_revision_number_t new_revisi
     spelling_table.commit(new_revision, version_file.root_to_set(Glass::SPELLING));
     docdata_table.commit(new_revision, version_file.root_to_set(Glass::DOCDATA));
 
+    // Start the writes for every table before waiting for any of them, so
+    // they can proceed together rather than one table at a time.
+    postlist_table.start_sync();
+    position_table.start_sync();
+    termlist_table.start_sync();
+    synonym_table.start_sync();
+    spelling_table.start_sync();
+    docdata_table.start_sync();
+
     const string & tmpfile = version_file.write(new_revision, flags);
     if (!postlist_table.sync() ||
 	!position_table.sync() ||
@@ -235,6 +235,12 @@ class GlassDatabase : public Xapian::Database::Internal {
 
     ~GlassDatabase();
 
+    /** Cache document lengths in memory.
+     *
+     *  Used to implement Xapian::DB_CACHE_DOCLENS.
+     */
+    void cache_doclengths() { postlist_table.cache_doclengths(); }
+
     /// Get a postlist table cursor (used by GlassValueList).
     GlassCursor * get_postlist_cursor() const {
 	return postlist_table.cursor_get();
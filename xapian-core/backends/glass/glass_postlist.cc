@@ -28,8 +28,10 @@
 #include "glass_cursor.h"
 #include "glass_database.h"
 #include "debuglog.h"
+#include "overflow.h"
 #include "pack.h"
 #include "str.h"
+#include "wordaccess.h"
 #include "unicode/description_append.h"
 
 using Xapian::Internal::intrusive_ptr;
@@ -191,9 +193,91 @@ GlassPostListTable::get_freqs(const string & term,
     }
 }
 
+void
+GlassPostListTable::load_doclen_cache(intrusive_ptr<const GlassDatabase> db) const
+{
+    Xapian::termcount doclen_ub = db->get_doclength_upper_bound();
+    unsigned width;
+    if (doclen_ub < 0xff) {
+	width = 1;
+    } else if (doclen_ub < 0xffff) {
+	width = 2;
+    } else if (doclen_ub < 0xffffffff) {
+	width = 4;
+    } else {
+	// Too big for the widths we support, so just don't cache.
+	use_doclen_cache = false;
+	return;
+    }
+
+    Xapian::docid first, last;
+    get_used_docid_range(first, last);
+    Xapian::doccount size = (first == 0 ? 0 : last - first + 1);
+    // The cache has an entry for every docid in the used range, so if most
+    // of them are unused (e.g. after many documents have been deleted) it
+    // would mostly be wasted space.
+    size_t bytes;
+    if (size / 2 > db->get_doccount() ||
+	mul_overflows(size_t(size), size_t(width), bytes)) {
+	use_doclen_cache = false;
+	return;
+    }
+    unique_ptr<unsigned char[]> cache(new unsigned char[bytes]());
+    GlassPostList pl(db, string(), false);
+    while (pl.next(0.0), !pl.at_end()) {
+	unsigned char* p = cache.get() +
+			   size_t(pl.get_docid() - first) * width;
+	Xapian::termcount v = pl.get_wdf() + 1;
+	switch (width) {
+	    case 1:
+		*p = static_cast<unsigned char>(v);
+		break;
+	    case 2:
+		unaligned_write2(p, v);
+		break;
+	    default:
+		unaligned_write4(p, v);
+		break;
+	}
+    }
+
+    doclen_cache = std::move(cache);
+    doclen_cache_first = first;
+    doclen_cache_size = size;
+    doclen_cache_width = width;
+}
+
 Xapian::termcount
 GlassPostListTable::get_doclength(Xapian::docid did,
 				  intrusive_ptr<const GlassDatabase> db) const {
+    if (use_doclen_cache) {
+	if (doclen_cache_width == 0)
+	    load_doclen_cache(db);
+	if (doclen_cache_width != 0) {
+	    Xapian::termcount v = 0;
+	    Xapian::docid i = did - doclen_cache_first;
+	    if (did >= doclen_cache_first && i < doclen_cache_size) {
+		const unsigned char* p = doclen_cache.get() +
+					 size_t(i) * doclen_cache_width;
+		switch (doclen_cache_width) {
+		    case 1:
+			v = *p;
+			break;
+		    case 2:
+			v = unaligned_read2(p);
+			break;
+		    default:
+			v = unaligned_read4(p);
+			break;
+		}
+	    }
+	    if (v == 0) {
+		throw Xapian::DocNotFoundError("Document " + str(did) +
+					       " not found");
+	    }
+	    return v - 1;
+	}
+    }
     if (!doclen_pl) {
 	// Don't keep a reference back to the database, since this
 	// would make a reference loop.
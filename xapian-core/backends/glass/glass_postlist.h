@@ -54,6 +54,30 @@ class GlassPostListTable : public GlassTable {
     /// PostList for looking up document lengths.
     mutable std::unique_ptr<GlassPostList> doclen_pl;
 
+    /** Cached document lengths, if enabled by cache_doclengths().
+     *
+     *  Entry i is one more than the length of document doclen_cache_first
+     *  + i, or zero if there's no such document.  Each entry is
+     *  doclen_cache_width bytes, which is the fewest that fit the largest
+     *  document length.  A width of 0 means the cache isn't loaded yet.
+     */
+    mutable std::unique_ptr<unsigned char[]> doclen_cache;
+
+    /// Document id of the first entry in doclen_cache.
+    mutable Xapian::docid doclen_cache_first = 0;
+
+    /// Number of entries in doclen_cache.
+    mutable Xapian::doccount doclen_cache_size = 0;
+
+    /// Size of each entry in doclen_cache in bytes.
+    mutable unsigned doclen_cache_width = 0;
+
+    /// Should we cache document lengths?
+    mutable bool use_doclen_cache = false;
+
+    /// Read all the document lengths into doclen_cache.
+    void load_doclen_cache(Xapian::Internal::intrusive_ptr<const GlassDatabase> db) const;
+
   public:
     /** Create a new table object.
      *
@@ -80,6 +104,8 @@ class GlassPostListTable : public GlassTable {
     void open(int flags_, const RootInfo & root_info,
 	      glass_revision_number_t rev) {
 	doclen_pl.reset(0);
+	doclen_cache.reset();
+	doclen_cache_width = 0;
 	GlassTable::open(flags_, root_info, rev);
     }
 
@@ -126,6 +152,14 @@ class GlassPostListTable : public GlassTable {
 		   Xapian::termcount * collfreq_ptr,
 		   Xapian::termcount * wdfub_ptr = NULL) const;
 
+    /** Cache the lengths of all documents in memory.
+     *
+     *  The lengths are read the first time one is needed, and reread if the
+     *  table is opened at a new revision.  Only suitable for a read-only
+     *  table.
+     */
+    void cache_doclengths() { use_doclen_cache = true; }
+
     /** Returns the length of document @a did. */
     Xapian::termcount get_doclength(Xapian::docid did,
 				    Xapian::Internal::intrusive_ptr<const GlassDatabase> db) const;
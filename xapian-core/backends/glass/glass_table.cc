@@ -155,6 +155,12 @@ static inline uint8_t *zeroed_new(size_t size)
 
 #define BYTE_PAIR_RANGE (1 << 2 * CHAR_BIT)
 
+/** Write out pending block writes once they use this many bytes.
+ *
+ *  Blocks are also written out on commit.
+ */
+#define PENDING_WRITES_MAX_BYTES (4 * 1024 * 1024)
+
 /// read_block(n, p) reads block n of the DB file to address p.
 void
 GlassTable::read_block(uint4 n, uint8_t * p) const
@@ -165,6 +171,12 @@ GlassTable::read_block(uint4 n, uint8_t * p) const
 	GlassTable::throw_database_closed();
     AssertRel(n,<,free_list.get_first_unused_block());
 
+    auto i = pending_writes.find(n);
+    if (i != pending_writes.end()) {
+	memcpy(p, i->second.get(), block_size);
+	return;
+    }
+
     io_read_block(handle, reinterpret_cast<char *>(p), block_size, n, offset);
 
     if (GET_LEVEL(p) != LEVEL_FREELIST) {
@@ -217,10 +229,51 @@ GlassTable::write_block(uint4 n, const uint8_t * p, bool appending) const
 	// read lock and try to take an exclusive lock here?
     }
 
-    const char * p_char = reinterpret_cast<const char *>(p);
-    io_write_block(handle, p_char, block_size, n, offset);
+    auto& pending = pending_writes[n];
+    if (!pending) pending.reset(new uint8_t[block_size]);
+    memcpy(pending.get(), p, block_size);
+    if (pending_writes.size() * block_size >= PENDING_WRITES_MAX_BYTES) {
+	flush_pending_writes();
+    }
+}
 
-    if (!changes_obj) return;
+/// Write out the blocks in pending_writes.
+void
+GlassTable::flush_pending_writes() const
+{
+    LOGCALL_VOID(DB, "GlassTable::flush_pending_writes", NO_ARGS);
+    if (pending_writes.empty()) return;
+
+    string run;
+    auto i = pending_writes.begin();
+    while (i != pending_writes.end()) {
+	// Gather a run of adjacent blocks to write together.
+	uint4 first = i->first;
+	uint4 next = first;
+	run.resize(0);
+	do {
+	    run.append(reinterpret_cast<const char *>(i->second.get()),
+		       block_size);
+	    ++i;
+	    ++next;
+	} while (i != pending_writes.end() && i->first == next);
+	io_pwrite(handle, run.data(), run.size(),
+		  offset + off_t(first) * block_size);
+    }
+    unsynced_writes = true;
+
+    if (changes_obj) {
+	for (auto&& pending : pending_writes) {
+	    write_changes_block(pending.first, pending.second.get());
+	}
+    }
+    pending_writes.clear();
+}
+
+/// Write block n from address p to the changeset.
+void
+GlassTable::write_changes_block(uint4 n, const uint8_t * p) const
+{
 
     unsigned char v;
     // FIXME: track table_type in this class?
@@ -411,6 +464,10 @@ GlassTable::alter()
    c if possible.
 
    exact is set to true if the match was exact (otherwise exact is unchanged).
+
+   We track how long a prefix the key shares with the keys at i and j, as
+   every key between them must share the shorter of these, so comparisons can
+   skip it.
 */
 
 int
@@ -425,34 +482,47 @@ GlassTable::find_in_leaf(const uint8_t * p, LeafItem item, int c, bool& exact)
 	AssertRel(i,<=,c);
     }
     int j = DIR_END(p);
+    // Length of the prefix the key shares with the keys at i and j.
+    int common_i = 0, common_j = 0;
 
     if (c != -1) {
 	if (c < j && i < c) {
-	    int r = compare(LeafItem(p, c), item);
+	    int common = 0;
+	    int r = compare(LeafItem(p, c), item, common);
 	    if (r == 0) {
 		exact = true;
 		return c;
 	    }
-	    if (r < 0) i = c;
+	    if (r < 0) {
+		i = c;
+		common_i = common;
+	    }
 	}
 	c += D2;
 	if (c < j && i < c) {
-	    int r = compare(item, LeafItem(p, c));
+	    int common = 0;
+	    int r = compare(item, LeafItem(p, c), common);
 	    if (r == 0) {
 		exact = true;
 		return c;
 	    }
-	    if (r < 0) j = c;
+	    if (r < 0) {
+		j = c;
+		common_j = common;
+	    }
 	}
     }
 
     while (j - i > D2) {
 	int k = i + ((j - i) / (D2 * 2)) * D2; /* mid way */
-	int r = compare(item, LeafItem(p, k));
+	int common = min(common_i, common_j);
+	int r = compare(item, LeafItem(p, k), common);
 	if (r < 0) {
 	    j = k;
+	    common_j = common;
 	} else {
 	    i = k;
+	    common_i = common;
 	    if (r == 0) {
 		exact = true;
 		break;
@@ -474,28 +544,42 @@ find_in_branch_(const uint8_t * p, ITEM item, int c)
 	AssertRel(i,<=,c);
     }
     int j = DIR_END(p);
+    // Length of the prefix the key shares with the keys at i and j (the key
+    // at DIR_START isn't compared so we start from 0 for that).
+    int common_i = 0, common_j = 0;
 
     if (c != -1) {
 	if (c < j && i < c) {
-	    int r = compare(BItem(p, c), item);
+	    int common = 0;
+	    int r = compare(BItem(p, c), item, common);
 	    if (r == 0) return c;
-	    if (r < 0) i = c;
+	    if (r < 0) {
+		i = c;
+		common_i = common;
+	    }
 	}
 	c += D2;
 	if (c < j && i < c) {
-	    int r = compare(item, BItem(p, c));
+	    int common = 0;
+	    int r = compare(item, BItem(p, c), common);
 	    if (r == 0) return c;
-	    if (r < 0) j = c;
+	    if (r < 0) {
+		j = c;
+		common_j = common;
+	    }
 	}
     }
 
     while (j - i > D2) {
 	int k = i + ((j - i) / (D2 * 2)) * D2; /* mid way */
-	int r = compare(item, BItem(p, k));
+	int common = min(common_i, common_j);
+	int r = compare(item, BItem(p, k), common);
 	if (r < 0) {
 	    j = k;
+	    common_j = common;
 	} else {
 	    i = k;
+	    common_i = common;
 	    if (r == 0) break;
 	}
     }
@@ -1712,6 +1796,7 @@ GlassTable::GlassTable(const char * tablename_, const string & path_,
 	  changed_c(0),
 	  max_item_size(0),
 	  Btree_modified(false),
+	  unsynced_writes(false),
 	  full_compaction(false),
 	  writable(!readonly_),
 	  cursor_created_since_last_modification(false),
@@ -1747,6 +1832,7 @@ GlassTable::GlassTable(const char * tablename_, int fd, off_t offset_,
 	  changed_c(0),
 	  max_item_size(0),
 	  Btree_modified(false),
+	  unsynced_writes(false),
 	  full_compaction(false),
 	  writable(!readonly_),
 	  cursor_created_since_last_modification(false),
@@ -1809,6 +1895,9 @@ GlassTable::~GlassTable() {
 void GlassTable::close(bool permanent) {
     LOGCALL_VOID(DB, "GlassTable::close", permanent);
 
+    // Any pending writes are for an uncommitted revision.
+    pending_writes.clear();
+
     if (handle >= 0) {
 	if (single_file()) {
 	    handle = -3 - handle;
@@ -1902,6 +1991,8 @@ GlassTable::commit(glass_revision_number_t revision, RootInfo * root_info)
 	free_list.set_revision(revision);
 	free_list.commit(this, block_size);
 
+	flush_pending_writes();
+
 	// Save the freelist details into the root_info.
 	string serialised;
 	free_list.pack(serialised);
@@ -1938,6 +2029,8 @@ GlassTable::cancel(const RootInfo & root_info, glass_revision_number_t rev)
     if (flags & Xapian::DB_DANGEROUS)
 	throw Xapian::InvalidOperationError("cancel() not supported under Xapian::DB_DANGEROUS");
 
+    pending_writes.clear();
+
     revision_number = rev;
     block_size =       root_info.get_blocksize();
     root =             root_info.get_root();
@@ -40,6 +40,8 @@
 #include "common/compression_stream.h"
 
 #include <algorithm>
+#include <map>
+#include <memory>
 #include <string>
 
 namespace Glass {
@@ -539,10 +541,24 @@ class GlassTable {
      */
     void commit(glass_revision_number_t revision, RootInfo * root_info);
 
+    /** Start writing modified blocks to disk.
+     *
+     *  This doesn't wait for the writes to complete.  Calling it for each
+     *  table before calling sync() for any of them allows the writes for the
+     *  different tables to proceed together.
+     */
+    void start_sync() {
+	if (!(flags & Xapian::DB_NO_SYNC) && handle >= 0 && unsynced_writes)
+	    io_start_sync(handle);
+    }
+
     bool sync() {
-	return (flags & Xapian::DB_NO_SYNC) ||
-	       handle < 0 ||
-	       io_sync(handle);
+	if ((flags & Xapian::DB_NO_SYNC) || handle < 0 || !unsynced_writes)
+	    return true;
+	if (!io_sync(handle))
+	    return false;
+	unsynced_writes = false;
+	return true;
     }
 
     /** Cancel any outstanding changes.
@@ -745,6 +761,8 @@ class GlassTable {
     void read_block(uint4 n, uint8_t *p) const;
     void write_block(uint4 n, const uint8_t *p,
 		     bool appending = false) const;
+    void flush_pending_writes() const;
+    void write_changes_block(uint4 n, const uint8_t *p) const;
     [[noreturn]]
     void throw_overwritten() const;
     void block_to_cursor(Glass::Cursor *C_, int j, uint4 n) const;
@@ -839,6 +857,17 @@ class GlassTable {
     /// Set to true the first time the B-tree is modified.
     mutable bool Btree_modified;
 
+    /// Set to true when a block is written, and false by sync().
+    mutable bool unsynced_writes;
+
+    /** Blocks passed to write_block() which haven't been written yet.
+     *
+     *  These are written in ascending order of block number when there are
+     *  enough of them and on commit, so runs of adjacent blocks can be
+     *  written with a single call.
+     */
+    mutable std::map<uint4, std::unique_ptr<uint8_t[]>> pending_writes;
+
     /// set to true when full compaction is to be achieved
     bool full_compaction;
 
@@ -995,6 +1024,45 @@ compare(BItem a, BItem b)
     return diff;
 }
 
+/** Compare two items by their keys, skipping a prefix known to be shared.
+ *
+ *  During a binary chop, every key between two keys which share a prefix
+ *  with the key being looked for must also share that prefix, so we don't
+ *  need to compare it again.  This matters for tables like the postlist
+ *  table, where the keys in a block often all start with the same term.
+ *
+ *  @param common	On entry, the length of a prefix which the keys of @a a
+ *			and @a b are known to share.  On exit, the length of
+ *			the longest prefix which they share.
+ *
+ *  @return negative, zero or positive as for compare(a, b).
+ */
+template<typename ITEM1, typename ITEM2>
+int compare(ITEM1 a, ITEM2 b, int& common)
+{
+    Key key1 = a.key();
+    Key key2 = b.key();
+    const uint8_t* p1 = key1.data();
+    const uint8_t* p2 = key2.data();
+    int key1_len = key1.length();
+    int key2_len = key2.length();
+    int k_smaller = (key2_len < key1_len ? key2_len : key1_len);
+
+    int i = common;
+    AssertRel(i,<=,k_smaller);
+    while (i < k_smaller && p1[i] == p2[i]) ++i;
+    common = i;
+    if (i < k_smaller) return int(p1[i]) - int(p2[i]);
+
+    // If the common part matches, compare the lengths.
+    int diff = key1_len - key2_len;
+    if (diff == 0) {
+	// If the strings match, compare component_of().
+	diff = a.component_of() - b.component_of();
+    }
+    return diff;
+}
+
 }
 
 #ifdef DISABLE_GPL_LIBXAPIAN
@@ -24,6 +24,7 @@ noinst_HEADERS +=\
 	backends/honey/honey_spellingwordslist.h\
 	backends/honey/honey_synonym.h\
 	backends/honey/honey_table.h\
+	backends/honey/honey_termdict.h\
 	backends/honey/honey_termlist.h\
 	backends/honey/honey_termlisttable.h\
 	backends/honey/honey_valuelist.h\
@@ -49,6 +50,7 @@ lib_src +=\
 	backends/honey/honey_spellingwordslist.cc\
 	backends/honey/honey_synonym.cc\
 	backends/honey/honey_table.cc\
+	backends/honey/honey_termdict.cc\
 	backends/honey/honey_termlist.cc\
 	backends/honey/honey_termlisttable.cc\
 	backends/honey/honey_valuelist.cc\
@@ -32,6 +32,8 @@
 
 #include "xapian/error.h"
 
+#include <algorithm>
+
 using namespace std;
 
 void
@@ -215,3 +217,73 @@ HoneyAllTermsList::at_end() const
     Assert(!(cursor == NULL && database));
     RETURN(cursor == NULL);
 }
+
+void
+HoneyTermDictAllTermsList::check_prefix(bool not_at_end)
+{
+    if (!not_at_end || !startswith(it.get_term(), prefix)) {
+	// We've reached the end of the (prefixed) terms.
+	database = NULL;
+    }
+}
+
+Xapian::termcount
+HoneyTermDictAllTermsList::get_approx_size() const
+{
+    // Use the same estimate as HoneyAllTermsList so shards with and without
+    // a term dictionary are treated consistently.
+    return database->postlist_table.get_approx_entry_count();
+}
+
+string
+HoneyTermDictAllTermsList::get_termname() const
+{
+    LOGCALL(DB, string, "HoneyTermDictAllTermsList::get_termname", NO_ARGS);
+    Assert(!at_end());
+    RETURN(it.get_term());
+}
+
+Xapian::doccount
+HoneyTermDictAllTermsList::get_termfreq() const
+{
+    LOGCALL(DB, Xapian::doccount, "HoneyTermDictAllTermsList::get_termfreq",
+	    NO_ARGS);
+    Assert(!at_end());
+    RETURN(it.get_termfreq());
+}
+
+TermList*
+HoneyTermDictAllTermsList::next()
+{
+    LOGCALL(DB, TermList*, "HoneyTermDictAllTermsList::next", NO_ARGS);
+    Assert(database);
+    if (rare(!started)) {
+	started = true;
+	check_prefix(it.skip_to(prefix));
+    } else {
+	check_prefix(it.next());
+    }
+    RETURN(NULL);
+}
+
+TermList*
+HoneyTermDictAllTermsList::skip_to(const string& term)
+{
+    LOGCALL(DB, TermList*, "HoneyTermDictAllTermsList::skip_to", term);
+    if (!database) {
+	// skip_to() once at_end() is allowed but a no-op.
+	RETURN(NULL);
+    }
+    started = true;
+    check_prefix(it.skip_to(max(term, prefix)));
+    RETURN(NULL);
+}
+
+bool
+HoneyTermDictAllTermsList::at_end() const
+{
+    LOGCALL(DB, bool, "HoneyTermDictAllTermsList::at_end", NO_ARGS);
+    // Either next() or skip_to() should be called before at_end().
+    Assert(started);
+    RETURN(!database);
+}
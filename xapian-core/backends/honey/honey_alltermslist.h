@@ -25,6 +25,7 @@
 #include "backends/alltermslist.h"
 #include "honey_database.h"
 #include "honey_postlist.h"
+#include "honey_termdict.h"
 
 class HoneyCursor;
 
@@ -105,4 +106,55 @@ class HoneyAllTermsList : public AllTermsList {
     bool at_end() const;
 };
 
+/** Iterate all terms in a honey database using its term dictionary.
+ *
+ *  Used instead of HoneyAllTermsList when the postlist table has a
+ *  HoneyTermDict, as this needs no reads from disk.
+ */
+class HoneyTermDictAllTermsList : public AllTermsList {
+    /// Copying is not allowed.
+    HoneyTermDictAllTermsList(const HoneyTermDictAllTermsList&) = delete;
+
+    /// Assignment is not allowed.
+    HoneyTermDictAllTermsList&
+	operator=(const HoneyTermDictAllTermsList&) = delete;
+
+    /** Reference to our database.
+     *
+     *  We need this to stop it (and so the term dictionary) being deleted.
+     *  We set this to NULL to signal the iterator has reached the end.
+     */
+    Xapian::Internal::intrusive_ptr<const HoneyDatabase> database;
+
+    /// Our position in the term dictionary.
+    HoneyTermDict::Iterator it;
+
+    /// The prefix to restrict the terms to.
+    std::string prefix;
+
+    /// Have we started iterating yet?
+    bool started = false;
+
+    /// Check we're still within the prefix, and if not mark us as at the end.
+    void check_prefix(bool not_at_end);
+
+  public:
+    HoneyTermDictAllTermsList(const HoneyDatabase* database_,
+			      const HoneyTermDict& dict,
+			      const std::string& prefix_)
+	: database(database_), it(dict), prefix(prefix_) {}
+
+    Xapian::termcount get_approx_size() const;
+
+    std::string get_termname() const;
+
+    Xapian::doccount get_termfreq() const;
+
+    TermList* next();
+
+    TermList* skip_to(const std::string& term);
+
+    bool at_end() const;
+};
+
 #endif /* XAPIAN_INCLUDED_HONEY_ALLTERMSLIST_H */
@@ -1186,9 +1186,8 @@ merge_postlists(Xapian::Compactor* compactor,
 		}
 		out->add(last_key, first_tag);
 
-		if (j != tags.size()) {
-		    // Output continuation chunk(s).
-		    string term;
+		string term;
+		if (j != tags.size() || out->building_term_dict()) {
 		    const char* p = last_key.data();
 		    const char* end = p + last_key.size();
 		    if (!unpack_string_preserving_sort(&p, end, term) ||
@@ -1196,7 +1195,14 @@ merge_postlists(Xapian::Compactor* compactor,
 			throw Xapian::DatabaseCorruptError("Bad postlist "
 							   "chunk key");
 		    }
+		}
+
+		if (out->building_term_dict()) {
+		    out->add_term_dict_entry(term, tf, cf, wdf_max);
+		}
 
+		if (j != tags.size()) {
+		    // Output continuation chunk(s).
 		    while (j < tags.size()) {
 			// Here we merge tags [i,j) to a continuation chunk.
 			size_t i = j;
@@ -2450,6 +2456,9 @@ if (source_backend == Xapian::DB_BACKEND_GLASS) {
 
 	switch (t.type) {
 	    case Honey::POSTLIST: {
+		if (flags & Xapian::DBCOMPACT_TERM_DICTIONARY) {
+		    out->build_term_dict();
+		}
 		if (multipass && inputs.size() > 3) {
 		    multimerge_postlists(compactor, out, destdir,
 					 inputs, offset);
@@ -2487,7 +2496,9 @@ if (source_backend == Xapian::DB_BACKEND_GLASS) {
 	if (single_file) fl_serialised = root_info->get_free_list();
 
 	file_size_type out_size = 0;
-	if (!bad_stat && !single_file_in) {
+	// We still need to track the output size for a single file input as
+	// prev_size is used below to decide whether to pad the output.
+	if (!bad_stat) {
 	    file_size_type db_size;
 	    if (single_file) {
 		db_size = file_size(fd);
@@ -2737,6 +2748,9 @@ if (source_backend == Xapian::DB_BACKEND_GLASS) {
 
 	switch (t.type) {
 	    case Honey::POSTLIST: {
+		if (flags & Xapian::DBCOMPACT_TERM_DICTIONARY) {
+		    out->build_term_dict();
+		}
 		if (multipass && inputs.size() > 3) {
 		    multimerge_postlists(compactor, out, destdir,
 					 inputs, offset);
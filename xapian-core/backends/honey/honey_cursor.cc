@@ -188,15 +188,19 @@ HoneyCursor::do_find(const string& key, bool greater_than)
     }
 
     bool use_index = true;
-    if (!is_at_end && !last_key.empty() && last_key[0] == key[0]) {
+    // The number of initial bytes of a key which the index resolves.
+    size_t index_prefix = chop_index->loaded() ?
+			  chop_index->get_key_size() : 1;
+    if (!is_at_end && !last_key.empty() &&
+	last_key.compare(0, index_prefix, key, 0, index_prefix) == 0) {
 	int cmp0 = last_key.compare(key);
 	if (cmp0 == 0) {
 	    current_key = last_key;
 	    return true;
 	}
 	if (cmp0 < 0) {
-	    // We're going forwards to a key with the same first character, so
-	    // an array index won't help us.
+	    // We're going forwards to a key with the same prefix as far as
+	    // the index can tell, so the index won't help us.
 	    use_index = false;
 	}
     }
@@ -207,7 +211,7 @@ HoneyCursor::do_find(const string& key, bool greater_than)
 
     if (use_index) {
 	store.rewind(root);
-	int index_type = store.read();
+	int index_type = HoneyTable::read_index_type(store);
 	switch (index_type) {
 	    case EOF:
 		return false;
@@ -227,44 +231,26 @@ HoneyCursor::do_find(const string& key, bool greater_than)
 		last_key = string();
 		break;
 	    }
-	    case 0x01: {
-		size_t j = store.read_uint4_be();
-		if (j == 0) {
+	    case 0x01:
+	    case 0x03: {
+		// Type 0x01 always had 4 byte keys.
+		size_t key_size = (index_type == 0x01 ? 4 : store.read());
+		size_t n_index = store.read_uint4_be();
+		if (n_index == 0) {
 		    is_at_end = true;
 		    return false;
 		}
-		off_t base = store.get_pos();
-		char kkey[SSTINDEX_BINARY_CHOP_KEY_SIZE];
-		size_t kkey_len = 0;
-		size_t i = 0;
-		while (j - i > 1) {
-		    size_t k = i + (j - i) / 2;
-		    store.set_pos(base + k * SSTINDEX_BINARY_CHOP_ENTRY_SIZE);
-		    store.read(kkey, SSTINDEX_BINARY_CHOP_KEY_SIZE);
-		    kkey_len = 4;
-		    while (kkey_len > 0 && kkey[kkey_len - 1] == '\0')
-			--kkey_len;
-		    int r = key.compare(0, SSTINDEX_BINARY_CHOP_KEY_SIZE,
-					kkey, kkey_len);
-		    if (r < 0) {
-			j = k;
-		    } else {
-			i = k;
-			if (r == 0) {
-			    break;
-			}
-		    }
-		}
-		store.set_pos(base + i * SSTINDEX_BINARY_CHOP_ENTRY_SIZE);
-		store.read(kkey, SSTINDEX_BINARY_CHOP_KEY_SIZE);
-		kkey_len = 4;
-		while (kkey_len > 0 && kkey[kkey_len - 1] == '\0') --kkey_len;
-		off_t jump = store.read_uint4_be();
+		if (!chop_index->loaded())
+		    chop_index->load(store, n_index, key_size);
+		string index_key;
+		off_t jump = chop_index->find(key, index_key);
 		store.rewind(jump);
-		// The jump point is to the first key with prefix kkey, so will
-		// work if we set last key to kkey.  Unless we're jumping to the
-		// start of the table, in which case last_key needs to be empty.
-		last_key.assign(kkey, jump == 0 ? 0 : kkey_len);
+		// The jump point is to the first key with prefix index_key, so
+		// will work if we set last key to index_key.  Unless we're
+		// jumping to the start of the table, in which case last_key needs
+		// to be empty.
+		if (jump == 0) index_key.resize(0);
+		swap(last_key, index_key);
 		break;
 	    }
 	    case 0x02: {
@@ -39,6 +39,9 @@ class HoneyCursor {
 
     BufferedFile store;
 
+    /// The table's in-memory copy of its index (if it's a binary chop).
+    SSTChopIndex* chop_index;
+
   public:
     std::string current_key, current_tag;
     mutable size_t val_size = 0;
@@ -56,6 +59,7 @@ class HoneyCursor {
     // Forward to next constructor form.
     explicit HoneyCursor(const HoneyTable* table)
 	: store(table->store),
+	  chop_index(&table->chop_index),
 	  comp_stream(Z_DEFAULT_STRATEGY),
 	  root(table->get_root()),
 	  offset(table->get_offset())
@@ -65,6 +69,7 @@ class HoneyCursor {
 
     HoneyCursor(const HoneyCursor& o)
 	: store(o.store),
+	  chop_index(o.chop_index),
 	  current_key(o.current_key),
 	  current_tag(o.current_tag), // FIXME really copy?
 	  val_size(o.val_size),
@@ -326,6 +326,8 @@ HoneyDatabase::open_term_list_direct(Xapian::docid did) const
 TermList*
 HoneyDatabase::open_allterms(const string& prefix) const
 {
+    const HoneyTermDict* dict = postlist_table.get_term_dict();
+    if (dict) return new HoneyTermDictAllTermsList(this, *dict, prefix);
     return new HoneyAllTermsList(this, prefix);
 }
 
@@ -49,6 +49,7 @@ class HoneyDatabase : public Xapian::Database::Internal {
     friend class HoneyPostList;
     friend class HoneySpellingWordsList;
     friend class HoneySynonymTermList;
+    friend class HoneyTermDictAllTermsList;
     friend class HoneyTermList;
 
     /// Don't allow assignment.
@@ -40,6 +40,12 @@ HoneyPostListTable::open_post_list(const HoneyDatabase* db,
 				   bool need_read_pos) const
 {
     Assert(!term.empty());
+    const HoneyTermDict* dict = get_term_dict();
+    if (dict && !dict->find(term, NULL, NULL, NULL)) {
+	// No need to touch the table for a term which isn't present.
+	return nullptr;
+    }
+
     // Try to position cursor first so we avoid creating HoneyPostList objects
     // for terms which don't exist.
     unique_ptr<HoneyCursor> cursor(cursor_get());
@@ -57,6 +63,15 @@ HoneyPostListTable::get_freqs(const std::string& term,
 			      Xapian::doccount* termfreq_ptr,
 			      Xapian::termcount* collfreq_ptr) const
 {
+    const HoneyTermDict* dict = get_term_dict();
+    if (dict) {
+	if (!dict->find(term, termfreq_ptr, collfreq_ptr, NULL)) {
+	    if (termfreq_ptr) *termfreq_ptr = 0;
+	    if (collfreq_ptr) *collfreq_ptr = 0;
+	}
+	return;
+    }
+
     string chunk;
     if (!get_exact_entry(Honey::make_postingchunk_key(term), chunk)) {
 	if (termfreq_ptr) *termfreq_ptr = 0;
@@ -128,6 +143,13 @@ HoneyPostListTable::get_used_docid_range(Xapian::doccount doccount,
 Xapian::termcount
 HoneyPostListTable::get_wdf_upper_bound(const std::string& term) const
 {
+    const HoneyTermDict* dict = get_term_dict();
+    if (dict) {
+	Xapian::termcount wdf_max = 0;
+	(void)dict->find(term, NULL, NULL, &wdf_max);
+	return wdf_max;
+    }
+
     string chunk;
     if (!get_exact_entry(Honey::make_postingchunk_key(term), chunk)) {
 	// Term not present.
@@ -51,6 +51,8 @@ class HoneyPostListTable : public HoneyTable {
 	: HoneyTable("postlist", fd, offset_, readonly) { }
 
     bool term_exists(const std::string& term) const {
+	const HoneyTermDict* dict = get_term_dict();
+	if (dict) return dict->find(term, NULL, NULL, NULL);
 	return key_exists(pack_honey_postlist_key(term));
     }
 
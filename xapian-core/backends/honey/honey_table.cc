@@ -30,6 +30,7 @@
 #include "unicode/description_append.h"
 
 #include <cerrno>
+#include <cstring>
 
 #ifdef DEBUGGING
 # include <iostream>
@@ -99,14 +100,12 @@ HoneyTable::add(const std::string& key,
 	throw Xapian::InvalidOperationError("New key <= previous key");
     size_t reuse = common_prefix_length(last_key, key);
 
-#ifdef SSTINDEX_ARRAY
-    if (reuse == 0) {
-	index.maybe_add_entry(key, store.get_pos());
-    }
-#elif defined SSTINDEX_BINARY_CHOP
-    // For a binary chop index, the index point is before the key info - the
-    // index key must have the same N first bytes as the previous key, where
-    // N >= the keep length.
+#if defined SSTINDEX_ARRAY || defined SSTINDEX_BINARY_CHOP
+    // For an array index, the index point is the first key with each initial
+    // byte.  For a binary chop index, the index point is before the key info
+    // - the index key must have the same N first bytes as the previous key,
+    // where N >= the keep length.  SSTIndex decides which keys are index
+    // points for the type(s) it is building.
     index.maybe_add_entry(key, store.get_pos());
 #elif defined SSTINDEX_SKIPLIST
     // Handled below.
@@ -137,6 +136,39 @@ HoneyTable::add(const std::string& key,
     last_key = key;
 }
 
+const HoneyTermDict*
+HoneyTable::get_term_dict() const
+{
+    if (!read_only) return NULL;
+    if (rare(!store.is_open())) {
+	if (store.was_forced_closed())
+	    throw_database_closed();
+	return NULL;
+    }
+    if (!term_dict_checked) {
+	term_dict_checked = true;
+	store.rewind(root);
+	if (store.read() == 0x04) {
+	    string data(store.read_uint4_be(), '\0');
+	    store.read(&data[0], data.size());
+	    term_dict.reset(new HoneyTermDict(std::move(data)));
+	}
+    }
+    return term_dict.get();
+}
+
+int
+HoneyTable::read_index_type(const BufferedFile& store)
+{
+    int index_type = store.read();
+    if (index_type == 0x04) {
+	// Skip the term dictionary.
+	store.skip(store.read_uint4_be());
+	index_type = store.read();
+    }
+    return index_type;
+}
+
 void
 HoneyTable::commit(honey_revision_number_t, RootInfo* root_info)
 {
@@ -258,7 +290,7 @@ HoneyTable::get_exact_entry(const std::string& key, std::string* tag) const
     bool exact_match = false;
     bool compressed = false;
     size_t val_size = 0;
-    int index_type = store.read();
+    int index_type = read_index_type(store);
     switch (index_type) {
 	case EOF:
 	    return false;
@@ -277,41 +309,23 @@ HoneyTable::get_exact_entry(const std::string& key, std::string* tag) const
 	    last_key = string();
 	    break;
 	}
-	case 0x01: {
-	    size_t j = store.read_uint4_be();
-	    if (j == 0)
+	case 0x01:
+	case 0x03: {
+	    // Type 0x01 always had 4 byte keys.
+	    size_t key_size = (index_type == 0x01 ? 4 : store.read());
+	    size_t n_index = store.read_uint4_be();
+	    if (n_index == 0)
 		return false;
-	    off_t base = store.get_pos();
-	    char kkey[SSTINDEX_BINARY_CHOP_KEY_SIZE];
-	    size_t kkey_len = 0;
-	    size_t i = 0;
-	    while (j - i > 1) {
-		size_t k = i + (j - i) / 2;
-		store.set_pos(base + k * SSTINDEX_BINARY_CHOP_ENTRY_SIZE);
-		store.read(kkey, SSTINDEX_BINARY_CHOP_KEY_SIZE);
-		kkey_len = 4;
-		while (kkey_len > 0 && kkey[kkey_len - 1] == '\0') --kkey_len;
-		int r = key.compare(0, SSTINDEX_BINARY_CHOP_KEY_SIZE,
-				    kkey, kkey_len);
-		if (r < 0) {
-		    j = k;
-		} else {
-		    i = k;
-		    if (r == 0) {
-			break;
-		    }
-		}
-	    }
-	    store.set_pos(base + i * SSTINDEX_BINARY_CHOP_ENTRY_SIZE);
-	    store.read(kkey, SSTINDEX_BINARY_CHOP_KEY_SIZE);
-	    kkey_len = 4;
-	    while (kkey_len > 0 && kkey[kkey_len - 1] == '\0') --kkey_len;
-	    off_t jump = store.read_uint4_be();
+	    if (!chop_index.loaded())
+		chop_index.load(store, n_index, key_size);
+	    string index_key;
+	    off_t jump = chop_index.find(key, index_key);
 	    store.rewind(jump);
-	    // The jump point is to the first key with prefix kkey, so will
-	    // work if we set last key to kkey.  Unless we're jumping to the
+	    // The jump point is to the first key with prefix index_key, so will
+	    // work if we set last key to index_key.  Unless we're jumping to the
 	    // start of the table, in which case last_key needs to be empty.
-	    last_key.assign(kkey, jump == 0 ? 0 : kkey_len);
+	    if (jump == 0) index_key.resize(0);
+	    swap(last_key, index_key);
 	    break;
 	}
 	case 0x02: {
@@ -460,3 +474,95 @@ HoneyTable::cursor_get() const
     }
     return new HoneyCursor(this);
 }
+
+/// Decode a zero-padded big-endian integer from an index entry's key.
+static uint64_t
+chop_index_key(const unsigned char* p, size_t len)
+{
+    uint64_t k = 0;
+    for (size_t i = 0; i != 8; ++i) {
+	k <<= 8;
+	if (i < len) k |= p[i];
+    }
+    return k;
+}
+
+namespace {
+
+/// Fill SSTChopIndex arrays in Eytzinger order by an in-order traversal.
+class EytzingerFiller {
+    const unsigned char* p;
+
+    size_t key_size;
+
+    std::vector<uint64_t>& keys;
+
+    std::vector<uint4>& ptrs;
+
+  public:
+    EytzingerFiller(const unsigned char* entries, size_t key_size_,
+		    std::vector<uint64_t>& keys_, std::vector<uint4>& ptrs_)
+	: p(entries), key_size(key_size_), keys(keys_), ptrs(ptrs_) { }
+
+    void fill(size_t k) {
+	if (k >= keys.size()) return;
+	fill(2 * k);
+	keys[k] = chop_index_key(p, key_size);
+	p += key_size;
+	ptrs[k] = unaligned_read4(p);
+	p += SSTINDEX_BINARY_CHOP_PTR_SIZE;
+	fill(2 * k + 1);
+    }
+};
+
+}
+
+void
+SSTChopIndex::load(BufferedFile& store, size_t n, size_t key_size_)
+{
+    if (key_size_ == 0 || key_size_ > 8)
+	throw Xapian::DatabaseCorruptError("Bad binary chop index key size");
+    key_size = key_size_;
+    string entries(n * (key_size + SSTINDEX_BINARY_CHOP_PTR_SIZE), '\0');
+    store.read(&entries[0], entries.size());
+    keys.resize(n + 1);
+    ptrs.resize(n + 1);
+    EytzingerFiller filler(reinterpret_cast<const unsigned char*>(entries.data()),
+			   key_size, keys, ptrs);
+    filler.fill(1);
+    // The smallest key is found by always taking the left child.
+    leftmost = 1;
+    while (leftmost * 2 <= n) leftmost *= 2;
+}
+
+off_t
+SSTChopIndex::find(const string& key, string& index_key) const
+{
+    // Convert the first bytes of key to an integer in the same way as the
+    // index entries.  A key which matches an index entry except for having
+    // trailing zero bytes compares equal, but as we want the last entry <=
+    // key that doesn't matter.
+    uint64_t k_int =
+	chop_index_key(reinterpret_cast<const unsigned char*>(key.data()),
+		       min(key.size(), key_size));
+
+    // Find the last entry <= key - that's the last one we go right from.  If
+    // there isn't one, we start from the first entry, which points to the
+    // start of the table.
+    size_t best = leftmost;
+    size_t k = 1;
+    while (k < keys.size()) {
+	bool le = (keys[k] <= k_int);
+	best = le ? k : best;
+	k = 2 * k + le;
+    }
+
+    uint64_t entry = keys[best];
+    size_t len = key_size;
+    while (len > 0 && ((entry >> (64 - 8 * len)) & 0xff) == 0) --len;
+    index_key.resize(len);
+    for (size_t i = 0; i != len; ++i) {
+	index_key[i] = char(entry >> (56 - 8 * i));
+    }
+    return ptrs[best];
+}
@@ -25,11 +25,20 @@
 # error config.h must be included first in each C++ source file
 #endif
 
+// If both SSTINDEX_ARRAY and SSTINDEX_BINARY_CHOP are defined, both types
+// of index are built and the one which suits the table better is written.
 #define SSTINDEX_ARRAY
-//#define SSTINDEX_BINARY_CHOP
+#define SSTINDEX_BINARY_CHOP
 //#define SSTINDEX_SKIPLIST
 
-#define SSTINDEX_BINARY_CHOP_KEY_SIZE 4
+#if defined SSTINDEX_SKIPLIST && \
+    (defined SSTINDEX_ARRAY || defined SSTINDEX_BINARY_CHOP)
+# error SSTINDEX_SKIPLIST cannot be combined with other SSTINDEX types
+#endif
+
+// Index type 0x01 always used 4 byte keys; type 0x03 stores the key size in
+// its header, and this is the size we use when writing one.
+#define SSTINDEX_BINARY_CHOP_KEY_SIZE 8
 #define SSTINDEX_BINARY_CHOP_PTR_SIZE 4
 #define SSTINDEX_BINARY_CHOP_ENTRY_SIZE \
     (SSTINDEX_BINARY_CHOP_KEY_SIZE + SSTINDEX_BINARY_CHOP_PTR_SIZE)
@@ -42,9 +51,13 @@
 #include <iostream> // FIXME
 #endif
 
+#include <cstdint>
 #include <cstdio> // For EOF
 #include <cstdlib> // std::abort()
+#include <memory>
+#include <string>
 #include <type_traits>
+#include <vector>
 #ifdef HAVE_SYS_UIO_H
 # include <sys/uio.h>
 #endif
@@ -55,6 +68,7 @@
 
 #include "compression_stream.h"
 #include "honey_defs.h"
+#include "honey_termdict.h"
 #include "honey_version.h"
 #include "internaltypes.h"
 #include "io_utils.h"
@@ -339,7 +353,7 @@ class HoneyCursor;
 
 class SSTIndex {
     std::string data;
-#if defined SSTINDEX_BINARY_CHOP
+#ifdef SSTINDEX_BINARY_CHOP
     size_t block = size_t(-1);
 #elif defined SSTINDEX_SKIPLIST
     size_t block = 0;
@@ -357,34 +371,41 @@ class SSTIndex {
     off_t* pointers = NULL;
 #endif
 
-  public:
-    SSTIndex() {
-#ifdef SSTINDEX_ARRAY
-	// Header added in write() method.
-#elif defined SSTINDEX_BINARY_CHOP
-	data.assign(5, '\x01');
-#elif defined SSTINDEX_SKIPLIST
-	data.assign(1, '\x02');
-#else
-# error SSTINDEX type not specified
-#endif
-    }
+#if defined SSTINDEX_ARRAY && defined SSTINDEX_BINARY_CHOP
+    /** Track how much of the table a lookup would need to scan.
+     *
+     *  A lookup jumps to an index point and then scans forwards, so for a
+     *  randomly chosen key the expected scan length is proportional to the
+     *  sum of the squares of the gaps between consecutive index points.
+     */
+    class ScanCost {
+	off_t last_ptr = 0;
 
-    ~SSTIndex() {
-#ifdef SSTINDEX_ARRAY
-	delete [] pointers;
+	double cost = 0.0;
+
+      public:
+	void add_point(off_t ptr) {
+	    double gap = double(ptr - last_ptr);
+	    cost += gap * gap;
+	    last_ptr = ptr;
+	}
+
+	double get_cost() const { return cost; }
+    };
+
+    ScanCost array_cost, chop_cost;
 #endif
-    }
 
-    void maybe_add_entry(const std::string& key, off_t ptr) {
 #ifdef SSTINDEX_ARRAY
+    void add_array_entry(const std::string& key, off_t ptr) {
 	unsigned char initial = key[0];
 	if (!pointers) {
 	    pointers = new off_t[256]();
 	    first = initial;
+	} else if (initial == last) {
+	    // Only the first key with each initial byte is an index point.
+	    return;
 	}
-	// We should only be called for valid index points.
-	AssertRel(int(initial), !=, last);
 
 	while (++last != int(initial)) {
 	    pointers[last] = ptr;
@@ -393,7 +414,37 @@ class SSTIndex {
 	}
 	pointers[initial] = ptr;
 	last = initial;
-#elif defined SSTINDEX_BINARY_CHOP
+#ifdef SSTINDEX_BINARY_CHOP
+	array_cost.add_point(ptr);
+#endif
+    }
+
+    void write_array_index() {
+	if (!pointers) {
+	    first = last = 0;
+	    pointers = new off_t[1]();
+	}
+	data.resize(0);
+	data.resize(3 + (last - first + 1) * 4);
+	data[0] = 0;
+	data[1] = first;
+	data[2] = last - first;
+	for (unsigned ch = first; ch <= last; ++ch) {
+	    size_t o = 3 + (ch - first) * 4;
+	    // FIXME: Just make offsets 8 bytes?  Or allow different widths?
+	    off_t ptr = pointers[ch];
+	    if (sizeof(off_t) > 4 && ptr > off_t(0xffffffff))
+		throw Xapian::DatabaseError("Index offset needs >4 bytes");
+	    Assert(o + 4 <= data.size());
+	    unaligned_write4(reinterpret_cast<unsigned char*>(&data[o]), ptr);
+	}
+	delete [] pointers;
+	pointers = NULL;
+    }
+#endif
+
+#ifdef SSTINDEX_BINARY_CHOP
+    void add_chop_entry(const std::string& key, off_t ptr) {
 	// We store entries truncated to a maximum width (and trailing zeros
 	// are used to indicate keys shorter than that max width).  These then
 	// point to the first key that maps to this truncated value.
@@ -441,55 +492,16 @@ class SSTIndex {
 #endif
 	data += last_index_key;
 	size_t c = data.size();
-	data.resize(c + 4);
+	data.resize(c + SSTINDEX_BINARY_CHOP_PTR_SIZE);
 	unaligned_write4(reinterpret_cast<unsigned char*>(&data[c]), ptr);
 
 	block = cur_block;
-#elif defined SSTINDEX_SKIPLIST
-	size_t cur_block = ptr / INDEXBLOCK;
-	if (cur_block == block) return;
-
-	size_t reuse = common_prefix_length(last_index_key, key);
-
-	data += char(reuse);
-	data += char(key.size() - reuse);
-	data.append(key, reuse, key.size() - reuse);
-	pack_uint(data, static_cast<std::make_unsigned<off_t>::type>(ptr));
-
-	block = cur_block;
-	// FIXME: deal with parent_index...
-
-	last_index_key = key;
-#else
-# error SSTINDEX type not specified
+#ifdef SSTINDEX_ARRAY
+	chop_cost.add_point(ptr);
 #endif
     }
 
-    off_t write(BufferedFile& store) {
-	off_t root = store.get_pos();
-
-#ifdef SSTINDEX_ARRAY
-	if (!pointers) {
-	    first = last = 0;
-	    pointers = new off_t[1]();
-	}
-	data.resize(0);
-	data.resize(3 + (last - first + 1) * 4);
-	data[0] = 0;
-	data[1] = first;
-	data[2] = last - first;
-	for (unsigned ch = first; ch <= last; ++ch) {
-	    size_t o = 3 + (ch - first) * 4;
-	    // FIXME: Just make offsets 8 bytes?  Or allow different widths?
-	    off_t ptr = pointers[ch];
-	    if (sizeof(off_t) > 4 && ptr > off_t(0xffffffff))
-		throw Xapian::DatabaseError("Index offset needs >4 bytes");
-	    Assert(o + 4 <= data.size());
-	    unaligned_write4(reinterpret_cast<unsigned char*>(&data[o]), ptr);
-	}
-	delete [] pointers;
-	pointers = NULL;
-#elif defined SSTINDEX_BINARY_CHOP
+    void write_chop_index(off_t root) {
 	if (last_index_key.size() == SSTINDEX_BINARY_CHOP_KEY_SIZE) {
 	    // Increment final byte(s) to give a key which is definitely
 	    // at or above any key which this could be truncated from.
@@ -515,17 +527,99 @@ class SSTIndex {
 	{
 	    data += last_index_key;
 	    size_t c = data.size();
-	    data.resize(c + 4);
+	    data.resize(c + SSTINDEX_BINARY_CHOP_PTR_SIZE);
 	    unaligned_write4(reinterpret_cast<unsigned char*>(&data[c]), root);
 	}
 
 skip_adding_upper_bound:
-	// Fill in bytes 1 to 4 with the number of entries.
-	size_t n_index = (data.size() - 5) / SSTINDEX_BINARY_CHOP_ENTRY_SIZE;
-	data[1] = n_index >> 24;
-	data[2] = n_index >> 16;
-	data[3] = n_index >> 8;
-	data[4] = n_index;
+	// Fill in bytes 2 to 5 with the number of entries.
+	size_t n_index = (data.size() - 6) / SSTINDEX_BINARY_CHOP_ENTRY_SIZE;
+	data[2] = n_index >> 24;
+	data[3] = n_index >> 16;
+	data[4] = n_index >> 8;
+	data[5] = n_index;
+    }
+#endif
+
+  public:
+    SSTIndex() {
+#ifdef SSTINDEX_BINARY_CHOP
+	// Type, key size, then 4 bytes for the number of entries which we fill
+	// in when we write the index.
+	data.assign(6, '\x03');
+	data[1] = SSTINDEX_BINARY_CHOP_KEY_SIZE;
+#elif defined SSTINDEX_ARRAY
+	// Header added in write() method.
+#elif defined SSTINDEX_SKIPLIST
+	data.assign(1, '\x02');
+#else
+# error SSTINDEX type not specified
+#endif
+    }
+
+    ~SSTIndex() {
+#ifdef SSTINDEX_ARRAY
+	delete [] pointers;
+#endif
+    }
+
+    /** Consider adding an index entry for @a key.
+     *
+     *  For the array and binary chop index types, this should be called
+     *  with the position before @a key is written; for the skiplist index
+     *  type, with the position after @a key is written.
+     */
+    void maybe_add_entry(const std::string& key, off_t ptr) {
+#if defined SSTINDEX_ARRAY || defined SSTINDEX_BINARY_CHOP
+# ifdef SSTINDEX_ARRAY
+	add_array_entry(key, ptr);
+# endif
+# ifdef SSTINDEX_BINARY_CHOP
+	add_chop_entry(key, ptr);
+# endif
+#elif defined SSTINDEX_SKIPLIST
+	size_t cur_block = ptr / INDEXBLOCK;
+	if (cur_block == block) return;
+
+	size_t reuse = common_prefix_length(last_index_key, key);
+
+	data += char(reuse);
+	data += char(key.size() - reuse);
+	data.append(key, reuse, key.size() - reuse);
+	pack_uint(data, static_cast<std::make_unsigned<off_t>::type>(ptr));
+
+	block = cur_block;
+	// FIXME: deal with parent_index...
+
+	last_index_key = key;
+#else
+# error SSTINDEX type not specified
+#endif
+    }
+
+    /** Write the index.
+     *
+     *  @param root	The end of the table's entries.
+     */
+    void write(BufferedFile& store, off_t root) {
+#if defined SSTINDEX_ARRAY && defined SSTINDEX_BINARY_CHOP
+	// Pick whichever index type suits this table's keys best.  The array
+	// index is a single lookup, but can leave a long scan if a lot of keys
+	// share their initial byte (e.g. a boolean term prefix); the binary
+	// chop index resolves more of each key, but needs several probes.  So
+	// we only use the binary chop index when it at least halves the
+	// expected scan.
+	array_cost.add_point(root);
+	chop_cost.add_point(root);
+	if (chop_cost.get_cost() * 2.0 < array_cost.get_cost()) {
+	    write_chop_index(root);
+	} else {
+	    write_array_index();
+	}
+#elif defined SSTINDEX_ARRAY
+	write_array_index();
+#elif defined SSTINDEX_BINARY_CHOP
+	write_chop_index(root);
 #elif defined SSTINDEX_SKIPLIST
 	// Already built in data.
 #else
@@ -534,7 +628,6 @@ skip_adding_upper_bound:
 
 	store.write(data.data(), data.size());
 	// FIXME: parent stuff...
-	return root;
     }
 
     size_t size() const {
@@ -546,6 +639,57 @@ skip_adding_upper_bound:
     }
 };
 
+/** In-memory copy of a binary chop index, used when searching a table.
+ *
+ *  Rather than reading every probe of the binary chop from the file, we read
+ *  the index entries in once and store them in Eytzinger order (i.e. laid out
+ *  like a binary heap, with the children of entry k at 2k and 2k+1).  The
+ *  first few levels of every search then share a handful of cache lines, and
+ *  the search loop has no data-dependent branches.
+ */
+class SSTChopIndex {
+    /** Index keys as big-endian integers, in Eytzinger order.
+     *
+     *  Keys shorter than 8 bytes are padded with zero bytes, which preserves
+     *  their order.  Element 0 is unused, so the root of the implicit tree is
+     *  at 1.
+     */
+    std::vector<std::uint64_t> keys;
+
+    /// The file offsets corresponding to each entry in keys.
+    std::vector<uint4> ptrs;
+
+    /// Position of the smallest key in keys.
+    size_t leftmost = 0;
+
+    /// The size of the keys in the index.
+    size_t key_size = 0;
+
+  public:
+    bool loaded() const { return !keys.empty(); }
+
+    /// The number of initial bytes of a key which the index resolves.
+    size_t get_key_size() const { return key_size; }
+
+    /** Read the index entries.
+     *
+     *  @param store	Positioned just after the entry count.
+     *  @param n	The number of entries.
+     *  @param key_size_	The size of each entry's key (at most 8).
+     */
+    void load(BufferedFile& store, size_t n, size_t key_size_);
+
+    /** Find the index entry to start a search for @a key from.
+     *
+     *  @param key		The key to search for.
+     *  @param[out] index_key	Set to the key for the entry found, without
+     *				any zero padding.
+     *
+     *  @return The file offset the entry points to.
+     */
+    off_t find(const std::string& key, std::string& index_key) const;
+};
+
 class HoneyCursor;
 class MutableHoneyCursor;
 
@@ -561,10 +705,21 @@ class HoneyTable {
     mutable BufferedFile store;
     mutable std::string last_key;
     SSTIndex index;
+    /// In-memory copy of the index, loaded on demand if it's a binary chop.
+    mutable SSTChopIndex chop_index;
     off_t root = -1;
     honey_tablesize_t num_entries = 0;
     bool lazy;
 
+    /// Builds a term dictionary as the table is written, if requested.
+    std::unique_ptr<HoneyTermDictBuilder> term_dict_builder;
+
+    /// The term dictionary, loaded on demand.
+    mutable std::unique_ptr<HoneyTermDict> term_dict;
+
+    /// Have we checked for a term dictionary yet?
+    mutable bool term_dict_checked = false;
+
     bool single_file() const { return path.empty(); }
 
     /** Offset to add to pointers in this table.
@@ -640,10 +795,58 @@ class HoneyTable {
     }
 
     void flush_db() {
-	root = index.write(store);
+	root = store.get_pos();
+	if (term_dict_builder) {
+	    // The term dictionary goes between the entries and the index, so
+	    // root still marks the end of the entries.
+	    std::string dict = term_dict_builder->get_data();
+	    if (dict.size() > 0xffffffff)
+		throw Xapian::DatabaseError("Honey term dictionary too large");
+	    unsigned char header[5] = { 0x04 };
+	    unaligned_write4(header + 1, dict.size());
+	    store.write(reinterpret_cast<const char*>(header), sizeof(header));
+	    store.write(dict.data(), dict.size());
+	}
+	index.write(store, root);
 	store.flush();
     }
 
+    /** Build a term dictionary as this table is written.
+     *
+     *  Only meaningful for the postlist table.  Terms are added by calling
+     *  add_term_dict_entry().
+     */
+    void build_term_dict() {
+	term_dict_builder.reset(new HoneyTermDictBuilder);
+    }
+
+    /// Are we building a term dictionary?
+    bool building_term_dict() const { return bool(term_dict_builder); }
+
+    /// Add an entry to the term dictionary being built.
+    void add_term_dict_entry(const std::string& term,
+			     Xapian::doccount tf,
+			     Xapian::termcount cf,
+			     Xapian::termcount wdf_max) {
+	term_dict_builder->add(term, tf, cf, wdf_max);
+    }
+
+    /** Return the term dictionary for this table.
+     *
+     *  The dictionary is read into memory the first time this is called.
+     *
+     *  @return The term dictionary, or NULL if this table doesn't have one.
+     */
+    const HoneyTermDict* get_term_dict() const;
+
+    /** Read the type byte of the index.
+     *
+     *  @param store	Positioned at the table's root.
+     *
+     *  Any term dictionary stored before the index is skipped over.
+     */
+    static int read_index_type(const BufferedFile& store);
+
     void cancel(const Honey::RootInfo&, honey_revision_number_t) {
 	std::abort();
     }
@@ -0,0 +1,223 @@
+/** @file
+ * @brief Compact in-memory dictionary of the terms in a honey database
+ */
+/* Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <config.h>
+
+#include "honey_termdict.h"
+
+#include "omassert.h"
+#include "pack.h"
+#include "stringutils.h"
+#include "wordaccess.h"
+
+#include "xapian/error.h"
+
+#include <cstdint>
+
+using namespace std;
+
+[[noreturn]]
+static void
+throw_corrupt()
+{
+    throw Xapian::DatabaseCorruptError("Bad honey term dictionary");
+}
+
+static inline size_t
+read_offset(const char* p)
+{
+    return unaligned_read4(reinterpret_cast<const unsigned char*>(p));
+}
+
+/** Decode the entry at *pp, updating term which holds the previous term.
+ *
+ *  Any of the pointers to freqs can be NULL if that freq isn't wanted.
+ */
+static void
+decode_entry(const char** pp, const char* end, string& term,
+	     Xapian::doccount* tf_ptr,
+	     Xapian::termcount* cf_ptr,
+	     Xapian::termcount* wdf_max_ptr)
+{
+    const char* p = *pp;
+    if (end - p < 2) throw_corrupt();
+    size_t reuse = static_cast<unsigned char>(*p++);
+    size_t len = static_cast<unsigned char>(*p++);
+    if (reuse > term.size() || size_t(end - p) < len) throw_corrupt();
+    term.resize(reuse);
+    term.append(p, len);
+    p += len;
+    Xapian::doccount tf;
+    Xapian::termcount cf, wdf_max;
+    if (!unpack_uint(&p, end, &tf) ||
+	!unpack_uint(&p, end, &cf) ||
+	!unpack_uint(&p, end, &wdf_max)) {
+	throw_corrupt();
+    }
+    if (tf_ptr) *tf_ptr = tf;
+    if (cf_ptr) *cf_ptr = cf;
+    if (wdf_max_ptr) *wdf_max_ptr = wdf_max;
+    *pp = p;
+}
+
+HoneyTermDict::HoneyTermDict(string&& data_)
+    : data(std::move(data_))
+{
+    if (data.size() < 4) throw_corrupt();
+    n_blocks = read_offset(data.data());
+    if ((data.size() - 4) / 4 < n_blocks) throw_corrupt();
+    // Check the offsets are sane and the first term of each block is in range
+    // up front so find_block() doesn't need to.
+    for (size_t b = 0; b != n_blocks; ++b) {
+	const char* p = block_start(b);
+	const char* end = block_start(b + 1);
+	if (end - p < 2 || p[0] != 0 ||
+	    size_t(end - p) - 2 < static_cast<unsigned char>(p[1])) {
+	    throw_corrupt();
+	}
+    }
+}
+
+const char*
+HoneyTermDict::block_start(size_t b) const
+{
+    const char* blocks = data.data() + 4 + n_blocks * 4;
+    if (b == n_blocks) return data.data() + data.size();
+    size_t offset = read_offset(data.data() + 4 + b * 4);
+    if (offset > size_t(data.data() + data.size() - blocks)) throw_corrupt();
+    return blocks + offset;
+}
+
+size_t
+HoneyTermDict::find_block(const string& term) const
+{
+    // Count the blocks whose first term is <= term.
+    size_t lo = 0, hi = n_blocks;
+    while (lo < hi) {
+	size_t mid = lo + (hi - lo) / 2;
+	const char* p = block_start(mid);
+	size_t len = static_cast<unsigned char>(p[1]);
+	if (term.compare(0, string::npos, p + 2, len) >= 0) {
+	    lo = mid + 1;
+	} else {
+	    hi = mid;
+	}
+    }
+    return lo == 0 ? n_blocks : lo - 1;
+}
+
+bool
+HoneyTermDict::find(const string& term,
+		    Xapian::doccount* tf_ptr,
+		    Xapian::termcount* cf_ptr,
+		    Xapian::termcount* wdf_max_ptr) const
+{
+    size_t b = find_block(term);
+    if (b == n_blocks) return false;
+    const char* p = block_start(b);
+    const char* end = block_start(b + 1);
+    string entry_term;
+    while (p != end) {
+	Xapian::doccount tf;
+	Xapian::termcount cf, wdf_max;
+	decode_entry(&p, end, entry_term, &tf, &cf, &wdf_max);
+	int cmp = entry_term.compare(term);
+	if (cmp < 0) continue;
+	if (cmp > 0) break;
+	if (tf_ptr) *tf_ptr = tf;
+	if (cf_ptr) *cf_ptr = cf;
+	if (wdf_max_ptr) *wdf_max_ptr = wdf_max;
+	return true;
+    }
+    return false;
+}
+
+bool
+HoneyTermDict::Iterator::next()
+{
+    if (p == p_end) {
+	if (block == dict.n_blocks) return false;
+	p = dict.block_start(block);
+	p_end = dict.block_start(++block);
+	if (p == p_end) throw_corrupt();
+    }
+    decode_entry(&p, p_end, term, &tf, NULL, NULL);
+    return true;
+}
+
+bool
+HoneyTermDict::Iterator::skip_to(const string& target)
+{
+    if (p && target <= term) return true;
+    size_t b = dict.find_block(target);
+    if (b != dict.n_blocks && b >= block) {
+	// Jump straight to the block target would be in.
+	block = b;
+	p = p_end = nullptr;
+    }
+    while (next()) {
+	if (term >= target) return true;
+    }
+    return false;
+}
+
+void
+HoneyTermDictBuilder::add(const string& term,
+			  Xapian::doccount tf,
+			  Xapian::termcount cf,
+			  Xapian::termcount wdf_max)
+{
+    Assert(term > last_term);
+    size_t reuse = 0;
+    if (n_terms % HONEY_TERMDICT_BLOCK_SIZE == 0) {
+	if (blocks.size() > UINT32_MAX) {
+	    throw Xapian::DatabaseError("Honey term dictionary too large");
+	}
+	char buf[4];
+	unaligned_write4(reinterpret_cast<unsigned char*>(buf), blocks.size());
+	offsets.append(buf, 4);
+    } else {
+	reuse = common_prefix_length(last_term, term);
+    }
+    // Terms are at most HONEY_MAX_KEY_LENGTH bytes so these fit in a byte.
+    AssertRel(term.size(), <, 256);
+    blocks += char(reuse);
+    blocks += char(term.size() - reuse);
+    blocks.append(term, reuse, string::npos);
+    pack_uint(blocks, tf);
+    pack_uint(blocks, cf);
+    pack_uint(blocks, wdf_max);
+    last_term = term;
+    ++n_terms;
+}
+
+string
+HoneyTermDictBuilder::get_data() const
+{
+    string result;
+    char buf[4];
+    unaligned_write4(reinterpret_cast<unsigned char*>(buf),
+		     offsets.size() / 4);
+    result.reserve(4 + offsets.size() + blocks.size());
+    result.append(buf, 4);
+    result += offsets;
+    result += blocks;
+    return result;
+}
@@ -0,0 +1,169 @@
+/** @file
+ * @brief Compact in-memory dictionary of the terms in a honey database
+ */
+/* Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifndef XAPIAN_INCLUDED_HONEY_TERMDICT_H
+#define XAPIAN_INCLUDED_HONEY_TERMDICT_H
+
+#include "xapian/types.h"
+
+#include <string>
+
+/** Number of terms in each block of a HoneyTermDict.
+ *
+ *  The first term in each block is stored in full so we can binary chop on
+ *  the blocks, and the others are front-coded against the previous term.
+ */
+#define HONEY_TERMDICT_BLOCK_SIZE 16
+
+/** Compact dictionary of the terms in a honey postlist table.
+ *
+ *  This is optionally built when compacting (see
+ *  Xapian::DBCOMPACT_TERM_DICTIONARY) and stored between the entries and the
+ *  index of the postlist table.  It lists every term along with its termfreq,
+ *  collection freq and maximum wdf, so these can be looked up and the terms
+ *  enumerated without reading and decoding postlist table entries.
+ *
+ *  The format is:
+ *
+ *  - Number of blocks (4 bytes, big endian)
+ *  - Offset of each block from the start of the first (4 bytes each, big
+ *    endian)
+ *  - The blocks, each of which holds up to HONEY_TERMDICT_BLOCK_SIZE entries
+ *    of the form: bytes of the previous term reused (1 byte, always 0 for the
+ *    first entry in a block), length of the rest of the term (1 byte), the
+ *    rest of the term, then pack_uint() encoded termfreq, collection freq and
+ *    maximum wdf.
+ *
+ *  The in-memory form is just these bytes so loading it is a single read.
+ */
+class HoneyTermDict {
+    /// The encoded dictionary.
+    std::string data;
+
+    /// The number of blocks.
+    size_t n_blocks;
+
+    /// Return pointer to the start of block @a b (or the end if n_blocks).
+    const char* block_start(size_t b) const;
+
+    /** Find the block @a term would be in.
+     *
+     *  @return The last block whose first term is <= @a term, or n_blocks if
+     *		@a term sorts before every term in the dictionary.
+     */
+    size_t find_block(const std::string& term) const;
+
+  public:
+    /** Construct from the encoded dictionary.
+     *
+     *  @param data_	The encoded dictionary, as written by
+     *			HoneyTermDictBuilder.
+     */
+    explicit HoneyTermDict(std::string&& data_);
+
+    /** Look up a term.
+     *
+     *  @param term	The term to look up.
+     *  @param tf_ptr	If non-NULL, set to the termfreq.
+     *  @param cf_ptr	If non-NULL, set to the collection freq.
+     *  @param wdf_max_ptr	If non-NULL, set to the maximum wdf.
+     *
+     *  @return true if @a term is present (otherwise the values pointed to
+     *		are left unchanged).
+     */
+    bool find(const std::string& term,
+	      Xapian::doccount* tf_ptr,
+	      Xapian::termcount* cf_ptr,
+	      Xapian::termcount* wdf_max_ptr) const;
+
+    /// Iterates over the terms in a HoneyTermDict in ascending order.
+    class Iterator {
+	/// The dictionary we're iterating.
+	const HoneyTermDict& dict;
+
+	/// The next block to start reading.
+	size_t block = 0;
+
+	/// The next entry to decode in the current block.
+	const char* p = nullptr;
+
+	/// The end of the current block.
+	const char* p_end = nullptr;
+
+	/// The current term.
+	std::string term;
+
+	/// The termfreq of the current term.
+	Xapian::doccount tf = 0;
+
+      public:
+	explicit Iterator(const HoneyTermDict& dict_) : dict(dict_) {}
+
+	/** Advance to the next term.
+	 *
+	 *  @return false if we've reached the end.
+	 */
+	bool next();
+
+	/** Advance to the first term >= @a target.
+	 *
+	 *  If already positioned at a term >= @a target, this is a no-op.
+	 *
+	 *  @return false if we've reached the end.
+	 */
+	bool skip_to(const std::string& target);
+
+	/// The current term.
+	const std::string& get_term() const { return term; }
+
+	/// The termfreq of the current term.
+	Xapian::doccount get_termfreq() const { return tf; }
+    };
+};
+
+/// Builds the encoded form of a HoneyTermDict.
+class HoneyTermDictBuilder {
+    /// The encoded blocks.
+    std::string blocks;
+
+    /// The encoded block offsets.
+    std::string offsets;
+
+    /// The previous term added.
+    std::string last_term;
+
+    /// The number of terms added so far.
+    size_t n_terms = 0;
+
+  public:
+    /** Add a term.
+     *
+     *  Terms must be added in ascending order.
+     */
+    void add(const std::string& term,
+	     Xapian::doccount tf,
+	     Xapian::termcount cf,
+	     Xapian::termcount wdf_max);
+
+    /// Return the encoded dictionary.
+    std::string get_data() const;
+};
+
+#endif // XAPIAN_INCLUDED_HONEY_TERMDICT_H
@@ -31,6 +31,7 @@
 #include "negate_unsigned.h"
 
 #include <memory>
+#include <vector>
 
 using namespace std;
 
@@ -369,6 +370,36 @@ MultiDatabase::open_document(Xapian::docid did, bool lazy) const
     return shard->open_document(shard_did, lazy);
 }
 
+void
+MultiDatabase::open_documents(const vector<Xapian::docid>& dids,
+			      const vector<Xapian::valueno>& slots,
+			      vector<Xapian::Document>& docs) const
+{
+    // Split up the docids by shard - they'll still be in ascending order
+    // within each shard - then interleave the results back together.
+    auto n_shards = shards.size();
+    vector<vector<Xapian::docid>> shard_dids(n_shards);
+    for (Xapian::docid did : dids) {
+	Assert(did != 0);
+	shard_dids[shard_number(did, n_shards)].push_back(
+		shard_docid(did, n_shards));
+    }
+
+    vector<vector<Xapian::Document>> shard_docs(n_shards);
+    for (size_type i = 0; i != n_shards; ++i) {
+	if (!shard_dids[i].empty()) {
+	    shards[i]->open_documents(shard_dids[i], slots, shard_docs[i]);
+	}
+    }
+
+    vector<size_t> next(n_shards);
+    docs.reserve(docs.size() + dids.size());
+    for (Xapian::docid did : dids) {
+	auto shard = shard_number(did, n_shards);
+	docs.push_back(std::move(shard_docs[shard][next[shard]++]));
+    }
+}
+
 bool
 MultiDatabase::term_exists(const string& term) const
 {
@@ -387,6 +418,14 @@ MultiDatabase::keep_alive()
     }
 }
 
+void
+MultiDatabase::cache_values(Xapian::valueno slot) const
+{
+    for (auto&& shard : shards) {
+	shard->cache_values(slot);
+    }
+}
+
 TermList*
 MultiDatabase::open_spelling_termlist(const string& word) const
 {
@@ -114,10 +114,16 @@ class MultiDatabase : public Xapian::Database::Internal {
     Xapian::Document::Internal* open_document(Xapian::docid did,
 					      bool lazy) const;
 
+    void open_documents(const std::vector<Xapian::docid>& dids,
+			const std::vector<Xapian::valueno>& slots,
+			std::vector<Xapian::Document>& docs) const;
+
     bool term_exists(const std::string& term) const;
 
     void keep_alive();
 
+    void cache_values(Xapian::valueno slot) const;
+
     TermList* open_spelling_termlist(const std::string& word) const;
 
     TermList* open_spelling_wordlist() const;
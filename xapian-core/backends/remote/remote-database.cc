@@ -44,6 +44,7 @@
 #include "stringutils.h" // For STRINGIZE().
 #include "weight/weightinternal.h"
 
+#include <algorithm>
 #include <cerrno>
 #include <memory>
 #include <string>
@@ -91,7 +92,8 @@ throw_connection_closed_unexpectedly()
 RemoteDatabase::RemoteDatabase(pair<int, string> fd_and_context,
 			       double timeout_,
 			       bool writable,
-			       int flags)
+			       int flags,
+			       bool reused)
     : Xapian::Database::Internal(writable ?
 				 TRANSACTION_NONE :
 				 TRANSACTION_READONLY),
@@ -109,7 +111,22 @@ RemoteDatabase::RemoteDatabase(pair<int, string> fd_and_context,
     }
 #endif
 
-    update_stats(MSG_MAX);
+    if (reused) {
+	// Ask the server to reopen the database so we see the latest revision
+	// as we would with a new connection, and for its stats.  Sending both
+	// messages before reading either reply saves a round trip.  The
+	// server already knows to compress its replies.
+	AssertEq(writable, false);
+	double end_time = RealTime::end_time(timeout);
+	link.enable_compression();
+	link.send_message(MSG_REOPEN, string(), end_time);
+	link.send_message(MSG_UPDATE, string(), end_time);
+	string message;
+	(void)get_message_or_done(message, REPLY_UPDATE);
+	update_stats(MSG_MAX);
+    } else {
+	handshake();
+    }
 
     if (writable) {
 	if (flags & Xapian::DB_RETRY_LOCK) {
@@ -122,6 +139,49 @@ RemoteDatabase::RemoteDatabase(pair<int, string> fd_and_context,
     }
 }
 
+void
+RemoteDatabase::handshake() const
+{
+    update_stats(MSG_MAX);
+
+    // Ask the server to compress large replies, and compress large messages
+    // we send.  The server doesn't reply to this message, so we bypass
+    // send_message() as that would expect a reply.
+    link.send_message(MSG_COMPRESS, string(), RealTime::end_time(timeout));
+    link.enable_compression();
+}
+
+void
+RemoteDatabase::reconnect() const
+{
+    auto fd_and_context = open_connection();
+    link.reset(fd_and_context.first, fd_and_context.first);
+    mru_slot = Xapian::BAD_VALUENO;
+    handshake();
+    reconnect_needed = false;
+}
+
+pair<int, string>
+RemoteDatabase::release_connection()
+{
+    string context = link.get_context();
+    if (pending_reply || reconnect_needed || !is_read_only()) {
+	link.do_close();
+	return {-1, context};
+    }
+    return {link.release(), context};
+}
+
+bool
+RemoteDatabase::abandon_reply() const
+{
+    if (!is_read_only()) return false;
+    link.do_close();
+    pending_reply = false;
+    reconnect_needed = true;
+    return true;
+}
+
 Xapian::termcount
 RemoteDatabase::positionlist_count(Xapian::docid did,
 				   const std::string& term) const
@@ -291,6 +351,7 @@ RemoteDatabase::reopen()
 void
 RemoteDatabase::close()
 {
+    reconnect_needed = false;
     do_close();
 }
 
@@ -325,10 +386,17 @@ RemoteDatabase::open_document(Xapian::docid did, bool /*lazy*/) const
     pack_uint_last(message, did);
     send_message(MSG_DOCUMENT, message);
 
+    return read_document(did);
+}
+
+Xapian::Document::Internal *
+RemoteDatabase::read_document(Xapian::docid did) const
+{
     string doc_data;
     get_message(doc_data, REPLY_DOCDATA);
 
     map<Xapian::valueno, string> values;
+    string message;
     while (get_message_or_done(message, REPLY_VALUE)) {
 	const char * p = message.data();
 	const char * p_end = p + message.size();
@@ -343,6 +411,62 @@ RemoteDatabase::open_document(Xapian::docid did, bool /*lazy*/) const
 			      std::move(values));
 }
 
+void
+RemoteDatabase::open_documents(const vector<Xapian::docid>& dids,
+			       const vector<Xapian::valueno>&,
+			       vector<Xapian::Document>& docs) const
+{
+    // The server always sends all the values, so we don't need to do
+    // anything special for the requested slots.
+    //
+    // We send a batch of requests before reading any of the replies so the
+    // batch only costs one round trip.  The batch size is limited so that
+    // our requests can't back up while the server is waiting for us to read
+    // its replies.
+    const size_t BATCH_SIZE = 64;
+    docs.reserve(docs.size() + dids.size());
+    for (size_t b = 0; b < dids.size(); b += BATCH_SIZE) {
+	size_t e = min(dids.size(), b + BATCH_SIZE);
+	for (size_t i = b; i != e; ++i) {
+	    Assert(dids[i]);
+	    string message;
+	    pack_uint_last(message, dids[i]);
+	    if (i == b) {
+		send_message(MSG_DOCUMENT, message);
+	    } else {
+		link.send_message(MSG_DOCUMENT, message,
+				  RealTime::end_time(timeout));
+	    }
+	}
+
+	size_t i = b;
+	try {
+	    while (i != e) {
+		pending_reply = true;
+		docs.emplace_back(read_document(dids[i]));
+		++i;
+	    }
+	} catch (const Xapian::NetworkError&) {
+	    throw;
+	} catch (...) {
+	    // Skip the rest of the replies to this batch so that the next
+	    // message doesn't get out of step.  If we've already read the
+	    // final reply for document i then we skip from the next one.
+	    if (!pending_reply) ++i;
+	    double end_time = RealTime::end_time(timeout);
+	    while (i != e) {
+		string dummy;
+		int reply_code = link.get_message(dummy, end_time);
+		if (reply_code < 0)
+		    throw_connection_closed_unexpectedly();
+		if (!is_intermediate_reply(reply_code)) ++i;
+	    }
+	    pending_reply = false;
+	    throw;
+	}
+    }
+}
+
 bool
 RemoteDatabase::update_stats(message_type msg_code, const string & body) const
 {
@@ -637,6 +761,8 @@ RemoteDatabase::get_message(string &result,
 void
 RemoteDatabase::send_message(message_type type, const string &message) const
 {
+    if (reconnect_needed) reconnect();
+
     double end_time = RealTime::end_time(timeout);
     while (pending_reply) {
 	string dummy;
@@ -729,7 +855,7 @@ RemoteDatabase::set_query(const Xapian::Query& query,
     send_message(MSG_QUERY, message);
 }
 
-void
+Xapian::doccount
 RemoteDatabase::accumulate_remote_stats(Xapian::Weight::Internal& total) const
 {
     string message;
@@ -738,6 +864,7 @@ RemoteDatabase::accumulate_remote_stats(Xapian::Weight::Internal& total) const
     Xapian::Weight::Internal remote_stats;
     unserialise_stats(p, p + message.size(), remote_stats);
     total += remote_stats;
+    return remote_stats.collection_size;
 }
 
 void
@@ -82,6 +82,13 @@ class RemoteDatabase : public Xapian::Database::Internal {
      */
     mutable bool pending_reply = false;
 
+    /** Do we need to open a new connection before sending a message?
+     *
+     *  Set by abandon_reply() after closing a connection which the server
+     *  might still send a reply on.
+     */
+    mutable bool reconnect_needed = false;
+
     /// The UUID of the remote database.
     mutable std::string uuid;
 
@@ -107,6 +114,12 @@ class RemoteDatabase : public Xapian::Database::Internal {
     bool update_stats(message_type msg_code = MSG_UPDATE,
 		      const std::string & body = std::string()) const;
 
+    /// Read the server's greeting and negotiate compression.
+    void handshake() const;
+
+    /// Replace a connection closed by abandon_reply().
+    void reconnect() const;
+
   protected:
     /** Constructor.  The constructor is protected so that raw instances
      *  can't be created - a derived class must be instantiated which
@@ -125,11 +138,35 @@ class RemoteDatabase : public Xapian::Database::Internal {
      *			operations will never timeout.
      *	@param writable	Is this a WritableDatabase?
      *	@param flags	Xapian::DB_RETRY_LOCK or 0.
+     *	@param reused	Has the connection been used before (and then
+     *			released by release_connection())?  The server only
+     *			sends its greeting on a new connection.
      */
     RemoteDatabase(std::pair<int, std::string> fd_and_context,
 		   double timeout_,
 		   bool writable,
-		   int flags);
+		   int flags,
+		   bool reused = false);
+
+    /** Give up ownership of the connection so it can be reused.
+     *
+     *  The connection is only returned if it's ready for a new message to
+     *  be sent, so it can be passed to the constructor of another
+     *  read-only RemoteDatabase object with @a reused set to true.
+     *
+     *  @return A std::pair containing the file descriptor for the connection
+     *		(or -1 if it can't be reused) and the context string.
+     */
+    std::pair<int, std::string> release_connection();
+
+    /** Open a new connection to the server.
+     *
+     *  Used to replace a connection which has been abandoned.
+     *
+     *  @return A std::pair containing the file descriptor for the connection
+     *		and a context string to return with any error messages.
+     */
+    virtual std::pair<int, std::string> open_connection() const = 0;
 
     /// Receive a message from the server.
     reply_type get_message(std::string& message,
@@ -149,6 +186,9 @@ class RemoteDatabase : public Xapian::Database::Internal {
     /// Send a message to the server.
     void send_message(message_type type, const std::string& data) const;
 
+    /// Read the replies to MSG_DOCUMENT for document @a did.
+    Xapian::Document::Internal* read_document(Xapian::docid did) const;
+
     /// Close the socket
     void do_close();
 
@@ -213,8 +253,24 @@ class RemoteDatabase : public Xapian::Database::Internal {
 	return link.get_read_fd();
     }
 
-    /// Accumulate stats from the remote server.
-    void accumulate_remote_stats(Xapian::Weight::Internal& total) const;
+    /** Stop waiting for the reply to the last message sent.
+     *
+     *  The server may still be working on the request, so the connection is
+     *  closed and a new one opened before the next message is sent.  This
+     *  means we never have to wait for a slow server to finish a request we
+     *  no longer want the answer to.
+     *
+     *  @return false (and does nothing) for a writable database, since that
+     *		would lose any uncommitted changes.
+     */
+    bool abandon_reply() const;
+
+    /** Accumulate stats from the remote server.
+     *
+     *  @return The number of documents in the remote database.
+     */
+    Xapian::doccount
+    accumulate_remote_stats(Xapian::Weight::Internal& total) const;
 
     /// Send the global stats to the remote server.
     void send_global_stats(Xapian::doccount first,
@@ -255,6 +311,10 @@ class RemoteDatabase : public Xapian::Database::Internal {
     /// Get a remote document.
     Xapian::Document::Internal * open_document(Xapian::docid did, bool lazy) const;
 
+    void open_documents(const std::vector<Xapian::docid>& dids,
+			const std::vector<Xapian::valueno>& slots,
+			std::vector<Xapian::Document>& docs) const;
+
     /// Get the document count.
     Xapian::doccount get_doccount() const;
 
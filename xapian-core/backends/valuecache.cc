@@ -0,0 +1,146 @@
+/** @file
+ * @brief In-memory cache of the values in a slot
+ */
+/* Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <config.h>
+
+#include "valuecache.h"
+
+#include "omassert.h"
+#include "str.h"
+
+#include "xapian/error.h"
+
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+
+using namespace std;
+
+ValueCache::ValueCache(ValueList* vl_, Xapian::rev revision_)
+    : revision(revision_)
+{
+    unique_ptr<ValueList> vl(vl_);
+    // Map each distinct value to a provisional ordinal in the order we first
+    // see them, then renumber once we know the sorted order.
+    unordered_map<string, uint32_t> ids;
+    vl->next();
+    if (vl->at_end()) return;
+    first_did = vl->get_docid();
+    do {
+	Xapian::docid did = vl->get_docid();
+	auto r = ids.emplace(vl->get_value(), uint32_t(ids.size() + 1));
+	if (rare(r.first->second == 0)) {
+	    // We've wrapped the ordinal.
+	    throw Xapian::DatabaseError("Too many distinct values to cache");
+	}
+	ordinals.resize(did - first_did);
+	ordinals.push_back(r.first->second);
+	vl->next();
+    } while (!vl->at_end());
+
+    // Sort the distinct values and renumber the ordinals to match.
+    vector<pair<const string*, uint32_t>> sorted;
+    sorted.reserve(ids.size());
+    for (auto&& item : ids) {
+	sorted.emplace_back(&item.first, item.second);
+    }
+    sort(sorted.begin(), sorted.end(),
+	 [](const pair<const string*, uint32_t>& a,
+	    const pair<const string*, uint32_t>& b) {
+	     return *a.first < *b.first;
+	 });
+    vector<uint32_t> renumber(sorted.size() + 1);
+    dictionary.reserve(sorted.size());
+    for (auto&& item : sorted) {
+	dictionary.push_back(*item.first);
+	renumber[item.second] = dictionary.size();
+    }
+    for (auto& ord : ordinals) {
+	ord = renumber[ord];
+    }
+}
+
+Xapian::docid
+CachedValueList::get_docid() const
+{
+    return current_did;
+}
+
+string
+CachedValueList::get_value() const
+{
+    Assert(cache->has_value(current_did));
+    return cache->get_value(current_did);
+}
+
+Xapian::valueno
+CachedValueList::get_valueno() const
+{
+    return slot;
+}
+
+bool
+CachedValueList::at_end() const
+{
+    return current_did > cache->get_last_docid();
+}
+
+void
+CachedValueList::next()
+{
+    Xapian::docid last = cache->get_last_docid();
+    if (current_did < cache->get_first_docid()) {
+	current_did = cache->get_first_docid();
+    } else {
+	++current_did;
+    }
+    while (current_did <= last && !cache->has_value(current_did)) {
+	++current_did;
+    }
+}
+
+void
+CachedValueList::skip_to(Xapian::docid did)
+{
+    if (did <= current_did) return;
+    current_did = did - 1;
+    next();
+}
+
+bool
+CachedValueList::check(Xapian::docid did)
+{
+    if (did <= current_did) {
+	return cache->has_value(current_did);
+    }
+    current_did = did;
+    return at_end() || cache->has_value(did);
+}
+
+string
+CachedValueList::get_description() const
+{
+    string desc = "CachedValueList(slot=";
+    desc += str(slot);
+    desc += ", docid=";
+    desc += str(current_did);
+    desc += ')';
+    return desc;
+}
@@ -0,0 +1,132 @@
+/** @file
+ * @brief In-memory cache of the values in a slot
+ */
+/* Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifndef XAPIAN_INCLUDED_VALUECACHE_H
+#define XAPIAN_INCLUDED_VALUECACHE_H
+
+#include "valuelist.h"
+
+#include "xapian/intrusive_ptr.h"
+#include "xapian/types.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/** The values in a slot of a database shard, held in memory.
+ *
+ *  The distinct values are stored once each in ascending order, and each
+ *  document with a value just stores the index of its value in a
+ *  docid-indexed array.
+ */
+class ValueCache : public Xapian::Internal::intrusive_base {
+    /// Don't allow assignment.
+    void operator=(const ValueCache &) = delete;
+
+    /// Don't allow copying.
+    ValueCache(const ValueCache &) = delete;
+
+    /// The revision of the shard which the values were read from.
+    Xapian::rev revision;
+
+    /// The first docid with a value (or 1 if there are none).
+    Xapian::docid first_did = 1;
+
+    /** One more than the index in @a dictionary of the value of each document
+     *  (or 0 if the document has no value in this slot).
+     *
+     *  Entry 0 is for first_did.
+     */
+    std::vector<uint32_t> ordinals;
+
+    /// The distinct values in ascending order.
+    std::vector<std::string> dictionary;
+
+  public:
+    /** Read the values in a slot into memory.
+     *
+     *  @param vl	 ValueList for the slot (which is deleted by this
+     *			 constructor).
+     *  @param revision_ The revision of the shard which @a vl is from.
+     */
+    ValueCache(ValueList* vl, Xapian::rev revision_);
+
+    /// The revision of the shard which the values were read from.
+    Xapian::rev get_revision() const { return revision; }
+
+    /// The first docid which might have a value.
+    Xapian::docid get_first_docid() const { return first_did; }
+
+    /// The last docid which might have a value.
+    Xapian::docid get_last_docid() const {
+	return first_did + ordinals.size() - 1;
+    }
+
+    /// Test if document @a did has a value in this slot.
+    bool has_value(Xapian::docid did) const {
+	return did >= first_did && did - first_did < ordinals.size() &&
+	       ordinals[did - first_did] != 0;
+    }
+
+    /// Return the value for document @a did, which must have one.
+    const std::string& get_value(Xapian::docid did) const {
+	return dictionary[ordinals[did - first_did] - 1];
+    }
+};
+
+/// A ValueList which reads values from a ValueCache.
+class CachedValueList : public ValueList {
+    /// Don't allow assignment.
+    void operator=(const CachedValueList &) = delete;
+
+    /// Don't allow copying.
+    CachedValueList(const CachedValueList &) = delete;
+
+    /// The cached values.
+    Xapian::Internal::intrusive_ptr<const ValueCache> cache;
+
+    /// The value slot we're iterating over.
+    Xapian::valueno slot;
+
+    /// The document id at the current position.
+    Xapian::docid current_did = 0;
+
+  public:
+    CachedValueList(const ValueCache* cache_, Xapian::valueno slot_)
+	: cache(cache_), slot(slot_) { }
+
+    Xapian::docid get_docid() const;
+
+    std::string get_value() const;
+
+    Xapian::valueno get_valueno() const;
+
+    bool at_end() const;
+
+    void next();
+
+    void skip_to(Xapian::docid);
+
+    bool check(Xapian::docid did);
+
+    std::string get_description() const;
+};
+
+#endif // XAPIAN_INCLUDED_VALUECACHE_H
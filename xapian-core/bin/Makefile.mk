@@ -89,6 +89,7 @@ bin_xapian_inspect_honey_SOURCES = bin/xapian-inspect-honey.cc\
 	backends/honey/honey_cursor.cc\
 	backends/honey/honey_freelist.cc\
 	backends/honey/honey_table.cc\
+	backends/honey/honey_termdict.cc\
 	backends/honey/honey_version.cc\
 	backends/uuids.cc\
 	common/compression_stream.cc\
@@ -40,6 +40,7 @@ using namespace std;
 #define OPT_HELP 1
 #define OPT_VERSION 2
 #define OPT_NO_RENUMBER 3
+#define OPT_TERM_DICTIONARY 4
 
 static void show_usage() {
     cout << "Usage: " PROG_NAME " [OPTIONS] SOURCE_DATABASE... DESTINATION_DATABASE\n\n"
@@ -62,6 +63,9 @@ static void show_usage() {
 "                     option is only supported when merging databases if they\n"
 "                     have disjoint ranges of used document ids\n"
 "  -s, --single-file  Produce a single file database\n"
+"      --term-dictionary\n"
+"                     Store a compact term dictionary to speed up term lookups\n"
+"                     and wildcard expansion (only supported for honey)\n"
 "  --help             display this help and exit\n"
 "  --version          output version information and exit\n";
 }
@@ -122,6 +126,7 @@ main(int argc, char **argv)
 	{"backend",	required_argument, 0, 'B'},
 	{"no-renumber", no_argument, 0, OPT_NO_RENUMBER},
 	{"single-file", no_argument, 0, 's'},
+	{"term-dictionary", no_argument, 0, OPT_TERM_DICTIONARY},
 	{"quiet",	no_argument, 0, 'q'},
 	{"help",	no_argument, 0, OPT_HELP},
 	{"version",	no_argument, 0, OPT_VERSION},
@@ -185,6 +190,9 @@ main(int argc, char **argv)
 	    case 's':
 		flags |= Xapian::DBCOMPACT_SINGLE_FILE;
 		break;
+	    case OPT_TERM_DICTIONARY:
+		flags |= Xapian::DBCOMPACT_TERM_DICTIONARY;
+		break;
 	    case 'q':
 		compactor.set_quiet(true);
 		break;
@@ -1,8 +1,10 @@
 noinst_HEADERS +=\
-	cluster/clusterinternal.h
+	cluster/clusterinternal.h\
+	cluster/sparsevector.h
 
 lib_src +=\
 	cluster/cluster.cc \
 	cluster/cosine_sim.cc \
 	cluster/kmeans.cc \
-	cluster/lcd_clusterer.cc
+	cluster/lcd_clusterer.cc \
+	cluster/sparsevector.cc
@@ -26,6 +26,7 @@
 #include "debuglog.h"
 
 #include <cmath>
+#include <utility>
 
 using namespace std;
 using namespace Xapian;
@@ -47,15 +48,15 @@ CosineDistance::similarity(const PointType& a, const PointType& b) const
     if (denom_a == 0 || denom_b == 0)
 	return 0.0;
 
-    for (TermIterator it = a.termlist_begin(); it != a.termlist_end(); ++it) {
-	const string& term = *it;
-	double a_weight = a.get_weight(term);
-	if (a_weight == 0)
-	    continue;
-	double b_weight = b.get_weight(term);
-	if (b_weight == 0)
-	    continue;
-	inner_product += a_weight * b_weight;
+    // Iterate over the smaller of the two maps, looking up each term in the
+    // larger one.
+    const auto* small = &a.weights;
+    const auto* large = &b.weights;
+    if (small->size() > large->size()) swap(small, large);
+    for (auto&& entry : *small) {
+	auto it = large->find(entry.first);
+	if (it != large->end())
+	    inner_product += entry.second * it->second;
     }
 
     return 1 - (inner_product / (sqrt(denom_a * denom_b)));
@@ -24,8 +24,10 @@
 #include "xapian/cluster.h"
 #include "xapian/error.h"
 
+#include "cluster/sparsevector.h"
 #include "debuglog.h"
 
+#include <algorithm>
 #include <limits>
 #include <vector>
 
@@ -95,49 +97,89 @@ KMeans::cluster(const MSet& mset)
     initialise_points(mset);
     ClusterSet cset;
     initialise_clusters(cset, size);
-    CosineDistance distance;
-    vector<Centroid> previous_centroids;
+    if (size == 0) return cset;
+
+    // Convert the points to sparse vectors of term ids once, and keep the
+    // centroids as dense vectors indexed by term id while iterating, so each
+    // distance calculation is a single pass over the point's terms.
+    TermIds ids;
+    vector<SparseVector> vectors;
+    vectors.reserve(size);
+    for (const Point& point : points)
+	vectors.emplace_back(point, ids);
+    unsigned num_terms = ids.size();
+
+    vector<vector<double>> centroids(k, vector<double>(num_terms));
+    vector<double> centroid_magnitudes(k);
+    for (unsigned int c = 0; c < k; ++c) {
+	unsigned int x = (c * size) / k;
+	vectors[x].add_to(centroids[c]);
+	centroid_magnitudes[c] = vectors[x].get_magnitude();
+    }
+
+    vector<unsigned> assignment(size);
+    vector<doccount> cluster_sizes(k);
+    vector<double> new_centroid(num_terms);
     for (unsigned int i = 0; i < max_iters; ++i) {
 	// Assign each point to the cluster corresponding to its
 	// closest cluster centroid
-	cset.clear_clusters();
+	fill(cluster_sizes.begin(), cluster_sizes.end(), 0);
 	for (unsigned int j = 0; j < size; ++j) {
+	    const SparseVector& vec = vectors[j];
 	    double closest_cluster_distance = numeric_limits<double>::max();
 	    unsigned int closest_cluster = 0;
 	    for (unsigned int c = 0; c < k; ++c) {
-		const Centroid& centroid = cset[c].get_centroid();
-		double dist = distance.similarity(points[j], centroid);
+		double dist = cosine_distance(vec.dot(centroids[c]),
+					      vec.get_magnitude(),
+					      centroid_magnitudes[c]);
 		if (closest_cluster_distance > dist) {
 		    closest_cluster_distance = dist;
 		    closest_cluster = c;
 		}
 	    }
-	    cset.add_to_cluster(points[j], closest_cluster);
+	    assignment[j] = closest_cluster;
+	    ++cluster_sizes[closest_cluster];
 	}
 
-	// Remember the previous centroids
-	previous_centroids.clear();
-	for (unsigned int j = 0; j < k; ++j)
-	    previous_centroids.push_back(cset[j].get_centroid());
-
-	// Recalculate the centroids for current iteration
-	cset.recalculate_centroids();
-
-	// Check whether centroids have converged
+	// Recalculate the centroids for current iteration, and check whether
+	// they have converged.
 	bool has_converged = true;
-	for (unsigned int j = 0; j < k; ++j) {
-	    const Centroid& centroid = cset[j].get_centroid();
-	    double dist = distance.similarity(previous_centroids[j], centroid);
+	for (unsigned int c = 0; c < k; ++c) {
+	    fill(new_centroid.begin(), new_centroid.end(), 0.0);
+	    for (unsigned int j = 0; j < size; ++j) {
+		if (assignment[j] == c)
+		    vectors[j].add_to(new_centroid);
+	    }
+	    double magnitude = 0.0;
+	    double inner_product = 0.0;
+	    const vector<double>& old_centroid = centroids[c];
+	    double cluster_size = cluster_sizes[c];
+	    for (unsigned t = 0; t != num_terms; ++t) {
+		double wt = new_centroid[t];
+		if (wt == 0.0) continue;
+		wt /= cluster_size;
+		new_centroid[t] = wt;
+		magnitude += wt * wt;
+		inner_product += wt * old_centroid[t];
+	    }
 	    // If distance between any two centroids has changed by
 	    // more than the threshold, then KMeans hasn't converged
-	    if (dist > CONVERGENCE_THRESHOLD) {
+	    double dist = cosine_distance(inner_product,
+					  centroid_magnitudes[c], magnitude);
+	    if (dist > CONVERGENCE_THRESHOLD)
 		has_converged = false;
-		break;
-	    }
+	    swap(centroids[c], new_centroid);
+	    centroid_magnitudes[c] = magnitude;
 	}
 	// If converged, then break from the loop
 	if (has_converged)
 	    break;
     }
+
+    // Build the ClusterSet from the final assignment.
+    cset.clear_clusters();
+    for (unsigned int j = 0; j < size; ++j)
+	cset.add_to_cluster(points[j], assignment[j]);
+    cset.recalculate_centroids();
     return cset;
 }
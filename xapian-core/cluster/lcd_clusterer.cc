@@ -25,6 +25,7 @@
 #include "xapian/cluster.h"
 #include "xapian/error.h"
 
+#include "cluster/sparsevector.h"
 #include "debuglog.h"
 #include "omassert.h"
 
@@ -36,7 +37,21 @@
 using namespace Xapian;
 using namespace std;
 
-typedef multimap<double, Point, std::greater<double>> PSet;
+namespace {
+
+/// A Point along with its sparse vector form for fast distance calculation.
+struct LCDPoint {
+    Point point;
+
+    SparseVector vec;
+
+    LCDPoint(const Point& point_, TermIds& ids)
+	: point(point_), vec(point, ids) { }
+};
+
+}
+
+typedef multimap<double, LCDPoint, std::greater<double>> PSet;
 
 struct dcompare {
     bool operator()(const pair<PSet::iterator, double>& a,
@@ -75,15 +90,14 @@ LCDClusterer::cluster(const MSet& mset)
 
     // Initialise points
     TermListGroup tlg(mset);
+    TermIds ids;
     for (MSetIterator it = mset.begin(); it != mset.end(); ++it)
-	points.emplace(it.get_weight(), Point(tlg, it.get_document()));
+	points.emplace(it.get_weight(),
+		       LCDPoint(Point(tlg, it.get_document()), ids));
 
     // Container for holding the clusters
     ClusterSet cset;
 
-    // Instantiate this for computing distance between points
-    CosineDistance distance;
-
     // First cluster center
     PSet::iterator cluster_center = points.begin();
 
@@ -115,8 +129,11 @@ LCDClusterer::cluster(const MSet& mset)
 	    if (it == cluster_center)
 		continue;
 
-	    double dist = distance.similarity(cluster_center->second,
-					      it->second);
+	    // Equivalent to CosineDistance::similarity().
+	    const SparseVector& a = cluster_center->second.vec;
+	    const SparseVector& b = it->second.vec;
+	    double dist = cosine_distance(a.dot(b),
+					  a.get_magnitude(), b.get_magnitude());
 	    dist_vector.push_back(make_pair(it, dist));
 	}
 
@@ -127,13 +144,13 @@ LCDClusterer::cluster(const MSet& mset)
 	for (unsigned int i = 0; i < num_points - 1; ++i) {
 	    auto piterator = dist_vector[i].first;
 	    // Add to cluster
-	    new_cluster.add_point(piterator->second);
+	    new_cluster.add_point(piterator->second.point);
 	    // Remove from 'points'
 	    points.erase(piterator);
 	}
 
 	// Add cluster_center to current cluster
-	new_cluster.add_point(cluster_center->second);
+	new_cluster.add_point(cluster_center->second.point);
 
 	// Add cluster to cset
 	cset.add_cluster(new_cluster);
@@ -0,0 +1,61 @@
+/** @file
+ *  @brief Sparse vector representation of points for clustering
+ */
+/* Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+
+#include <config.h>
+
+#include "cluster/sparsevector.h"
+
+#include <algorithm>
+
+using namespace std;
+
+SparseVector::SparseVector(const Xapian::PointType& point, TermIds& ids)
+    : magnitude(point.get_magnitude())
+{
+    entries.reserve(point.termlist_size());
+    for (Xapian::TermIterator it = point.termlist_begin();
+	 it != point.termlist_end();
+	 ++it) {
+	const string& term = *it;
+	entries.emplace_back(ids.get(term), point.get_weight(term));
+    }
+    sort(entries.begin(), entries.end());
+}
+
+double
+SparseVector::dot(const SparseVector& o) const
+{
+    double result = 0.0;
+    auto a = entries.begin(), a_end = entries.end();
+    auto b = o.entries.begin(), b_end = o.entries.end();
+    while (a != a_end && b != b_end) {
+	if (a->first < b->first) {
+	    ++a;
+	} else if (b->first < a->first) {
+	    ++b;
+	} else {
+	    result += a->second * b->second;
+	    ++a;
+	    ++b;
+	}
+    }
+    return result;
+}
@@ -0,0 +1,97 @@
+/** @file
+ *  @brief Sparse vector representation of points for clustering
+ */
+/* Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+
+#ifndef XAPIAN_INCLUDED_SPARSEVECTOR_H
+#define XAPIAN_INCLUDED_SPARSEVECTOR_H
+
+#include "xapian/cluster.h"
+
+#include <cmath>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/** Assigns consecutive integer ids to terms.
+ *
+ *  Clustering compares the same points many times, so it's much cheaper to
+ *  map each term to an integer once than to look up term strings for every
+ *  comparison.
+ */
+class TermIds {
+    std::unordered_map<std::string, unsigned> ids;
+
+  public:
+    /// Return the id for @a term, assigning a new one if necessary.
+    unsigned get(const std::string& term) {
+	return ids.emplace(term, unsigned(ids.size())).first->second;
+    }
+
+    /// Return the number of ids assigned.
+    unsigned size() const { return unsigned(ids.size()); }
+};
+
+/** A PointType as a list of (term id, weight) pairs sorted by term id.
+ *
+ *  The entries are sorted so that the inner product of two SparseVectors
+ *  can be calculated by merging them.
+ */
+class SparseVector {
+    std::vector<std::pair<unsigned, double>> entries;
+
+    /// Squared magnitude, as for PointType.
+    double magnitude;
+
+  public:
+    SparseVector(const Xapian::PointType& point, TermIds& ids);
+
+    double get_magnitude() const { return magnitude; }
+
+    /// Inner product with another SparseVector.
+    double dot(const SparseVector& o) const;
+
+    /// Inner product with a dense vector indexed by term id.
+    double dot(const std::vector<double>& dense) const {
+	double result = 0.0;
+	for (auto&& entry : entries) result += entry.second * dense[entry.first];
+	return result;
+    }
+
+    /// Add this vector to a dense vector indexed by term id.
+    void add_to(std::vector<double>& dense) const {
+	for (auto&& entry : entries) dense[entry.first] += entry.second;
+    }
+};
+
+/** Calculate cosine distance from the inner product and squared magnitudes.
+ *
+ *  This gives the same result as CosineDistance::similarity(), including
+ *  returning 0 if either magnitude is 0.
+ */
+inline double
+cosine_distance(double inner_product, double magnitude_a, double magnitude_b)
+{
+    if (magnitude_a == 0 || magnitude_b == 0)
+	return 0.0;
+    return 1 - (inner_product / std::sqrt(magnitude_a * magnitude_b));
+}
+
+#endif // XAPIAN_INCLUDED_SPARSEVECTOR_H
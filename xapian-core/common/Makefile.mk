@@ -43,6 +43,7 @@ noinst_HEADERS +=\
 	common/serialise-double.h\
 	common/setenv.h\
 	common/socket_utils.h\
+	common/stopwordpair.h\
 	common/str.h\
 	common/stringutils.h\
 	common/wordaccess.h
@@ -76,6 +77,11 @@ else
 if BUILD_BACKEND_HONEY
 lib_src +=\
 	common/compression_stream.cc
+else
+if BUILD_BACKEND_REMOTE
+lib_src +=\
+	common/compression_stream.cc
+endif
 endif
 endif
 
@@ -83,7 +83,8 @@ CompressionStream::compress(const char* buf, size_t* p_size) {
 }
 
 bool
-CompressionStream::decompress_chunk(const char* p, int len, string& buf)
+CompressionStream::decompress_chunk(const char* p, int len, string& buf,
+				    size_t max_size)
 {
     Bytef blk[8192];
 
@@ -107,6 +108,9 @@ CompressionStream::decompress_chunk(const char* p, int len, string& buf)
 
 	buf.append(reinterpret_cast<const char*>(blk),
 		   inflate_zstream->next_out - blk);
+	if (rare(buf.size() > max_size)) {
+	    throw Xapian::DatabaseError("Decompressed data too large");
+	}
 	if (err == Z_STREAM_END) return true;
 	if (inflate_zstream->avail_in == 0) return false;
     }
@@ -128,7 +132,7 @@ CompressionStream::lazy_alloc_deflate_zstream() {
 
     // -15 means raw deflate with 32K LZ77 window (largest)
     // memLevel 9 is the highest (8 is default)
-    int err = deflateInit2(deflate_zstream, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+    int err = deflateInit2(deflate_zstream, compress_level, Z_DEFLATED,
 			   -15, 9, compress_strategy);
     if (rare(err != Z_OK)) {
 	if (err == Z_MEM_ERROR) {
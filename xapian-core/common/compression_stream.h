@@ -29,6 +29,8 @@
 class CompressionStream {
     int compress_strategy;
 
+    int compress_level;
+
     size_t out_len = 0;
 
     char* out = nullptr;
@@ -50,9 +52,13 @@ class CompressionStream {
      *
      *  @param compress_strategy_	Z_DEFAULT_STRATEGY,
      *					Z_FILTERED, Z_HUFFMAN_ONLY, or Z_RLE.
+     *  @param compress_level_	Z_DEFAULT_COMPRESSION, or 0 (none) to 9
+     *					(slowest but smallest output).
      */
-    explicit CompressionStream(int compress_strategy_ = Z_DEFAULT_STRATEGY)
-	: compress_strategy(compress_strategy_)
+    explicit CompressionStream(int compress_strategy_ = Z_DEFAULT_STRATEGY,
+			       int compress_level_ = Z_DEFAULT_COMPRESSION)
+	: compress_strategy(compress_strategy_),
+	  compress_level(compress_level_)
     { }
 
     ~CompressionStream();
@@ -61,8 +67,15 @@ class CompressionStream {
 
     void decompress_start() { lazy_alloc_inflate_zstream(); }
 
-    /** Returns true if this was the final chunk. */
-    bool decompress_chunk(const char* p, int len, std::string& buf);
+    /** Decompress a chunk of data, appending it to @a buf.
+     *
+     *  @param max_size	Throw DatabaseError if @a buf grows larger than
+     *			this (default: no limit).
+     *
+     *  Returns true if this was the final chunk.
+     */
+    bool decompress_chunk(const char* p, int len, std::string& buf,
+			  size_t max_size = std::string::npos);
 };
 
 #endif // XAPIAN_INCLUDED_COMPRESSION_STREAM_H
@@ -85,6 +85,20 @@ inline bool io_sync(int fd)
 #endif
 }
 
+/** Start writing data previously written to file descriptor fd to disk.
+ *
+ *  This doesn't wait for the writes to complete - call io_sync() for that.
+ *  Where this isn't supported it does nothing.
+ */
+inline void io_start_sync(int fd)
+{
+#ifdef HAVE_SYNC_FILE_RANGE
+    (void)sync_file_range(fd, 0, 0, SYNC_FILE_RANGE_WRITE);
+#else
+    (void)fd;
+#endif
+}
+
 inline bool io_full_sync(int fd)
 {
 #ifdef F_FULLFSYNC
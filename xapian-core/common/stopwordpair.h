@@ -0,0 +1,73 @@
+/** @file
+ * @brief Build terms for pairs of adjacent words involving a stopword
+ */
+/* Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifndef XAPIAN_INCLUDED_STOPWORDPAIR_H
+#define XAPIAN_INCLUDED_STOPWORDPAIR_H
+
+#include <string>
+
+/** Longest pair term we generate.
+ *
+ *  This is the longest term glass can store, and pairs which would be longer
+ *  are just not indexed (or looked for).
+ */
+#define MAX_STOPWORD_PAIR_TERM_LENGTH 245
+
+/** Build the term for a pair of adjacent positional terms.
+ *
+ *  Used by TermGenerator::FLAG_STOPWORD_PAIRS to index such pairs and by
+ *  QueryParser::FLAG_STOPWORD_PAIRS to look for them, so both must agree on
+ *  the format.
+ *
+ *  The term starts with a control character so it can't clash with normal
+ *  terms, or be matched by wildcards or prefix searches on them.
+ *
+ *  @param first	The positional term for the first word.
+ *  @param second	The positional term for the second word.
+ *
+ *  @return The pair term, or an empty string if it would be too long.
+ */
+inline std::string
+make_stopword_pair_term(const std::string& first, const std::string& second)
+{
+    std::string pair;
+    size_t len = first.size() + second.size() + 2;
+    if (len > MAX_STOPWORD_PAIR_TERM_LENGTH) return pair;
+    pair.reserve(len);
+    pair += '\x01';
+    pair += first;
+    pair += '\0';
+    pair += second;
+    return pair;
+}
+
+/** Is @a term a pair term built by make_stopword_pair_term()?
+ *
+ *  Terms starting with '\x01' are reserved for pair terms (as documented for
+ *  TermGenerator::FLAG_STOPWORD_PAIRS), so query expansion uses this to skip
+ *  them without needing to know if the database was indexed with the flag.
+ */
+inline bool
+is_stopword_pair_term(const std::string& term)
+{
+    return !term.empty() && term[0] == '\x01';
+}
+
+#endif // XAPIAN_INCLUDED_STOPWORDPAIR_H
@@ -24,6 +24,7 @@
 #include "xapian/diversify.h"
 #include "xapian/error.h"
 
+#include "cluster/sparsevector.h"
 #include "debuglog.h"
 #include "diversify/diversifyinternal.h"
 
@@ -78,82 +79,86 @@ Diversify::get_dmset(const MSet& mset)
 void
 Diversify::Internal::initialise_points(const MSet& source)
 {
-    unsigned int count = 0;
+    points.clear();
+    scores.clear();
+    docid_index.clear();
+    main_dmset.clear();
+    points.reserve(source.size());
+    scores.reserve(source.size());
     TermListGroup tlg(source);
     for (MSetIterator it = source.begin(); it != source.end(); ++it) {
-	points.emplace(*it, Xapian::Point(tlg, it.get_document()));
-	scores[*it] = it.get_weight();
+	unsigned index = unsigned(points.size());
+	points.emplace_back(tlg, it.get_document());
+	scores.push_back(it.get_weight());
+	docid_index.emplace(*it, index);
 	// Initial top-k diversified documents
-	if (count < k) {
-	    main_dmset.push_back(*it);
-	    ++count;
-	}
+	if (index < k)
+	    main_dmset.push_back(index);
     }
 }
 
-pair<Xapian::docid, unsigned int>
-Diversify::Internal::get_key(Xapian::docid doc_id, unsigned int centroid_id)
-{
-    return make_pair(doc_id, centroid_id);
-}
-
 void
 Diversify::Internal::compute_similarities(const Xapian::ClusterSet& cset)
 {
-    Xapian::CosineDistance d;
-    for (auto p : points) {
-	Xapian::docid point_id = p.first;
-	Xapian::Point point = p.second;
-	for (unsigned int c = 0; c < cset.size(); ++c) {
-	    double dist = d.similarity(point, cset[c].get_centroid());
-	    auto key = get_key(point_id, c);
-	    pairwise_sim[key] = dist;
+    // Equivalent to CosineDistance::similarity(), but converting each point
+    // and centroid to a sparse vector only once.
+    num_clusters = cset.size();
+    TermIds ids;
+    vector<SparseVector> centroids;
+    centroids.reserve(num_clusters);
+    for (unsigned int c = 0; c < num_clusters; ++c)
+	centroids.emplace_back(cset[c].get_centroid(), ids);
+
+    centroid_sim.resize(points.size() * num_clusters);
+    auto sim = centroid_sim.begin();
+    for (const Xapian::Point& point : points) {
+	SparseVector vec(point, ids);
+	for (const SparseVector& centroid : centroids) {
+	    *sim++ = cosine_distance(vec.dot(centroid),
+				     vec.get_magnitude(),
+				     centroid.get_magnitude());
 	}
     }
 }
 
-vector<Xapian::docid>
-Diversify::Internal::compute_diff_dmset(const vector<Xapian::docid>& dmset)
+double
+Diversify::Internal::evaluate_dmset(const vector<unsigned>& dmset) const
 {
-    vector<Xapian::docid> diff_dmset;
-    for (auto point : points) {
-	Xapian::docid point_id = point.first;
-	bool found_point = false;
-	for (auto doc_id : dmset) {
-	    if (point_id == doc_id) {
-		found_point = true;
-		break;
-	    }
-	}
+    double score_1 = 0, score_2 = 0;
+
+    for (auto index : dmset)
+	score_1 += scores[index];
 
-	if (!found_point) {
-	    diff_dmset.push_back(point_id);
+    for (unsigned int c = 0; c < num_clusters; ++c) {
+	double min_dist = numeric_limits<double>::max();
+	for (unsigned int pos = 0; pos < dmset.size(); ++pos) {
+	    double sim = get_similarity(dmset[pos], c);
+	    double weight = pos_weights[pos] * (1 - sim);
+	    min_dist = min(min_dist, weight);
 	}
+	score_2 += min_dist;
     }
 
-    return diff_dmset;
+    return -lambda * score_1 + (1 - lambda) * score_2;
 }
 
 double
-Diversify::Internal::evaluate_dmset(const vector<Xapian::docid>& dmset,
-				    const Xapian::ClusterSet& cset)
+Diversify::Internal::evaluate_replacement(const vector<unsigned>& dmset,
+					  unsigned pos,
+					  unsigned candidate,
+					  const vector<double>& other_min) const
 {
     double score_1 = 0, score_2 = 0;
 
-    for (auto doc_id : dmset)
-	score_1 += scores[doc_id];
+    // Sum in the same order as evaluate_dmset() so the result is identical.
+    for (unsigned int p = 0; p < dmset.size(); ++p)
+	score_1 += scores[p == pos ? candidate : dmset[p]];
 
-    for (unsigned int c = 0; c < cset.size(); ++c) {
-	double min_dist = numeric_limits<double>::max();
-	unsigned int pos = 1;
-	for (auto doc_id : dmset) {
-	    auto key = get_key(doc_id, c);
-	    double sim = pairwise_sim[key];
-	    double weight = 2 * b * sigma_sqr / log(1 + pos) * (1 - sim);
-	    min_dist = min(min_dist, weight);
-	    ++pos;
-	}
-	score_2 += min_dist;
+    double pos_weight = pos_weights[pos];
+    const double* sim = &centroid_sim[candidate * num_clusters];
+    for (unsigned int c = 0; c < num_clusters; ++c) {
+	double weight = pos_weight * (1 - sim[c]);
+	score_2 += min(other_min[c], weight);
     }
 
     return -lambda * score_1 + (1 - lambda) * score_2;
@@ -181,27 +186,48 @@ Diversify::Internal::get_dmset(const MSet& mset)
     Xapian::ClusterSet cset = lc.cluster(mset);
     compute_similarities(cset);
 
+    pos_weights.clear();
+    for (unsigned int pos = 1; pos <= main_dmset.size(); ++pos)
+	pos_weights.push_back(2 * b * sigma_sqr / log(1 + pos));
+
     // topC contains union of top-r relevant documents of each cluster
-    vector<Xapian::docid> topc;
+    vector<unsigned> topc;
 
     // Build topC
     for (unsigned int c = 0; c < cset.size(); ++c) {
 	auto documents = cset[c].get_documents();
 	for (unsigned int d = 0; d < r && d < documents.size(); ++d) {
-	    auto doc_id = documents[d].get_docid();
-	    topc.push_back(doc_id);
+	    auto i = docid_index.find(documents[d].get_docid());
+	    if (i != docid_index.end())
+		topc.push_back(i->second);
 	}
     }
 
-    vector<Xapian::docid> curr_dmset = main_dmset;
+    vector<unsigned> curr_dmset = main_dmset;
+    vector<double> other_min(num_clusters);
 
+    // Local search: repeatedly try replacing each document in the current
+    // diversified set with each document in topC, keeping the best
+    // improvement for each position.
     while (true) {
 	bool found_better_dmset = false;
 	for (unsigned int i = 0; i < main_dmset.size(); ++i) {
 	    auto curr_doc = main_dmset[i];
-	    double best_score = evaluate_dmset(curr_dmset, cset);
+	    double best_score = evaluate_dmset(curr_dmset);
 	    bool found_better_doc = false;
 
+	    // The contribution of the other positions to each cluster's
+	    // minimum doesn't depend on which candidate we try at position i.
+	    for (unsigned int c = 0; c < num_clusters; ++c) {
+		double min_dist = numeric_limits<double>::max();
+		for (unsigned int pos = 0; pos < curr_dmset.size(); ++pos) {
+		    if (pos == i) continue;
+		    double sim = get_similarity(curr_dmset[pos], c);
+		    min_dist = min(min_dist, pos_weights[pos] * (1 - sim));
+		}
+		other_min[c] = min_dist;
+	    }
+
 	    for (unsigned int j = 0; j < topc.size(); ++j) {
 		// Continue if candidate document from topC already
 		// exists in curr_dmset
@@ -211,17 +237,14 @@ Diversify::Internal::get_dmset(const MSet& mset)
 		    continue;
 		}
 
-		auto temp_doc = curr_dmset[i];
-		curr_dmset[i] = topc[j];
-		double score = evaluate_dmset(curr_dmset, cset);
+		double score = evaluate_replacement(curr_dmset, i, topc[j],
+						    other_min);
 
 		if (score < best_score) {
-		    curr_doc = curr_dmset[i];
+		    curr_doc = topc[j];
 		    best_score = score;
 		    found_better_doc = true;
 		}
-
-		curr_dmset[i] = temp_doc;
 	    }
 	    if (found_better_doc) {
 		curr_dmset[i] = curr_doc;
@@ -237,14 +260,18 @@ Diversify::Internal::get_dmset(const MSet& mset)
 	main_dmset = curr_dmset;
     }
 
-    // Merge main_dmset and diff_dmset into final dmset
+    // Merge main_dmset and the remaining documents into final dmset
     DocumentSet dmset;
-    for (auto doc_id : main_dmset)
-	dmset.add_document(points.at(doc_id).get_document());
+    vector<bool> in_dmset(points.size());
+    for (auto index : main_dmset) {
+	dmset.add_document(points[index].get_document());
+	in_dmset[index] = true;
+    }
 
-    vector<Xapian::docid> diff_dmset = compute_diff_dmset(main_dmset);
-    for (auto doc_id : diff_dmset)
-	dmset.add_document(points.at(doc_id).get_document());
+    for (unsigned index = 0; index < points.size(); ++index) {
+	if (!in_dmset[index])
+	    dmset.add_document(points[index].get_document());
+    }
 
     return dmset;
 }
@@ -24,10 +24,13 @@
 
 #include <xapian/intrusive_ptr.h>
 
-#include <map>
+#include <unordered_map>
 #include <vector>
 
 /** Internal class for Diversify
+ *
+ *  Documents are referred to by their index in the MSet being diversified,
+ *  so that per-document data can be held in contiguous arrays.
  */
 class Xapian::Diversify::Internal : public Xapian::Internal::intrusive_base {
     /// Copies are not allowed
@@ -46,16 +49,32 @@ class Xapian::Diversify::Internal : public Xapian::Internal::intrusive_base {
     double lambda, b, sigma_sqr;
 
     /// Store each document from given mset as a point
-    std::unordered_map<Xapian::docid, Xapian::Point> points;
+    std::vector<Xapian::Point> points;
 
     /// Store the relevance score of each document
-    std::unordered_map<Xapian::docid, double> scores;
+    std::vector<double> scores;
 
-    /// Store pairwise cosine similarities of documents of given mset
-    std::map<std::pair<Xapian::docid, Xapian::docid>, double> pairwise_sim;
+    /// Map from docid to index in the MSet
+    std::unordered_map<Xapian::docid, unsigned> docid_index;
 
-    /// Store docids of top k diversified documents
-    std::vector<Xapian::docid> main_dmset;
+    /// Number of clusters
+    unsigned num_clusters = 0;
+
+    /** Cosine distances between each document and each cluster centroid
+     *
+     *  The distances for the document at index i are at
+     *  [i * num_clusters, (i + 1) * num_clusters).
+     */
+    std::vector<double> centroid_sim;
+
+    /** Weight for each position in the diversified document set
+     *
+     *  Entry i is 2 * b * sigma_sqr / log(1 + i + 1).
+     */
+    std::vector<double> pos_weights;
+
+    /// Store indices of top k diversified documents
+    std::vector<unsigned> main_dmset;
 
   public:
     /// Constructor for initialising diversification parameters
@@ -68,54 +87,61 @@ class Xapian::Diversify::Internal : public Xapian::Internal::intrusive_base {
 
     /** Initialise diversified document set
      *
-     *  Convert top-k documents of mset into vector of Points, which
-     *  represents the initial diversified document set.
+     *  Convert documents of mset into Points, and use the top-k as the
+     *  initial diversified document set.
      *
      *  @param source	MSet object containing the documents of which
      *			top-k are to be diversified
      */
     void initialise_points(const Xapian::MSet& source);
 
-    /** Return a key for a pair of documents
+    /** Compute document to centroid similarities
      *
-     *  Returns a key as a pair of given documents ids
-     *
-     *  @param doc_id	Document id of the document
-     *  @param centroid_idx	Index of cluster to which the given centroid
-     *  			belongs to in the cluster set
-     */
-    std::pair<Xapian::docid, unsigned int>
-    get_key(Xapian::docid doc_id, unsigned int centroid_idx);
-
-    /** Compute pairwise similarities
-     *
-     *  Used for pre-computing pairwise cosine similarities of documents
-     *  of given mset, which is used to speed up evaluate_dmset
+     *  Used for pre-computing cosine similarities between the documents
+     *  of given mset and the cluster centroids, which is used to speed up
+     *  evaluate_dmset
      *
      *  @param cset	Cluster of given relevant documents
      */
     void compute_similarities(const Xapian::ClusterSet& cset);
 
-    /** Return difference of 'points' and current dmset
-     *
-     *  Return the difference of 'points' and the current diversified
-     *  document match set
+    /** Return the similarity between a document and a cluster centroid
      *
-     *  @param dmset	Document set representing a diversified document set
+     *  @param index	Index of the document in the MSet
+     *  @param c	Index of the cluster
      */
-    std::vector<Xapian::docid>
-    compute_diff_dmset(const std::vector<Xapian::docid>& dmset);
+    double get_similarity(unsigned index, unsigned c) const {
+	return centroid_sim[index * num_clusters + c];
+    }
 
     /** Evaluate a diversified mset
      *
      *  Evaluate a diversified mset using MPT algorithm
      *
-     *  @param dmset	Set of points representing candidate diversifed
-     *			set of documents
-     *  @param cset	Set of clusters of given mset
+     *  @param dmset	Indices of documents representing candidate
+     *			diversified set of documents
+     */
+    double evaluate_dmset(const std::vector<unsigned>& dmset) const;
+
+    /** Evaluate a diversified mset with one document replaced
+     *
+     *  Gives the same result as calling evaluate_dmset() on @a dmset with
+     *  the entry at @a pos replaced by @a candidate, but in
+     *  O(dmset.size() + num_clusters) time rather than
+     *  O(dmset.size() * num_clusters).  The relevance scores are still
+     *  summed over @a dmset so the result is bit-for-bit the same.
+     *
+     *  @param dmset	Indices of documents representing the current
+     *			diversified set of documents
+     *  @param pos	Position in @a dmset to replace
+     *  @param candidate	Index of the replacement document
+     *  @param other_min	For each cluster, the minimum weighted distance
+     *			over the positions in @a dmset other than @a pos
      */
-    double evaluate_dmset(const std::vector<Xapian::docid>& dmset,
-			  const Xapian::ClusterSet& cset);
+    double evaluate_replacement(const std::vector<unsigned>& dmset,
+				unsigned pos,
+				unsigned candidate,
+				const std::vector<double>& other_min) const;
 
     /// Return diversified document set from given mset
     Xapian::DocumentSet get_dmset(const MSet& mset);
@@ -22,6 +22,7 @@
 #include <config.h>
 
 #include "expandweight.h"
+#include <algorithm>
 #include <cmath>
 
 using namespace std;
@@ -30,10 +31,8 @@ namespace Xapian {
 namespace Internal {
 
 double
-Bo1EWeight::get_weight() const
+Bo1EWeight::calc_weight(double F) const
 {
-    double F = get_collection_freq();
-
     double N = get_dbsize();
 
     double mean = F / N;
@@ -42,5 +41,28 @@ Bo1EWeight::get_weight() const
     return wt;
 }
 
+double
+Bo1EWeight::get_weight() const
+{
+    return calc_weight(get_collection_freq());
+}
+
+double
+Bo1EWeight::get_maxweight() const
+{
+    // The collection frequency is at least the sum of the wdf in the rset
+    // and at most the total length of the collection.  Over that range the
+    // weight decreases until the mean reaches rcollection_freq and increases
+    // after it, so the larger of the weights at the two ends is an upper
+    // bound, and we don't need to look up the collection frequency to get
+    // it.
+    if (stats.rwdf_sum == 0) {
+	// The collection frequency could be 0, which gives an infinite weight.
+	return HUGE_VAL;
+    }
+    return max(calc_weight(double(stats.rwdf_sum)),
+	       calc_weight(double(get_collection_len())));
+}
+
 }
 }
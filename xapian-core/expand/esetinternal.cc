@@ -33,6 +33,7 @@
 #include "heap.h"
 #include "omassert.h"
 #include "ortermlist.h"
+#include "stopwordpair.h"
 #include "str.h"
 #include "api/termlist.h"
 #include "termlistmerger.h"
@@ -118,19 +119,32 @@ ESet::Internal::expand(Xapian::termcount max_esize,
 
 	string term = tree->get_termname();
 
+	// Skip the pair terms TermGenerator::FLAG_STOPWORD_PAIRS adds - they
+	// only exist to speed up phrase searches.
+	if (is_stopword_pair_term(term)) continue;
+
 	// If there's an ExpandDecider, see if it accepts the term.
 	if (edecider && !(*edecider)(term)) continue;
 
 	++ebound;
 
 	/* Set up the ExpandWeight by clearing the existing statistics and
-	   collecting statistics for the new term. */
-	eweight.collect_stats(tree.get(), term);
-
-	double wt = eweight.get_weight();
+	   collecting statistics for the new term from the relevant documents.
+	   */
+	eweight.accumulate_stats(tree.get());
 
 	// If the weights are equal, we prefer the lexically smaller term and
 	// since we process terms in ascending order we use "<=" not "<" here.
+	//
+	// Most candidate terms don't make it into the ESet, so check an upper
+	// bound first, which avoids looking up statistics for the term in the
+	// database if it can't beat the current threshold.
+	if (eweight.get_maxweight() <= min_wt) continue;
+
+	eweight.complete_stats(term);
+
+	double wt = eweight.get_weight();
+
 	if (wt <= min_wt) continue;
 
 	if (items.size() < max_esize) {
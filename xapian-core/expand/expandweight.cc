@@ -28,21 +28,31 @@
 #include "omassert.h"
 #include "api/termlist.h"
 
+#include <cmath>
+
 using namespace std;
 
 namespace Xapian {
 namespace Internal {
 
 void
-ExpandWeight::collect_stats(TermList * merger, const std::string & term)
+ExpandWeight::accumulate_stats(TermList * merger)
 {
-    LOGCALL_VOID(API, "ExpandWeight::collect_stats", merger | term);
+    LOGCALL_VOID(API, "ExpandWeight::accumulate_stats", merger);
 
     stats.clear_stats();
 
     merger->accumulate_stats(stats);
+}
 
-    collection_freq = db.get_collection_freq(term);
+void
+ExpandWeight::complete_stats(const std::string & term)
+{
+    LOGCALL_VOID(API, "ExpandWeight::complete_stats", term);
+
+    if (want_collection_freq) {
+	collection_freq = db.get_collection_freq(term);
+    }
 
     LOGVALUE(EXPAND, rsize);
     LOGVALUE(EXPAND, stats.rtermfreq);
@@ -91,5 +101,11 @@ ExpandWeight::collect_stats(TermList * merger, const std::string & term)
     LOGVALUE(EXPAND, stats.termfreq);
 }
 
+double
+ExpandWeight::get_maxweight() const
+{
+    return HUGE_VAL;
+}
+
 }
 }
@@ -54,6 +54,13 @@ class ExpandStats {
     /// The number of times the term occurs in the rset.
     Xapian::termcount rcollection_freq;
 
+    /** The sum of the term's wdf in the rset.
+     *
+     *  Unlike rcollection_freq, a wdf of 0 isn't counted as 1 here, so this
+     *  is a lower bound on the term's collection frequency.
+     */
+    Xapian::termcount rwdf_sum;
+
     /// The number of documents from the RSet indexed by the current term (r).
     Xapian::doccount rtermfreq;
 
@@ -72,6 +79,7 @@ class ExpandStats {
 		    Xapian::termcount wdf, Xapian::termcount doclen,
 		    Xapian::doccount subtf, Xapian::doccount subdbsize)
     {
+	rwdf_sum += wdf;
 	// Boolean terms may have wdf == 0, but treat that as 1 so such terms
 	// get a non-zero weight.
 	if (wdf == 0) wdf = 1;
@@ -101,6 +109,7 @@ class ExpandStats {
 	dbsize = 0;
 	termfreq = 0;
 	rcollection_freq = 0;
+	rwdf_sum = 0;
 	rtermfreq = 0;
 	multiplier = 0;
     }
@@ -135,6 +144,13 @@ class ExpandWeight {
      */
     bool use_exact_termfreq;
 
+    /** Does get_weight() use the collection frequency?
+     *
+     *  Looking up the collection frequency means a lookup in the database for
+     *  every candidate term, so we avoid doing so if it isn't needed.
+     */
+    bool want_collection_freq;
+
   public:
     /** Constructor.
      *
@@ -144,27 +160,52 @@ class ExpandWeight {
      *				    should we use the exact termfreq (if false
      *				    a cheaper approximation is used)
      *  @param expand_k_	    Parameter for TradEWeight (default: 0)
+     *  @param want_collection_freq_ Does get_weight() use the collection
+     *				    frequency? (default: false)
      */
     ExpandWeight(const Xapian::Database& db_,
 		 Xapian::doccount rsize_,
 		 bool use_exact_termfreq_,
-		 double expand_k_ = 0.0)
+		 double expand_k_ = 0.0,
+		 bool want_collection_freq_ = false)
 	: db(db_), dbsize(db.get_doccount()),
 	  rsize(rsize_),
 	  collection_len(db.get_total_length()),
 	  use_exact_termfreq(use_exact_termfreq_),
+	  want_collection_freq(want_collection_freq_),
 	  stats(db.get_average_length(), expand_k_) {}
 
-    /** Get the term statistics.
+    /** Collect the statistics from the relevant documents.
+     *
+     *  This only needs the TermList objects in the tree which are positioned
+     *  on the current term, so is cheap.  After calling this method,
+     *  get_maxweight() can be used to decide whether to call complete_stats()
+     *  and get_weight().
      *
      *  @param merger The tree of TermList objects.
+     */
+    void accumulate_stats(TermList* merger);
+
+    /** Collect any statistics which need lookups in the database.
+     *
      *  @param term The current term name.
      */
-    void collect_stats(TermList* merger, const std::string& term);
+    void complete_stats(const std::string& term);
 
     /// Calculate the weight.
     virtual double get_weight() const = 0;
 
+    /** Return an upper bound on the weight.
+     *
+     *  This can be called after accumulate_stats() but before complete_stats()
+     *  to allow terms which can't make it into the ESet to be rejected without
+     *  looking up their statistics in the database.
+     *
+     *  The default implementation returns HUGE_VAL, which means no terms are
+     *  rejected early.
+     */
+    virtual double get_maxweight() const;
+
   protected:
     /// ExpandStats object to accumulate statistics.
     ExpandStats stats;
@@ -209,6 +250,12 @@ class TradEWeight : public ExpandWeight {
 	: ExpandWeight(db_, rsize_, use_exact_termfreq_, expand_k_) { }
 
     double get_weight() const;
+
+    double get_maxweight() const;
+
+  private:
+    /// Calculate the weight for a term with term frequency @a termfreq.
+    double calc_weight(double termfreq) const;
 };
 
 /** This class implements the Bo1 scheme for query expansion.
@@ -237,9 +284,15 @@ class Bo1EWeight : public ExpandWeight {
     Bo1EWeight(const Xapian::Database& db_,
 	       Xapian::doccount rsize_,
 	       bool use_exact_termfreq_)
-	: ExpandWeight(db_, rsize_, use_exact_termfreq_) {}
+	: ExpandWeight(db_, rsize_, use_exact_termfreq_, 0.0, true) {}
 
     double get_weight() const;
+
+    double get_maxweight() const;
+
+  private:
+    /// Calculate the weight for a term with collection frequency @a F.
+    double calc_weight(double F) const;
 };
 
 }
@@ -29,16 +29,32 @@ namespace Xapian {
 namespace Internal {
 
 double
-TradEWeight::get_weight() const
+TradEWeight::calc_weight(double termfreq) const
 {
     double reldocs_without_term = get_rsize() - stats.rtermfreq;
     double num = (stats.rtermfreq + 0.5) *
-		 (get_dbsize() - stats.termfreq - reldocs_without_term + 0.5);
-    double denom = (stats.termfreq - stats.rtermfreq + 0.5) *
+		 (get_dbsize() - termfreq - reldocs_without_term + 0.5);
+    double denom = (termfreq - stats.rtermfreq + 0.5) *
 		   (reldocs_without_term + 0.5);
     double tw = log(num / denom);
     return stats.multiplier * tw;
 }
 
+double
+TradEWeight::get_weight() const
+{
+    return calc_weight(stats.termfreq);
+}
+
+double
+TradEWeight::get_maxweight() const
+{
+    // The weight decreases as termfreq increases, and before complete_stats()
+    // is called stats.termfreq may only cover some of the shards, but it's a
+    // lower bound on the value complete_stats() will set it to.  With a
+    // single database, this is exactly the weight.
+    return calc_weight(stats.termfreq);
+}
+
 }
 }
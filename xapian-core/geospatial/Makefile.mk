@@ -6,6 +6,7 @@ noinst_HEADERS +=\
 
 lib_src += \
 	geospatial/geoencode.cc \
+	geospatial/latlong_cells.cc \
 	geospatial/latlongcoord.cc \
 	geospatial/latlong_distance_keymaker.cc \
 	geospatial/latlong_metrics.cc \
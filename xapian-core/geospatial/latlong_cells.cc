@@ -0,0 +1,245 @@
+/** @file
+ * @brief LatLongCells implementation.
+ */
+/* Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+
+#include <config.h>
+
+#include "xapian/geospatial.h"
+#include "xapian/error.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <set>
+
+using namespace Xapian;
+using namespace std;
+
+/** Quadratic mean radius of the Earth in metres.
+ *
+ *  This is the default radius used by GreatCircleMetric.
+ */
+#define QUAD_EARTH_RADIUS_METRES 6372797.6
+
+/// The longest geohash we support (which needs 60 bits).
+static const unsigned MAX_PRECISION = 12;
+
+/** The maximum number of cells get_query() will aim to use for each centre.
+ *
+ *  The box around the area within range usually needs 4 cells at the finest
+ *  precision where a cell is bigger than the range, and one more character
+ *  multiplies the number of cells by up to 8, so this allows most searches
+ *  to use the finer precision.
+ */
+static const uint64_t MAX_CELLS = 32;
+
+static const char geohash_chars[] = "0123456789bcdefghjkmnpqrstuvwxyz";
+
+static void
+check_precision(unsigned precision)
+{
+    if (precision < 1 || precision > MAX_PRECISION) {
+	throw InvalidArgumentError("LatLongCells precision must be between 1 "
+				   "and 12");
+    }
+}
+
+/// Number of bits of longitude in a geohash with @a precision characters.
+static inline unsigned
+lon_bits(unsigned precision)
+{
+    return (precision * 5 + 1) / 2;
+}
+
+/// Number of bits of latitude in a geohash with @a precision characters.
+static inline unsigned
+lat_bits(unsigned precision)
+{
+    return precision * 5 / 2;
+}
+
+/** Return the index of the cell containing @a x.
+ *
+ *  @param x	The position in the range [0, 1].
+ *  @param bits	The number of bits in the index.
+ */
+static inline uint64_t
+cell_index(double x, unsigned bits)
+{
+    uint64_t n = uint64_t(1) << bits;
+    double i = floor(x * double(n));
+    if (i <= 0.0) return 0;
+    if (i >= double(n)) return n - 1;
+    return uint64_t(i);
+}
+
+/// Convert a longitude as stored in LatLongCoord to the range [-180, 180).
+static inline double
+signed_longitude(double longitude)
+{
+    return longitude >= 180.0 ? longitude - 360.0 : longitude;
+}
+
+/** Append the geohash for the cell with indices @a lat_i and @a lon_i.
+ *
+ *  Geohashes interleave the bits of the longitude and latitude indices,
+ *  starting with longitude, and encode them 5 bits to a character.
+ */
+static void
+append_geohash(string& result, uint64_t lat_i, uint64_t lon_i,
+	       unsigned precision)
+{
+    unsigned lat_b = lat_bits(precision);
+    unsigned lon_b = lon_bits(precision);
+    unsigned ch = 0;
+    for (unsigned bit = 0; bit != precision * 5; ++bit) {
+	unsigned b;
+	if (bit % 2 == 0) {
+	    b = (lon_i >> --lon_b) & 1;
+	} else {
+	    b = (lat_i >> --lat_b) & 1;
+	}
+	ch = (ch << 1) | b;
+	if (bit % 5 == 4) {
+	    result += geohash_chars[ch];
+	    ch = 0;
+	}
+    }
+}
+
+LatLongCells::LatLongCells(const string & prefix_,
+			   unsigned max_precision_)
+    : LatLongCells(prefix_, max_precision_, QUAD_EARTH_RADIUS_METRES)
+{
+}
+
+LatLongCells::LatLongCells(const string & prefix_,
+			   unsigned max_precision_,
+			   double radius_)
+    : prefix(prefix_), max_precision(max_precision_), radius(radius_)
+{
+    check_precision(max_precision);
+    if (radius <= 0) {
+	throw InvalidArgumentError("Radius of sphere must be positive");
+    }
+}
+
+string
+LatLongCells::geohash(const LatLongCoord & coord, unsigned precision)
+{
+    check_precision(precision);
+    double lon = signed_longitude(coord.longitude);
+    uint64_t lat_i = cell_index((coord.latitude + 90.0) / 180.0,
+				lat_bits(precision));
+    uint64_t lon_i = cell_index((lon + 180.0) / 360.0, lon_bits(precision));
+    string result;
+    append_geohash(result, lat_i, lon_i, precision);
+    return result;
+}
+
+void
+LatLongCells::index(Xapian::Document & doc,
+		    const LatLongCoords & coords) const
+{
+    for (auto&& coord : coords) {
+	// A geohash is a prefix of any longer geohash of the same point.
+	string term = prefix;
+	term += geohash(coord, max_precision);
+	for (unsigned p = 1; p <= max_precision; ++p) {
+	    doc.add_boolean_term(term.substr(0, prefix.size() + p));
+	}
+    }
+}
+
+Xapian::Query
+LatLongCells::get_query(const LatLongCoords & centre,
+			double max_range) const
+{
+    set<string> terms;
+    for (auto&& coord : centre) {
+	// Find a lat/long box containing everything within range.  The angle
+	// is increased very slightly so rounding errors can't cause us to
+	// miss cells right on the boundary.
+	double angle = max_range / radius * 1.000001;
+	double lat = coord.latitude;
+	double lon = signed_longitude(coord.longitude);
+	double lat_min = -90.0, lat_max = 90.0;
+	double lon_min = -180.0, lon_max = 180.0;
+	bool all_lon = true;
+	if (max_range > 0 && angle < M_PI) {
+	    double angle_deg = angle * (180.0 / M_PI);
+	    lat_min = max(-90.0, lat - angle_deg);
+	    lat_max = min(90.0, lat + angle_deg);
+	    double cos_lat = cos(lat * (M_PI / 180.0));
+	    double sin_angle = sin(angle);
+	    if (angle < M_PI / 2 && sin_angle < cos_lat) {
+		// The area within range doesn't include a pole.
+		double dlon = asin(sin_angle / cos_lat) * (180.0 / M_PI);
+		lon_min = lon - dlon;
+		lon_max = lon + dlon;
+		all_lon = false;
+	    }
+	}
+
+	// Pick the finest precision where the box is covered by a reasonable
+	// number of cells.
+	unsigned precision = max_precision;
+	uint64_t lat_lo, lat_hi, lon_first, lon_mask;
+	int64_t lon_start;
+	uint64_t lon_count;
+	while (true) {
+	    unsigned lat_b = lat_bits(precision);
+	    unsigned lon_b = lon_bits(precision);
+	    lat_lo = cell_index((lat_min + 90.0) / 180.0, lat_b);
+	    lat_hi = cell_index((lat_max + 90.0) / 180.0, lat_b);
+	    uint64_t lon_n = uint64_t(1) << lon_b;
+	    if (all_lon) {
+		lon_start = 0;
+		lon_count = lon_n;
+	    } else {
+		// The box may wrap around at +/-180 degrees, so the indices
+		// here may be out of range and are reduced modulo lon_n below.
+		double w = 360.0 / double(lon_n);
+		lon_start = int64_t(floor((lon_min + 180.0) / w));
+		int64_t lon_end = int64_t(floor((lon_max + 180.0) / w));
+		lon_count = min(uint64_t(lon_end - lon_start + 1), lon_n);
+	    }
+	    if (precision == 1 ||
+		(lat_hi - lat_lo + 1) * lon_count <= MAX_CELLS) {
+		lon_mask = lon_n - 1;
+		lon_first = uint64_t(lon_start) & lon_mask;
+		break;
+	    }
+	    --precision;
+	}
+
+	for (uint64_t lat_i = lat_lo; lat_i <= lat_hi; ++lat_i) {
+	    uint64_t lon_i = lon_first;
+	    for (uint64_t n = 0; n != lon_count; ++n) {
+		string term = prefix;
+		append_geohash(term, lat_i, lon_i, precision);
+		terms.insert(term);
+		lon_i = (lon_i + 1) & lon_mask;
+	    }
+	}
+    }
+
+    return Xapian::Query(Xapian::Query::OP_OR, terms.begin(), terms.end());
+}
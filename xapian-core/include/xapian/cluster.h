@@ -225,6 +225,8 @@ class XAPIAN_VISIBILITY_DEFAULT TermListGroup : public FreqSource {
  */
 class XAPIAN_VISIBILITY_DEFAULT PointType
     : public Xapian::Internal::opt_intrusive_base {
+    friend class CosineDistance;
+
   protected:
     /** Implement a map to store the terms within a document
      *  and their pre-computed TF-IDF weights
@@ -144,6 +144,44 @@ const int DB_NO_TERMLIST	 = 0x20;
  */
 const int DB_RETRY_LOCK		 = 0x40;
 
+/** Reuse an idle connection to a remote server.
+ *
+ *  When opening a remote database with Xapian::Remote::open() using TCP,
+ *  reuse an idle connection previously opened with this flag to the same
+ *  host and port with the same timeouts, if there is one.  This avoids the
+ *  cost of making a new connection, and of the server opening the
+ *  database.  A reused connection is reopened, so it sees the latest
+ *  revision of the database as a new connection would.
+ *
+ *  A connection is idle once all the Database objects using it have been
+ *  destroyed.  The pool is shared by all threads in the process.  Up to 16
+ *  idle connections are kept, and each is closed after being idle for 30
+ *  seconds.
+ *
+ *  @since 1.5.0
+ */
+const int DB_POOL_CONNECTION	 = 0x80;
+
+/** Cache document lengths in memory.
+ *
+ *  When opening a Database, read the lengths of all the documents into
+ *  memory the first time one is needed, so that looking up a document
+ *  length (e.g. to calculate a weight for a matching document) doesn't need
+ *  to search the postlist table.  The cache is reread if reopen() moves to a
+ *  new revision.
+ *
+ *  The cache uses 1, 2 or 4 bytes (depending on the longest document) for
+ *  every document ID between the lowest and highest in use, so gaps in the
+ *  document IDs use memory too.  If fewer than half the document IDs in
+ *  that range are in use, document lengths aren't cached.
+ *
+ *  This is currently only supported by the glass backend - it's ignored by
+ *  other backends and when opening a WritableDatabase.
+ *
+ *  @since 1.5.0
+ */
+const int DB_CACHE_DOCLENS	 = 0x800;
+
 /** Use the glass backend.
  *
  *  When opening a WritableDatabase, this means create a glass database if a
@@ -274,6 +312,16 @@ const int DBCOMPACT_MULTIPASS = 8;
  */
 const int DBCOMPACT_SINGLE_FILE = 16;
 
+/** Store a compact dictionary of the terms in the output.
+ *
+ *  The dictionary is loaded into memory on first use and then used to look up
+ *  term frequencies and check if terms exist, and to iterate terms (e.g. for
+ *  wildcard expansion) without having to read the postlist table.
+ *
+ *  Only supported by the honey backend - ignored when producing glass.
+ */
+const int DBCOMPACT_TERM_DICTIONARY = 32;
+
 /** Assume document id is valid.
  *
  *  By default, Database::get_document() checks that the document id passed is
@@ -438,6 +438,28 @@ class XAPIAN_VISIBILITY_DEFAULT Database {
      */
     void keep_alive();
 
+    /** Cache the values in a slot in memory.
+     *
+     *  Experimental - see
+     *  https://xapian.org/docs/deprecation#experimental-features
+     *
+     *  When sorting or collapsing by value, or sorting using a KeyMaker, the
+     *  matcher needs the value of each candidate document.  After calling
+     *  this method, the values in @a slot are read into memory the first
+     *  time they are needed, and subsequent searches using this object (or
+     *  a copy of it) look them up there, until the database revision changes
+     *  (e.g. after reopen() opens a newer revision), at which point they are
+     *  read in again.
+     *
+     *  The cache uses 4 bytes for each document ID between the lowest and
+     *  highest with a value in the slot, plus a copy of each distinct value.
+     *
+     *  This method currently has no effect on a WritableDatabase.
+     *
+     *  @param slot	The value slot to cache.
+     */
+    void cache_values(Xapian::valueno slot) const;
+
     /** Get a document from the database.
      *
      *  The returned object acts as a handle which lazily fetches information
@@ -679,6 +701,10 @@ class XAPIAN_VISIBILITY_DEFAULT Database {
      *   - Xapian::DBCOMPACT_SINGLE_FILE
      *		Produce a single-file database (only supported for glass
      *		currently).
+     *   - Xapian::DBCOMPACT_TERM_DICTIONARY
+     *		Store a compact dictionary of the terms which is held in
+     *		memory to speed up term lookups and term iteration (only
+     *		supported for honey currently).
      *   - At most one of:
      *     - Xapian::Compactor::STANDARD - Don't split items unnecessarily.
      *     - Xapian::Compactor::FULL     - Split items whenever it saves space
@@ -59,6 +59,15 @@ namespace Remote {
  *				Xapian::NetworkTimeoutError is thrown.  A
  *				timeout of 0 means don't timeout.  (Default is
  *				10000ms, which is 10 seconds).
+ * @param flags		Xapian::DB_POOL_CONNECTION or 0.
+ */
+XAPIAN_VISIBILITY_DEFAULT
+Database open(const std::string &host, unsigned int port, unsigned timeout, unsigned connect_timeout, int flags);
+
+/** Construct a Database object for read-only access to a remote database
+ *  accessed via a TCP connection.
+ *
+ *  This is the same as calling the version above with @a flags set to 0.
  */
 XAPIAN_VISIBILITY_DEFAULT
 Database open(const std::string &host, unsigned int port, unsigned timeout = 10000, unsigned connect_timeout = 10000);
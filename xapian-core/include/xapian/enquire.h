@@ -358,6 +358,39 @@ class XAPIAN_VISIBILITY_DEFAULT Enquire {
      */
     void set_time_limit(double time_limit);
 
+    /** Set a time limit for remote shards to return their results.
+     *
+     *  When searching over several shards, one slow remote server would
+     *  otherwise determine how long every search takes.  If a time limit is
+     *  set, get_mset() stops waiting for remote shards which haven't replied
+     *  within this many seconds, and returns an MSet made from the results of
+     *  the other shards.  The limit applies separately to fetching the
+     *  statistics needed for weighting and to fetching the results, so
+     *  get_mset() may wait for up to twice this long in total.
+     *
+     *  MSet::get_timed_out_shards() reports how many shards this happened
+     *  for, and the bounds on the number of matches allow for any matching
+     *  documents in those shards.
+     *
+     *  The connection to a shard which times out is closed, and a new
+     *  connection is opened the next time that shard is used, so a server
+     *  which is still busy with an abandoned search doesn't delay later
+     *  searches.
+     *
+     *  @param time_limit  time in seconds (default: 0.0 which means no
+     *			   time limit)
+     *
+     *  Limitations:
+     *
+     *  This has no effect for remote shards which can't be waited for using
+     *  poll() or select(), or for writable remote shards (since closing the
+     *  connection would lose any uncommitted changes).  Local shards are
+     *  always searched in full.
+     *
+     *  @since 1.5.0
+     */
+    void set_remote_time_limit(double time_limit);
+
     /** Run the query.
      *
      *  Run the query using the settings in this Enquire object and those
@@ -483,6 +516,10 @@ class XAPIAN_VISIBILITY_DEFAULT Enquire {
      *  which are relevant (typically based on the user marking results or
      *  similar).
      *
+     *  Terms starting with the byte '\x01' are reserved for the pair terms
+     *  indexed by TermGenerator::FLAG_STOPWORD_PAIRS, and are never
+     *  returned.
+     *
      *  @param maxitems		The maximum number of terms to return.
      *  @param rset		Documents marked as relevant.
      *  @param flags		Bitwise-or combination of @a
@@ -34,8 +34,10 @@
 
 #include <xapian/attributes.h>
 #include <xapian/derefwrapper.h>
+#include <xapian/document.h>
 #include <xapian/keymaker.h>
 #include <xapian/postingsource.h>
+#include <xapian/query.h>
 #include <xapian/queryparser.h> // For sortable_serialise
 #include <xapian/visibility.h>
 
@@ -682,6 +684,106 @@ class XAPIAN_VISIBILITY_DEFAULT LatLongDistanceKeyMaker : public KeyMaker {
     std::string operator()(const Xapian::Document & doc) const;
 };
 
+/** Index and search hierarchical geohash cells for lat/long coordinates.
+ *
+ *  Experimental - see https://xapian.org/docs/deprecation#experimental-features
+ *
+ *  LatLongDistancePostingSource has to calculate the distance for every
+ *  document with a coordinate stored in its value slot, so a range-limited
+ *  search on its own is linear in the number of such documents.  This class
+ *  allows the candidates to be cheaply narrowed down first.
+ *
+ *  At index time, index() adds a boolean term for the geohash cell
+ *  containing each coordinate at every precision from 1 to the maximum
+ *  precision.  At search time, get_query() returns a query matching the
+ *  documents in the cells which cover the area within range of the
+ *  centre, which can be combined with the posting source using
+ *  Xapian::Query::OP_FILTER so that distances are only calculated for
+ *  documents in those cells:
+ *
+ *  @code
+ *  Xapian::LatLongCells cells("XG");
+ *  Xapian::LatLongDistancePostingSource ps(slot, centre, max_range);
+ *  Xapian::Query query(Xapian::Query::OP_FILTER,
+ *                      Xapian::Query(&ps),
+ *                      cells.get_query(centre, max_range));
+ *  @endcode
+ *
+ *  The query can equally be used with a LatLongDistanceKeyMaker to sort the
+ *  documents within range by distance.
+ *
+ *  The cells are chosen assuming distances are calculated on a sphere of
+ *  the specified radius, as GreatCircleMetric does.
+ */
+class XAPIAN_VISIBILITY_DEFAULT LatLongCells {
+    /// The term prefix to use.
+    std::string prefix;
+
+    /// The longest geohash to index.
+    unsigned max_precision;
+
+    /// The radius of the sphere, in metres.
+    double radius;
+
+  public:
+    /** Construct a LatLongCells object.
+     *
+     *  @param prefix_		The term prefix to use.
+     *  @param max_precision_	The longest geohash to index, in characters
+     *				(between 1 and 12).  Each character
+     *				subdivides the cell into 32, and the default
+     *				of 8 gives cells roughly 38m by 19m at the
+     *				equator.  (default: 8)
+     *
+     *  The quadratic mean radius of the Earth is used for the radius of the
+     *  sphere, which matches GreatCircleMetric's default.
+     */
+    explicit LatLongCells(const std::string & prefix_,
+			  unsigned max_precision_ = 8);
+
+    /** Construct a LatLongCells object.
+     *
+     *  @param prefix_		The term prefix to use.
+     *  @param max_precision_	The longest geohash to index, in characters
+     *				(between 1 and 12).
+     *  @param radius_		The radius of the sphere in metres.
+     */
+    LatLongCells(const std::string & prefix_,
+		 unsigned max_precision_,
+		 double radius_);
+
+    /** Return the geohash of the cell containing a coordinate.
+     *
+     *  @param coord		The coordinate.
+     *  @param precision	The length of geohash to return (between 1
+     *				and 12).
+     */
+    static std::string geohash(const LatLongCoord & coord,
+			       unsigned precision);
+
+    /** Add the cell terms for some coordinates to a document.
+     *
+     *  @param doc	The document to add terms to.
+     *  @param coords	The coordinates to add terms for.
+     */
+    void index(Xapian::Document & doc, const LatLongCoords & coords) const;
+
+    /** Return a query matching documents in cells within range of a centre.
+     *
+     *  The query may also match documents which are out of range (it
+     *  matches all documents in cells which overlap the area within range),
+     *  but it won't miss any which are in range, so it can be used to
+     *  prefilter the documents before the exact distance is calculated.
+     *
+     *  @param centre		The centre point (or points).
+     *  @param max_range	The maximum distance in metres.  If 0, there
+     *				is no maximum range and the query matches all
+     *				documents with cell terms.
+     */
+    Xapian::Query get_query(const LatLongCoords & centre,
+			    double max_range) const;
+};
+
 }
 
 #endif /* XAPIAN_INCLUDED_GEOSPATIAL_H */
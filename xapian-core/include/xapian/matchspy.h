@@ -204,43 +204,25 @@ class XAPIAN_VISIBILITY_DEFAULT MatchSpy
  */
 class XAPIAN_VISIBILITY_DEFAULT ValueCountMatchSpy : public MatchSpy {
   public:
+    /// @private @internal Class representing the internals.
     struct Internal;
 
-#ifndef SWIG // SWIG doesn't need to know about the internal class
-    /// @private @internal
-    struct XAPIAN_VISIBILITY_DEFAULT Internal
-	    : public Xapian::Internal::intrusive_base
-    {
-	/// The slot to count.
-	Xapian::valueno slot;
-
-	/// Total number of documents seen by the match spy.
-	Xapian::doccount total = 0;
-
-	/// The values seen so far, together with their frequency.
-	std::map<std::string, Xapian::doccount> values;
-
-	Internal() : slot(Xapian::BAD_VALUENO) {}
-	explicit Internal(Xapian::valueno slot_) : slot(slot_) {}
-    };
-#endif
-
   protected:
     /** @private @internal Reference counted internals. */
     Xapian::Internal::intrusive_ptr<Internal> internal;
 
   public:
     /// Construct an empty ValueCountMatchSpy.
-    ValueCountMatchSpy() {}
+    ValueCountMatchSpy();
 
     /// Construct a MatchSpy which counts the values in a particular slot.
-    explicit ValueCountMatchSpy(Xapian::valueno slot_)
-	    : internal(new Internal(slot_)) {}
+    explicit ValueCountMatchSpy(Xapian::valueno slot_);
+
+    /// Destructor.
+    ~ValueCountMatchSpy();
 
     /** Return the total number of documents tallied. */
-    size_t get_total() const noexcept {
-	return internal ? internal->total : 0;
-    }
+    size_t get_total() const noexcept;
 
     /** Get an iterator over the values seen in the slot.
      *
@@ -28,6 +28,7 @@
 
 #include <iterator>
 #include <string>
+#include <vector>
 
 #include <xapian/attributes.h>
 #include <xapian/document.h>
@@ -46,7 +47,8 @@ class XAPIAN_VISIBILITY_DEFAULT MSet {
     friend class MSetIterator;
 
     // Helper function for fetch() methods.
-    void fetch_(Xapian::doccount first, Xapian::doccount last) const;
+    void fetch_(Xapian::doccount first, Xapian::doccount last,
+		const std::vector<Xapian::valueno>* slots = NULL) const;
 
     /** Update the weight corresponding to the document indexed at
      *  position i with wt.
@@ -231,6 +233,16 @@ class XAPIAN_VISIBILITY_DEFAULT MSet {
      */
     Xapian::doccount get_uncollapsed_matches_upper_bound() const;
 
+    /** Number of shards which didn't return results in time.
+     *
+     *  This is the number of remote shards which didn't return their results
+     *  within the time limit set by Enquire::set_remote_time_limit().  If it
+     *  is non-zero, this MSet only contains results from the other shards.
+     *
+     *  @since 1.5.0
+     */
+    Xapian::doccount get_timed_out_shards() const;
+
     /** The maximum weight attained by any document. */
     double get_max_attained() const;
     /** The maximum possible weight any document could achieve. */
@@ -346,42 +358,61 @@ class XAPIAN_VISIBILITY_DEFAULT MSet {
 			const std::string & hi_end = "</b>",
 			const std::string & omit = "...") const;
 
-    /** Prefetch hint a range of items.
+    /** Fetch a range of items.
+     *
+     *  This reads the document data for the items in the range and caches
+     *  the documents in this MSet, so MSetIterator::get_document() for
+     *  these items doesn't need to go back to the database.  The documents
+     *  are read in docid order, which is generally much faster than reading
+     *  them one by one in rank order.
      *
-     *  For a remote database, this may start a pipelined fetch of the
-     *  requested documents from the remote server.
+     *  For a remote database, the documents are requested in batches rather
+     *  than waiting for each in turn.
      *
-     *  For a disk-based database, this may send prefetch hints to the
-     *  operating system such that the disk blocks the requested documents
-     *  are stored in are more likely to be in the cache when we come to
-     *  actually read them.
+     *  @param begin	The first item to fetch.
+     *  @param end	The item after the last one to fetch.
      */
     void fetch(const MSetIterator &begin, const MSetIterator &end) const;
 
-    /** Prefetch hint a single MSet item.
+    /** Fetch a range of items and some of their values.
      *
-     *  For a remote database, this may start a pipelined fetch of the
-     *  requested documents from the remote server.
+     *  As fetch(begin, end), but also reads the values in @a slots, which
+     *  is done in a single pass through each slot.  Other values are read
+     *  on demand as usual.
      *
-     *  For a disk-based database, this may send prefetch hints to the
-     *  operating system such that the disk blocks the requested documents
-     *  are stored in are more likely to be in the cache when we come to
-     *  actually read them.
+     *  @param begin	The first item to fetch.
+     *  @param end	The item after the last one to fetch.
+     *  @param slots	The value slots to read.
+     *
+     *  @since 1.5.0
      */
-    void fetch(const MSetIterator &item) const;
+    void fetch(const MSetIterator &begin, const MSetIterator &end,
+	       const std::vector<Xapian::valueno>& slots) const;
 
-    /** Prefetch hint the whole MSet.
+    /** Fetch a single MSet item.
      *
-     *  For a remote database, this may start a pipelined fetch of the
-     *  requested documents from the remote server.
+     *  See fetch(begin, end) for details.
+     */
+    void fetch(const MSetIterator &item) const;
+
+    /** Fetch the whole MSet.
      *
-     *  For a disk-based database, this may send prefetch hints to the
-     *  operating system such that the disk blocks the requested documents
-     *  are stored in are more likely to be in the cache when we come to
-     *  actually read them.
+     *  See fetch(begin, end) for details.
      */
     void fetch() const { fetch_(0, Xapian::doccount(-1)); }
 
+    /** Fetch the whole MSet and some of its values.
+     *
+     *  See fetch(begin, end, slots) for details.
+     *
+     *  @param slots	The value slots to read.
+     *
+     *  @since 1.5.0
+     */
+    void fetch(const std::vector<Xapian::valueno>& slots) const {
+	fetch_(0, Xapian::doccount(-1), &slots);
+    }
+
     /** Return number of items in this MSet object. */
     Xapian::doccount size() const;
 
@@ -682,13 +713,22 @@ operator+(MSetIterator::difference_type n, const MSetIterator& it)
 inline void
 MSet::fetch(const MSetIterator &begin_it, const MSetIterator &end_it) const
 {
-    fetch_(begin_it.off_from_end, end_it.off_from_end);
+    fetch_(size() - begin_it.off_from_end, size() - end_it.off_from_end);
+}
+
+inline void
+MSet::fetch(const MSetIterator &begin_it, const MSetIterator &end_it,
+	    const std::vector<Xapian::valueno>& slots) const
+{
+    fetch_(size() - begin_it.off_from_end, size() - end_it.off_from_end,
+	   &slots);
 }
 
 inline void
 MSet::fetch(const MSetIterator &item) const
 {
-    fetch_(item.off_from_end, item.off_from_end);
+    Xapian::doccount i = size() - item.off_from_end;
+    fetch_(i, i + 1);
 }
 
 inline MSetIterator
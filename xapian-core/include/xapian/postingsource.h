@@ -36,6 +36,8 @@
 
 #include <string>
 #include <map>
+#include <utility>
+#include <vector>
 
 namespace Xapian {
 
@@ -696,6 +698,249 @@ class XAPIAN_VISIBILITY_DEFAULT ValueMapPostingSource
 };
 
 
+/** An approximate nearest neighbour index for VectorPostingSource.
+ *
+ *  Experimental - see https://xapian.org/docs/deprecation#experimental-features
+ *
+ *  VectorPostingSource on its own has to calculate the similarity for every
+ *  document with a vector stored in its value slot, so its cost is linear in
+ *  the number of such documents.  This class builds an inverted file index
+ *  (IVF) which allows most of them to be skipped: the vectors are clustered
+ *  with k-means, and each document gets a boolean term for the cluster its
+ *  vector is in.  A search then only needs to consider the documents in the
+ *  few clusters nearest the query vector.
+ *
+ *  Because the clusters are ordinary terms, the index is stored in the
+ *  database's posting lists, so it is updated by commit() and preserved by
+ *  compaction and replication.  The centroid of each cluster is stored in
+ *  the user metadata, under keys starting with the term prefix.
+ *
+ *  To build or rebuild the index for the vectors already in a database:
+ *
+ *  @code
+ *  Xapian::VectorIndex index(db, "XV");
+ *  index.build(db, slot, 256);
+ *  db.commit();
+ *  @endcode
+ *
+ *  Documents added later should be indexed using index() so they're assigned
+ *  to a cluster, and it's worth rebuilding the index if many documents have
+ *  been added since the clusters were chosen.  To search the index, pass it
+ *  to VectorPostingSource::set_index().
+ */
+class XAPIAN_VISIBILITY_DEFAULT VectorIndex {
+    friend class VectorPostingSource;
+
+    /// The term prefix, which is also the metadata key for the index.
+    std::string prefix;
+
+    /// The value slot the vectors are stored in.
+    Xapian::valueno slot;
+
+    /// The number of dimensions of the vectors.
+    unsigned dimensions;
+
+    /// The centroid of each cluster, normalised to unit length.
+    std::vector<std::vector<float>> centroids;
+
+    /** The largest angle between each centroid and a vector in its cluster.
+     *
+     *  This is used to bound the similarity of the vectors in a cluster.
+     */
+    std::vector<double> radii;
+
+    /// Return the cluster whose centroid is nearest to unit vector @a v.
+    unsigned nearest_cluster(const std::vector<float>& v) const;
+
+  public:
+    /** Construct a VectorIndex.
+     *
+     *  @param db	The database to read the index from.  If there isn't
+     *			an index with prefix @a prefix_ yet, the VectorIndex
+     *			will be empty until build() is called.
+     *  @param prefix_	The term prefix to use for the clusters.  This
+     *			shouldn't be used for any other terms, or as the start
+     *			of any other user metadata keys.
+     *
+     *  The index isn't reread if @a db changes, so create a new VectorIndex
+     *  after reopening a database which may have been modified.
+     */
+    VectorIndex(const Xapian::Database& db, const std::string& prefix_);
+
+    /** Build the index for the vectors stored in a value slot.
+     *
+     *  The vectors are clustered, then every document with a vector is
+     *  updated to have the term for its cluster (as a boolean term, so
+     *  document lengths aren't changed).  Any existing index using the same
+     *  prefix is replaced.
+     *
+     *  Vectors need to be stored using VectorPostingSource::serialise_vector()
+     *  and have the same number of dimensions as the first vector in the
+     *  slot - any which don't, or which are all zeros, aren't indexed.
+     *
+     *  Documents are only rewritten (with replace_document()) if their
+     *  cluster term changes, but this is still expensive: the first build
+     *  rewrites every document with a vector, and after a rebuild the
+     *  clusters may be numbered differently, which could change most of
+     *  the cluster terms.  Each document is read and
+     *  written in full, so this costs about as much as reindexing those
+     *  documents, and all the vectors are held in memory while clustering.
+     *  The changes need to be committed as usual.
+     *
+     *  @param db		The database to index.
+     *  @param slot_		The value slot the vectors are stored in.
+     *  @param n_clusters	The number of clusters to use.  Around the
+     *				square root of the number of vectors is a
+     *				reasonable choice.
+     */
+    void build(Xapian::WritableDatabase& db,
+	       Xapian::valueno slot_,
+	       unsigned n_clusters);
+
+    /** Add a vector to a document and the index.
+     *
+     *  This stores @a v in the index's value slot in @a doc and adds the
+     *  term for the cluster nearest to it (removing any existing cluster
+     *  term).  If @a v is further from the centroid than any vector seen
+     *  before, the updated cluster bounds are stored in @a db.
+     *
+     *  The document still needs to be added to or replaced in @a db.
+     *
+     *  @param db	The database the index is for.
+     *  @param doc	The document to add @a v to.
+     *  @param v	The vector, which must have get_dimensions() dimensions
+     *			and not be all zeros.
+     */
+    void index(Xapian::WritableDatabase& db,
+	       Xapian::Document& doc,
+	       const std::vector<float>& v);
+
+    /// Return the number of clusters (0 if the index hasn't been built).
+    unsigned get_num_clusters() const { return unsigned(centroids.size()); }
+
+    /// Return the number of dimensions of the indexed vectors.
+    unsigned get_dimensions() const { return dimensions; }
+
+    /// Return the value slot the vectors are stored in.
+    Xapian::valueno get_slot() const { return slot; }
+};
+
+/** A posting source which weights documents by the similarity of a vector.
+ *
+ *  This returns entries for documents which have a vector stored in the
+ *  specified value slot which is similar enough to a query vector, weighted
+ *  by the cosine similarity between the two vectors.  Vectors should be
+ *  stored in the slot using VectorPostingSource::serialise_vector().
+ *
+ *  The weights returned are between 0 and 1, so this can be combined with a
+ *  text query using Xapian::Query::OP_OR or Xapian::Query::OP_AND_MAYBE to
+ *  rank by a mix of text relevance and vector similarity (you'll probably
+ *  want to scale one or other contribution using
+ *  Xapian::Query::OP_SCALE_WEIGHT).  The matcher's minimum weight is used to
+ *  skip documents which can't contribute enough to be of interest.
+ *
+ *  By default every document with a value in the slot is compared against
+ *  the query vector, so the results are exact, but the cost is proportional
+ *  to the number of such documents.  For large collections, use
+ *  set_index() to only compare documents in the clusters of a VectorIndex
+ *  nearest to the query vector.
+ *
+ *  Documents whose stored vector has a different number of dimensions to the
+ *  query vector, or which is all zeros, are ignored.
+ */
+class XAPIAN_VISIBILITY_DEFAULT VectorPostingSource
+	: public ValuePostingSource {
+    /// The query vector, normalised to unit length.
+    std::vector<float> query;
+
+    /// Documents with a lower similarity than this are ignored.
+    double min_similarity;
+
+    /// The similarity for the current document.
+    double similarity;
+
+    /// Terms for the clusters to search, or empty to search every vector.
+    std::vector<std::string> cluster_terms;
+
+    /// Upper bound on the similarity of vectors in each of cluster_terms.
+    std::vector<double> cluster_bounds;
+
+    /// Posting lists for clusters with documents left, and their bounds.
+    std::vector<std::pair<Xapian::PostingIterator, double>> cluster_lists;
+
+    /// The docid the source was last positioned on or checked.
+    Xapian::docid current;
+
+    /// Calculate the similarity for the current document.
+    void calc_similarity();
+
+    /// Advance to the next document which is similar enough.
+    void skip_dissimilar(double min_wt);
+
+    /// Advance the cluster posting lists to @a target, dropping any which end.
+    void skip_clusters(Xapian::docid target);
+
+    /// Advance to the first document >= @a target in a cluster being searched.
+    void skip_to_candidate(Xapian::docid target, double min_wt);
+
+  public:
+    /** Construct a VectorPostingSource.
+     *
+     *  @param slot_		The value slot to read vectors from.
+     *  @param query_		The vector to compare against.
+     *  @param min_similarity_	Ignore documents whose cosine similarity to
+     *				@a query_ is less than this, which must be
+     *				between 0 and 1 (default: 0).
+     */
+    VectorPostingSource(Xapian::valueno slot_,
+			const std::vector<float>& query_,
+			double min_similarity_ = 0.0);
+
+    /** Use a VectorIndex to find similar documents.
+     *
+     *  Only documents in the @a n_probe clusters whose centroids are nearest
+     *  to the query vector are considered, so the results are approximate -
+     *  a similar document in a different cluster will be missed.  Probing
+     *  more clusters finds more of these, but takes longer.
+     *
+     *  The cluster bounds allow the upper bound on the weight to be less
+     *  than 1, which lets the matcher skip more documents when combining
+     *  this with other subqueries.
+     *
+     *  @param index	The index, which must be for this source's value slot
+     *			and have vectors with the same number of dimensions as
+     *			the query vector.
+     *  @param n_probe	The number of clusters to search (must be > 0).
+     */
+    void set_index(const VectorIndex& index, unsigned n_probe);
+
+    /** Serialise a vector for storing in a value slot.
+     *
+     *  @param v	The vector to serialise.
+     */
+    static std::string serialise_vector(const std::vector<float>& v);
+
+    /** Unserialise a vector serialised by serialise_vector().
+     *
+     *  @param serialised	The serialised vector.
+     */
+    static std::vector<float> unserialise_vector(const std::string& serialised);
+
+    void next(double min_wt);
+    void skip_to(Xapian::docid min_docid, double min_wt);
+    bool check(Xapian::docid min_docid, double min_wt);
+
+    double get_weight() const;
+    VectorPostingSource * clone() const;
+    std::string name() const;
+    std::string serialise() const;
+    VectorPostingSource * unserialise(const std::string &serialised) const;
+    void init(const Database & db_);
+
+    std::string get_description() const;
+};
+
+
 /** A posting source which returns a fixed weight for all documents.
  *
  *  This returns entries for all documents in the given database, with a fixed
@@ -715,6 +715,23 @@ class XAPIAN_VISIBILITY_DEFAULT QueryParser {
 	 */
 	FLAG_NO_POSITIONS = 0x20000,
 
+	/** Use stopword pair terms to speed up phrase searches.
+	 *
+	 *  For each pair of adjacent words in an exact phrase search where
+	 *  either is a stopword, the term indexed for the pair by
+	 *  TermGenerator::FLAG_STOPWORD_PAIRS is added as a filter.  This
+	 *  doesn't change the results or weights, but means positional
+	 *  information only needs to be checked for documents which contain
+	 *  all the pairs.
+	 *
+	 *  The TermGenerator::FLAG_STOPWORD_PAIRS flag needs to have been used
+	 *  at index time with the same stopper as passed to set_stopper() -
+	 *  otherwise matching documents may be missed.
+	 *
+	 *  @since Added in Xapian 1.5.0.
+	 */
+	FLAG_STOPWORD_PAIRS = 0x40000,
+
 	/** The default flags.
 	 *
 	 *  Used if you don't explicitly pass any to @a parse_query().
@@ -162,6 +162,46 @@ class XAPIAN_VISIBILITY_DEFAULT Stem {
     /// Return true if this is a no-op stemmer.
     bool is_none() const { return !internal; }
 
+    /** Cache stemmed forms of words.
+     *
+     *  The distribution of words in natural language text is very skewed,
+     *  so caching the stemmed forms of recently seen words can avoid most
+     *  calls to the stemming algorithm.
+     *
+     *  The cache is shared by copies of this Xapian::Stem object made after
+     *  this method is called, including those held by Xapian::TermGenerator
+     *  and Xapian::QueryParser objects if you then call their set_stemmer()
+     *  methods, so they'll all use the same cache.  Copies made before this
+     *  call aren't affected.  As with the stemming algorithm itself, this
+     *  means these objects shouldn't be used concurrently from different
+     *  threads.
+     *
+     *  This method has no effect for a no-op stemmer.
+     *
+     *  @param size	The maximum number of words to cache, or 0 to disable
+     *			caching (which is the default).  Setting the size
+     *			discards any existing cache entries and resets the
+     *			statistics.
+     *
+     *  @since Added in Xapian 1.5.0.
+     */
+    void set_cache_size(unsigned size);
+
+    /** Return the number of calls which were answered from the cache.
+     *
+     *  @since Added in Xapian 1.5.0.
+     */
+    unsigned long long get_cache_hits() const;
+
+    /** Return the number of calls which weren't answered from the cache.
+     *
+     *  Calls with an empty word and calls made when caching isn't enabled
+     *  aren't counted.
+     *
+     *  @since Added in Xapian 1.5.0.
+     */
+    unsigned long long get_cache_misses() const;
+
     /// Return a string describing this object.
     std::string get_description() const;
 
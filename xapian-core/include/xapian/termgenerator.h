@@ -145,7 +145,32 @@ class XAPIAN_VISIBILITY_DEFAULT TermGenerator {
 	 *
 	 *  @since Added in Xapian 1.5.0.
 	 */
-	FLAG_WORD_BREAKS = 4096 // Value matches QueryParser flag
+	FLAG_WORD_BREAKS = 4096, // Value matches QueryParser flag
+
+	/** Index pairs of adjacent words where either is a stopword.
+	 *
+	 *  Each such pair is indexed as a single term (without positional
+	 *  information) in addition to the usual terms.  Phrase searches
+	 *  involving common words (e.g. "the who" or "to be or not to be")
+	 *  can then check for these much rarer terms to avoid reading large
+	 *  amounts of positional data.  The pair terms are boolean terms (with
+	 *  wdf 0) so they don't change document lengths or weights.
+	 *
+	 *  The pair terms start with the byte '\x01', and terms starting with
+	 *  this byte are reserved for this use - Enquire::get_eset() never
+	 *  returns them, whether or not this flag was used.
+	 *
+	 *  The stopper set with set_stopper() is used to decide which words
+	 *  are stopwords, so this flag has no effect unless a stopper is set,
+	 *  and you'll probably want to use STOP_NONE with
+	 *  set_stopper_strategy() so stopwords are still indexed.
+	 *
+	 *  The QueryParser::FLAG_STOPWORD_PAIRS flag needs to be passed to
+	 *  QueryParser, which needs to be given the same stopper.
+	 *
+	 *  @since Added in Xapian 1.5.0.
+	 */
+	FLAG_STOPWORD_PAIRS = 0x40000 // Value matches QueryParser flag
     };
 
     /// Stemming strategies, for use with set_stemming_strategy().
@@ -5,6 +5,7 @@ AM_CPPFLAGS += -I$(top_srcdir)/languages -Ilanguages
 endif
 
 noinst_HEADERS +=\
+	languages/stemcache.h\
 	languages/steminternal.h
 
 snowball_algorithms =\
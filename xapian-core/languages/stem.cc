@@ -26,6 +26,7 @@
 #include <xapian/error.h>
 
 #include "steminternal.h"
+#include "stemcache.h"
 
 #include "allsnowballheaders.h"
 #include "keyword.h"
@@ -145,6 +146,33 @@ Stem::operator()(const std::string &word) const
     return internal->operator()(word);
 }
 
+void
+Stem::set_cache_size(unsigned size)
+{
+    if (!internal) return;
+    auto cache = dynamic_cast<CachingStemImplementation*>(internal.get());
+    StemImplementation* stemmer = cache ? cache->get_stemmer() : internal.get();
+    if (size) {
+	internal = new CachingStemImplementation(stemmer, size);
+    } else {
+	internal = stemmer;
+    }
+}
+
+unsigned long long
+Stem::get_cache_hits() const
+{
+    auto cache = dynamic_cast<CachingStemImplementation*>(internal.get());
+    return cache ? cache->hits : 0;
+}
+
+unsigned long long
+Stem::get_cache_misses() const
+{
+    auto cache = dynamic_cast<CachingStemImplementation*>(internal.get());
+    return cache ? cache->misses : 0;
+}
+
 string
 Stem::get_description() const
 {
@@ -0,0 +1,106 @@
+/** @file
+ * @brief Bounded cache of stemmed forms
+ */
+/* Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifndef XAPIAN_INCLUDED_STEMCACHE_H
+#define XAPIAN_INCLUDED_STEMCACHE_H
+
+#include <xapian/intrusive_ptr.h>
+#include <xapian/stem.h>
+
+#include <string>
+#include <unordered_map>
+
+/** Stemming algorithm wrapper which caches stemmed forms.
+ *
+ *  Word frequencies in natural language text are very skewed, so a fairly
+ *  small cache avoids running the stemming algorithm for most words.
+ *
+ *  Stem::set_cache_size() wraps the Stem's algorithm in one of these, so
+ *  the public StemImplementation class doesn't need to know about caching.
+ *
+ *  Entries are held in two generations.  Hits in the old generation are
+ *  moved to the current one, and when the current generation fills up it
+ *  becomes the old generation and the previous old generation is discarded.
+ *  This approximates LRU without needing to update a list on every hit.
+ */
+class CachingStemImplementation : public Xapian::StemImplementation {
+    typedef std::unordered_map<std::string, std::string> map_type;
+
+    /// The stemming algorithm being cached.
+    Xapian::Internal::intrusive_ptr<Xapian::StemImplementation> stemmer;
+
+    map_type current;
+
+    map_type old;
+
+    /// Maximum number of entries in both generations together.
+    size_t max_size;
+
+    /// Maximum number of entries in the current generation.
+    size_t generation_size;
+
+    /// Add @a word with stem @a stem, returning a reference to the cached stem.
+    const std::string& add(const std::string& word, std::string&& stem) {
+	if (current.size() >= generation_size) {
+	    swap(old, current);
+	    current.clear();
+	}
+	// The generations can be up to half the size each (rounded up), so
+	// make sure that together they don't exceed max_size.
+	if (current.size() + old.size() >= max_size && !old.empty())
+	    old.erase(old.begin());
+	return current.emplace(word, std::move(stem)).first->second;
+    }
+
+  public:
+    unsigned long long hits = 0;
+
+    unsigned long long misses = 0;
+
+    CachingStemImplementation(Xapian::StemImplementation* stemmer_,
+			      unsigned size)
+	: stemmer(stemmer_), max_size(size), generation_size((size + 1) / 2) { }
+
+    /// Return the stemming algorithm being cached.
+    Xapian::StemImplementation* get_stemmer() const { return stemmer.get(); }
+
+    std::string operator()(const std::string& word) {
+	auto i = current.find(word);
+	if (i != current.end()) {
+	    ++hits;
+	    return i->second;
+	}
+	i = old.find(word);
+	if (i == old.end()) {
+	    ++misses;
+	    return add(word, (*stemmer)(word));
+	}
+	++hits;
+	std::string stem = std::move(i->second);
+	old.erase(i);
+	return add(word, std::move(stem));
+    }
+
+    std::string get_description() const {
+	return stemmer->get_description();
+    }
+};
+
+#endif // XAPIAN_INCLUDED_STEMCACHE_H
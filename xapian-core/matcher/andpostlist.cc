@@ -29,16 +29,25 @@
 using namespace std;
 
 void
-AndPostList::allocate_plist_and_max_wt()
+AndPostList::allocate_arrays()
 {
     plist = new PostList * [n_kids];
     try {
 	max_wt = new double [n_kids]();
+	stats = new SubStats [n_kids];
+	order = new size_t [n_kids];
     } catch (...) {
 	delete [] plist;
 	plist = NULL;
+	delete [] max_wt;
+	max_wt = NULL;
+	delete [] stats;
+	stats = NULL;
 	throw;
     }
+    for (size_t i = 0; i < n_kids; ++i) {
+	order[i] = i;
+    }
 }
 
 AndPostList::~AndPostList()
@@ -50,6 +59,8 @@ AndPostList::~AndPostList()
 	delete [] plist;
     }
     delete [] max_wt;
+    delete [] stats;
+    delete [] order;
 }
 
 Xapian::docid
@@ -89,21 +100,35 @@ AndPostList::recalc_maxweight()
     return max_total;
 }
 
+void
+AndPostList::next_leader(double w_min)
+{
+    size_t lead = order[0];
+    next_helper(lead, w_min);
+    if (did && !plist[lead]->at_end()) {
+	stats[lead].add(plist[lead]->get_docid() - did, true);
+    }
+}
+
 PostList *
 AndPostList::find_next_match(double w_min)
 {
-advanced_plist0:
-    if (plist[0]->at_end()) {
+    size_t lead = order[0];
+advanced_leader:
+    if (plist[lead]->at_end()) {
 	did = 0;
 	return NULL;
     }
-    did = plist[0]->get_docid();
-    for (size_t i = 1; i < n_kids; ++i) {
+    did = plist[lead]->get_docid();
+    ++candidates;
+    for (size_t k = 1; k < n_kids; ++k) {
+	size_t i = order[k];
 	bool valid;
 	check_helper(i, did, w_min, valid);
 	if (!valid) {
-	    next_helper(0, w_min);
-	    goto advanced_plist0;
+	    stats[i].add(1, false);
+	    next_leader(w_min);
+	    goto advanced_leader;
 	}
 	if (plist[i]->at_end()) {
 	    did = 0;
@@ -111,24 +136,79 @@ advanced_plist0:
 	}
 	Xapian::docid new_did = plist[i]->get_docid();
 	if (new_did != did) {
-	    skip_to_helper(0, new_did, w_min);
-	    goto advanced_plist0;
+	    // The entry at new_did gets counted when we next check it.
+	    stats[i].add(new_did - did, false);
+	    skip_to_helper(lead, new_did, w_min);
+	    if (!plist[lead]->at_end()) {
+		stats[lead].add(plist[lead]->get_docid() - new_did + 1, true);
+	    }
+	    goto advanced_leader;
 	}
+	stats[i].add(1, true);
     }
     return NULL;
 }
 
+void
+AndPostList::reorder()
+{
+    candidates = 0;
+
+    // If another sub-postlist is clearly sparser than the leader, make it
+    // the leader so there are fewer candidates to consider.
+    double lead_density = stats[order[0]].density();
+    if (lead_density > 0.0) {
+	double best_density = 0.5 * lead_density;
+	size_t best = 0;
+	for (size_t k = 1; k < n_kids; ++k) {
+	    double density = stats[order[k]].density();
+	    if (density >= 0.0 && density < best_density) {
+		best_density = density;
+		best = k;
+	    }
+	}
+	if (best) swap(order[0], order[best]);
+    }
+
+    // Check the others in ascending order of density, so we find out that
+    // a candidate doesn't match sooner.  Those we don't have enough data
+    // for go last.  This is an insertion sort, which is stable, and n_kids
+    // is usually small.
+    auto key = [this](size_t i) {
+	double density = stats[i].density();
+	return density < 0.0 ? 2.0 : density;
+    };
+    for (size_t k = 2; k < n_kids; ++k) {
+	size_t i = order[k];
+	double i_key = key(i);
+	size_t j = k;
+	while (j > 1 && key(order[j - 1]) > i_key) {
+	    order[j] = order[j - 1];
+	    --j;
+	}
+	order[j] = i;
+    }
+
+    for (size_t i = 0; i < n_kids; ++i) {
+	stats[i] = SubStats();
+    }
+}
+
 PostList *
 AndPostList::next(double w_min)
 {
-    next_helper(0, w_min);
+    if (candidates >= REORDER_INTERVAL)
+	reorder();
+    next_leader(w_min);
     return find_next_match(w_min);
 }
 
 PostList *
 AndPostList::skip_to(Xapian::docid did_min, double w_min)
 {
-    skip_to_helper(0, did_min, w_min);
+    if (candidates >= REORDER_INTERVAL)
+	reorder();
+    skip_to_helper(order[0], did_min, w_min);
     return find_next_match(w_min);
 }
 
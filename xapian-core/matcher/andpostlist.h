@@ -63,6 +63,58 @@ class AndPostList : public PostList {
     /// Pointer to the matcher object, so we can report pruning.
     PostListTree *matcher;
 
+    /** How a sub-postlist has behaved since we last considered reordering.
+     *
+     *  We initially order the sub-postlists by their estimated termfreqs,
+     *  but the estimates can be poor (e.g. for a value range), so we gather
+     *  these statistics as we go and reorder based on them.
+     */
+    struct SubStats {
+	/// Number of times we've looked at this sub-postlist.
+	Xapian::doccount samples = 0;
+
+	/// Number of entries seen.
+	Xapian::doccount entries = 0;
+
+	/// Number of docids covered by those samples.
+	double span = 0.0;
+
+	/// Record that @a n docids were covered and @a found entries seen.
+	void add(double n, bool found) {
+	    ++samples;
+	    entries += found;
+	    span += n;
+	}
+
+	/** Estimate the proportion of documents this sub-postlist matches.
+	 *
+	 *  Returns a negative value if there isn't enough data yet.
+	 */
+	double density() const {
+	    const Xapian::doccount MIN_SAMPLES = 16;
+	    if (samples < MIN_SAMPLES) return -1.0;
+	    return entries / span;
+	}
+    };
+
+    /// Array of statistics for the sub-postlists.
+    SubStats* stats = nullptr;
+
+    /** The order to use the sub-postlists in.
+     *
+     *  The sub-postlist order[0] is the "leader" which we call next() on to
+     *  find candidate documents - the others are checked in the order
+     *  given.  We keep plist in its original order so that the weight is
+     *  always summed in the same order.
+     */
+    size_t* order = nullptr;
+
+    /// Number of candidate documents since we last considered reordering.
+    Xapian::doccount candidates = 0;
+
+    /// How many candidate documents to see between considering reordering.
+    static constexpr Xapian::doccount REORDER_INTERVAL = 256;
+
     /// Calculate the new minimum weight for sub-postlist n.
     double new_min(double w_min, size_t n) {
 	return w_min - (max_total - max_wt[n]);
@@ -102,15 +154,24 @@ class AndPostList : public PostList {
 	}
     }
 
-    /** Allocate plist and max_wt arrays of @a n_kids each.
+    /** Allocate plist, max_wt, stats and order arrays of @a n_kids each.
      *
      *  @exception  std::bad_alloc.
      */
-    void allocate_plist_and_max_wt();
+    void allocate_arrays();
+
+    /// Call next() on the leader, and record how far it moved.
+    void next_leader(double w_min);
 
     /// Advance the sublists to the next match.
     PostList * find_next_match(double w_min);
 
+    /** Reorder the sub-postlists based on the statistics gathered.
+     *
+     *  Must only be called when all the sub-postlists are on a match.
+     */
+    void reorder();
+
   public:
     /** Construct from 2 random-access iterators to a container of PostList*
      *  and a pointer to the matcher.
@@ -119,7 +180,7 @@ class AndPostList : public PostList {
     AndPostList(RandomItor pl_begin, RandomItor pl_end, PostListTree* matcher_)
 	: n_kids(pl_end - pl_begin), matcher(matcher_)
     {
-	allocate_plist_and_max_wt();
+	allocate_arrays();
 
 	// Copy the postlists in ascending termfreq order, since it will
 	// be more efficient to look at the shorter lists first, and skip
@@ -166,7 +227,7 @@ class AndPostList : public PostList {
 	    std::swap(l, r);
 	    std::swap(lmax, rmax);
 	}
-	allocate_plist_and_max_wt();
+	allocate_arrays();
 	// Put the least frequent postlist first.
 	plist[0] = r;
 	plist[1] = l;
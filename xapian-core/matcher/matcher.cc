@@ -40,6 +40,7 @@
 
 #ifdef XAPIAN_HAS_REMOTE_BACKEND
 # include "backends/remote/remote-database.h"
+# include "realtime.h"
 # include "remotesubmatch.h"
 # include "socket_utils.h"
 #endif
@@ -47,6 +48,7 @@
 #include <algorithm>
 #include <cerrno>
 #include <cfloat> // For DBL_EPSILON.
+#include <cmath>
 #include <vector>
 
 #ifdef HAVE_POLL_H
@@ -79,58 +81,83 @@ template<typename Action>
 inline void
 Matcher::for_all_remotes(Action action)
 {
+    for_all_remotes(action, 0.0, [](RemoteSubMatch*) {});
+}
+
+template<typename Action, typename TimedOutAction>
+inline void
+Matcher::for_all_remotes(Action action,
+			 double end_time,
+			 TimedOutAction timed_out)
+{
+    // Without a time limit, we can just block on the last remote so only
+    // need to wait for readiness while more than one remains.
+    size_t min_remaining = (end_time == 0.0) ? 1 : 0;
 #ifdef HAVE_POLL
     size_t n_remotes = remotes.size();
-    if (n_remotes <= 1) {
-	// We only need to use poll() when there are at least 2 remote
-	// databases we need to wait for.
-	if (n_remotes == 1) {
-	    // Just execute action and block if it's not ready.
-	    action(remotes[0].get());
-	}
-	return;
+    if (n_remotes > min_remaining) {
+	unique_ptr<struct pollfd[]> fds(new struct pollfd[n_remotes]);
+	for (size_t i = 0; i != n_remotes; ++i) {
+	    fds[i].fd = remotes[i]->get_read_fd();
+	    fds[i].events = POLLIN;
+	    fds[i].revents = 0;
+	}
+	do {
+	    int timeout = -1;
+	    if (end_time != 0.0) {
+		double time_left = end_time - RealTime::now();
+		if (time_left <= 0.0) break;
+		timeout = int(ceil(time_left * 1000.0));
+	    }
+	    int r = poll(fds.get(), n_remotes, timeout);
+	    if (r <= 0) {
+		// If there's no time limit we shouldn't get a timeout, but if
+		// we do retry.  With a time limit, we check the time above.
+		if (r == 0 || errno == EINTR || errno == EAGAIN) {
+		    continue;
+		}
+		throw Xapian::NetworkError("poll() failed waiting for remotes",
+					   errno);
+	    }
+	    size_t i = 0;
+	    while (i != n_remotes) {
+		if (fds[i].revents) {
+		    action(remotes[i].get());
+		    // Swap such that entries we still need to handle are first.
+		    swap(remotes[i], remotes[--n_remotes]);
+		    fds[i] = fds[n_remotes];
+		    // r is number of ready fds.
+		    if (--r == 0) break;
+		} else {
+		    ++i;
+		}
+	    }
+	} while (n_remotes > min_remaining);
     }
 
-    unique_ptr<struct pollfd[]> fds(new struct pollfd[n_remotes]);
-    for (size_t i = 0; i != n_remotes; ++i) {
-	fds[i].fd = remotes[i]->get_read_fd();
-	fds[i].events = POLLIN;
-	fds[i].revents = 0;
-    }
-    do {
-	int r = poll(fds.get(), n_remotes, -1);
-	if (r <= 0) {
-	    // We shouldn't get a timeout, but if we do retry.
-	    if (r == 0 || errno == EINTR || errno == EAGAIN) {
-		continue;
-	    }
-	    throw Xapian::NetworkError("poll() failed waiting for remotes",
-				       errno);
+    if (end_time == 0.0) {
+	// If there's only one remote left just execute action and block if
+	// it's not ready.
+	if (n_remotes == 1) {
+	    action(remotes[0].get());
 	}
-	size_t i = 0;
-	while (i != n_remotes) {
-	    if (fds[i].revents) {
-		action(remotes[i].get());
-		// Swap such that entries we still need to handle are first.
-		swap(remotes[i], remotes[--n_remotes]);
-		fds[i] = fds[n_remotes];
-		// r is number of ready fds.
-		if (--r == 0) break;
-	    } else {
-		++i;
-	    }
+    } else {
+	for (size_t i = 0; i != n_remotes; ++i) {
+	    timed_out(remotes[i].get());
 	}
-    } while (n_remotes > 1);
-
-    // If there's only one remote left just execute action and block if it's
-    // not ready.
-    if (n_remotes == 1) {
-	action(remotes[0].get());
     }
 #else
     size_t n_remotes = first_nonselectable;
     fd_set fds;
-    while (n_remotes > 1) {
+    while (n_remotes > min_remaining) {
+	struct timeval tv;
+	struct timeval* timeout = NULL;
+	if (end_time != 0.0) {
+	    double time_left = end_time - RealTime::now();
+	    if (time_left <= 0.0) break;
+	    RealTime::to_timeval(time_left, &tv);
+	    timeout = &tv;
+	}
 	int nfds = 0;
 	FD_ZERO(&fds);
 	for (size_t i = 0; i != n_remotes; ++i) {
@@ -139,10 +166,11 @@ Matcher::for_all_remotes(Action action)
 	    if (fd >= nfds) nfds = fd + 1;
 	}
 
-	int r = select(nfds, &fds, NULL, NULL, NULL);
+	int r = select(nfds, &fds, NULL, NULL, timeout);
 	if (r <= 0) {
 	    int eno = socket_errno();
-	    // We shouldn't get a timeout, but if we do retry.
+	    // If there's no time limit we shouldn't get a timeout, but if we
+	    // do retry.  With a time limit, we check the time above.
 	    if (r == 0 || eno == EINTR || eno == EAGAIN) {
 		continue;
 	    }
@@ -164,13 +192,20 @@ Matcher::for_all_remotes(Action action)
 	}
     }
 
-    // If there's only one remote left just execute action and block if it's
-    // not ready.
-    if (n_remotes == 1) {
-	action(remotes[0].get());
+    if (end_time == 0.0) {
+	// If there's only one remote left just execute action and block if
+	// it's not ready.
+	if (n_remotes == 1) {
+	    action(remotes[0].get());
+	}
+    } else {
+	for (size_t i = 0; i != n_remotes; ++i) {
+	    timed_out(remotes[i].get());
+	}
     }
 
-    // Handle any remotes which we couldn't pass to select().
+    // Handle any remotes which we couldn't pass to select().  We've no way
+    // to wait for these with a time limit, so just block.
     for (size_t i = first_nonselectable; i != remotes.size(); ++i) {
 	action(remotes[i].get());
     }
@@ -194,12 +229,19 @@ Matcher::Matcher(const Xapian::Database& db_,
 		 Xapian::Enquire::Internal::sort_setting sort_by,
 		 bool sort_val_reverse,
 		 double time_limit,
+		 double remote_time_limit_,
 		 const vector<opt_intrusive_ptr<Xapian::MatchSpy>>& matchspies)
     : db(db_)
 {
     // An empty query should get handled higher up.
     Assert(!query.empty());
 
+#ifdef XAPIAN_HAS_REMOTE_BACKEND
+    remote_time_limit = remote_time_limit_;
+#else
+    (void)remote_time_limit_;
+#endif
+
     Xapian::doccount n_shards = db.internal->size();
     vector<Xapian::RSet> subrsets;
     if (rset && rset->internal) {
@@ -330,10 +372,33 @@ Matcher::Matcher(const Xapian::Database& db_,
     }
 
 #ifdef XAPIAN_HAS_REMOTE_BACKEND
+    auto prepare_remote = [&](RemoteSubMatch* submatch) {
+	submatch->prepare_match(stats);
+    };
     for_all_remotes(
+	prepare_remote,
+	RealTime::end_time(remote_time_limit),
 	[&](RemoteSubMatch* submatch) {
-	    submatch->prepare_match(stats);
+	    // We can't give up on a writable database, so wait for it.
+	    if (!submatch->abandon())
+		prepare_remote(submatch);
 	});
+
+    // Set aside remote shards which timed out so we don't ask them for
+    // results.  A stable partition keeps any shards we can't select() on at
+    // the end.
+    auto timed_out_begin =
+	stable_partition(remotes.begin(), remotes.end(),
+			 [](const unique_ptr<RemoteSubMatch>& submatch) {
+			     return !submatch->has_timed_out();
+			 });
+    for (auto i = timed_out_begin; i != remotes.end(); ++i) {
+	timed_out_remotes.push_back(std::move(*i));
+    }
+    remotes.erase(timed_out_begin, remotes.end());
+# ifndef HAVE_POLL
+    first_nonselectable -= timed_out_remotes.size();
+# endif
 #endif
 }
 
@@ -580,7 +645,8 @@ Matcher::get_mset(Xapian::doccount first,
     AssertRel(check_at_least, >=, first + maxitems);
 
 #ifdef XAPIAN_HAS_REMOTE_BACKEND
-    if (locals.empty() && remotes.size() == 1) {
+    double remote_end_time = RealTime::end_time(remote_time_limit);
+    if (locals.empty() && remotes.size() == 1 && remote_end_time == 0.0) {
 	// Short cut for a single remote database.
 	Assert(remotes[0]);
 	remotes[0]->start_match(first, maxitems, check_at_least, sorter,
@@ -652,7 +718,7 @@ Matcher::get_mset(Xapian::doccount first,
     }
 
 #ifdef XAPIAN_HAS_REMOTE_BACKEND
-    if (remotes.empty()) {
+    if (remotes.empty() && timed_out_remotes.empty()) {
 	// Another easy case - only local databases.
 	return local_mset;
     }
@@ -662,25 +728,52 @@ Matcher::get_mset(Xapian::doccount first,
     // than we need.
     vector<pair<Xapian::MSet, Xapian::doccount>> msets;
     Xapian::MSet merged_mset;
+    auto add_timed_out = [&](const RemoteSubMatch* submatch) {
+	// We don't know how many of this shard's documents match, so the
+	// upper bounds have to allow for all of them.
+	auto& internal = *merged_mset.internal;
+	++internal.timed_out_shards;
+	internal.matches_upper_bound += submatch->get_doccount();
+	internal.uncollapsed_upper_bound += submatch->get_doccount();
+    };
+    for (auto&& submatch : timed_out_remotes) {
+	add_timed_out(submatch.get());
+    }
+
+    auto merge_remote = [&](RemoteSubMatch* submatch) {
+	Xapian::MSet remote_mset = submatch->get_mset(matchspies);
+	merged_mset.internal->merge_stats(remote_mset.internal.get(),
+					  collapse_max != 0);
+	auto& merged_stats = merged_mset.internal->stats;
+	if (!merged_stats) {
+	    merged_stats = std::move(remote_mset.internal->stats);
+	} else {
+	    merged_stats->merge(*(remote_mset.internal->stats));
+	}
+	if (remote_mset.empty()) {
+	    return;
+	}
+	remote_mset.internal->unshard_docids(submatch->get_shard(),
+					     db.internal->size());
+	msets.push_back({remote_mset, 0});
+    };
     for_all_remotes(
+	merge_remote,
+	remote_end_time,
 	[&](RemoteSubMatch* submatch) {
-	    Xapian::MSet remote_mset = submatch->get_mset(matchspies);
-	    merged_mset.internal->merge_stats(remote_mset.internal.get(),
-					      collapse_max != 0);
-	    auto& merged_stats = merged_mset.internal->stats;
-	    if (!merged_stats) {
-		merged_stats = std::move(remote_mset.internal->stats);
+	    if (submatch->abandon()) {
+		add_timed_out(submatch);
 	    } else {
-		merged_stats->merge(*(remote_mset.internal->stats));
+		// We can't give up on a writable database, so wait for it.
+		merge_remote(submatch);
 	    }
-	    if (remote_mset.empty()) {
-		return;
-	    }
-	    remote_mset.internal->unshard_docids(submatch->get_shard(),
-						 db.internal->size());
-	    msets.push_back({remote_mset, 0});
 	});
 
+    if (!merged_mset.internal->stats) {
+	// Every remote shard timed out.
+	merged_mset.internal->stats.reset(new Xapian::Weight::Internal(stats));
+    }
+
     if (!locals.empty()) {
 	if (!local_mset.empty())
 	    msets.push_back({local_mset, 0});
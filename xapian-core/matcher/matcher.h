@@ -77,6 +77,19 @@ class Matcher {
      */
     std::vector<std::unique_ptr<RemoteSubMatch>> remotes;
 
+    /** RemoteSubMatch objects for remote databases which timed out.
+     *
+     *  Remote shards which don't return their stats before the remote time
+     *  limit are moved here from @a remotes.
+     */
+    std::vector<std::unique_ptr<RemoteSubMatch>> timed_out_remotes;
+
+    /** Time in seconds to wait for each round trip to remote shards.
+     *
+     *  0.0 means no time limit.
+     */
+    double remote_time_limit;
+
 # ifndef HAVE_POLL
     /** Partition point in @a remotes.
      *
@@ -112,6 +125,19 @@ class Matcher {
     /// Perform action on remotes as they become ready using poll() or select().
     template<typename Action> void for_all_remotes(Action action);
 
+    /** Perform action on remotes as they become ready, up to a time limit.
+     *
+     *  @param action	Called for each remote as it becomes ready.
+     *  @param end_time	Time at which to stop waiting (0.0 means wait for
+     *			all remotes).
+     *  @param timed_out	Called for each remote which isn't ready by
+     *			@a end_time.
+     */
+    template<typename Action, typename TimedOutAction>
+    void for_all_remotes(Action action,
+			 double end_time,
+			 TimedOutAction timed_out);
+
   public:
     /** Constructor.
      *
@@ -134,6 +160,8 @@ class Matcher {
      *  @param sort_val_reverse	Reverse direction keys sort in?
      *  @param time_limit	time in seconds after which to disable
      *				check_at_least (0.0 means don't).
+     *  @param remote_time_limit_ time in seconds after which to stop waiting
+     *				for remote shards (0.0 means don't).
      *  @param matchspies	MatchSpy objects to use
      */
     Matcher(const Xapian::Database& db_,
@@ -152,6 +180,7 @@ class Matcher {
 	    Xapian::Enquire::Internal::sort_setting sort_by,
 	    bool sort_val_reverse,
 	    double time_limit,
+	    double remote_time_limit_,
 	    const std::vector<opt_ptr_spy>& matchspies);
 
     /** Run the match and produce an MSet object.
@@ -43,6 +43,12 @@ class RemoteSubMatch {
     /// Index of this subdatabase.
     Xapian::doccount shard;
 
+    /// Number of documents in the remote database (set by prepare_match()).
+    Xapian::doccount doccount = 0;
+
+    /// Have we given up waiting for this remote database?
+    bool timed_out = false;
+
   public:
     /// Constructor.
     RemoteSubMatch(const RemoteDatabase* db_, Xapian::doccount shard_)
@@ -61,7 +67,7 @@ class RemoteSubMatch {
      *			added.
      */
     void prepare_match(Xapian::Weight::Internal& total_stats) {
-	db->accumulate_remote_stats(total_stats);
+	doccount = db->accumulate_remote_stats(total_stats);
     }
 
     /** Start the match.
@@ -91,6 +97,26 @@ class RemoteSubMatch {
 	return db->get_mset(matchspies);
     }
 
+    /** Give up waiting for the remote database to reply.
+     *
+     *  @return false if this isn't possible because the database is writable,
+     *		in which case the caller needs to wait for the reply.
+     */
+    bool abandon() {
+	if (!db->abandon_reply()) return false;
+	// If we timed out waiting for the stats we won't know the document
+	// count yet, but it's cached from when the database was opened.
+	if (doccount == 0) doccount = db->get_doccount();
+	timed_out = true;
+	return true;
+    }
+
+    /// Have we given up waiting for this remote database?
+    bool has_timed_out() const { return timed_out; }
+
+    /// Return the number of documents in the remote database.
+    Xapian::doccount get_doccount() const { return doccount; }
+
     /// Return the index of the corresponding Database shard.
     Xapian::doccount get_shard() const { return shard; }
 };
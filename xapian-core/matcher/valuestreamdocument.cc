@@ -65,7 +65,7 @@ ValueStreamDocument::fetch_value(Xapian::valueno slot) const
     ValueList * vl;
     if (ret.second) {
 	// Entry didn't already exist, so open a value list for slot.
-	vl = database->open_value_list(slot);
+	vl = database->open_cached_value_list(slot);
 	ret.first->second = vl;
     } else {
 	vl = ret.first->second;
@@ -25,6 +25,7 @@
 #include <xapian/error.h>
 
 #include <cerrno>
+#include <csignal>
 #include <string>
 #include <vector>
 
@@ -239,6 +240,51 @@ ProgClient::run_program(const string& progname,
 #endif
 }
 
+void
+ProgClient::reap_old_children() const
+{
+    auto i = old_children.begin();
+    while (i != old_children.end()) {
+#ifndef __WIN32__
+	if (waitpid(*i, 0, WNOHANG) == 0) {
+	    ++i;
+	    continue;
+	}
+#else
+	if (WaitForSingleObject(*i, 0) != WAIT_OBJECT_0) {
+	    ++i;
+	    continue;
+	}
+	CloseHandle(*i);
+#endif
+	i = old_children.erase(i);
+    }
+}
+
+pair<int, string>
+ProgClient::open_connection() const
+{
+    // The old child process may still be working on the request which was
+    // abandoned.  We don't want its reply, so tell it to exit, but don't wait
+    // for it to do so here.
+#ifndef __WIN32__
+    if (waitpid(child, 0, WNOHANG) == 0) {
+	kill(child, SIGTERM);
+	old_children.push_back(child);
+    }
+#else
+    if (WaitForSingleObject(child, 0) != WAIT_OBJECT_0) {
+	TerminateProcess(child, 1);
+	old_children.push_back(child);
+    } else {
+	CloseHandle(child);
+    }
+#endif
+    // Reap any earlier children which have exited since.
+    reap_old_children();
+    return run_program(progname, args, child);
+}
+
 ProgClient::~ProgClient()
 {
     // Close the pipe.
@@ -247,10 +293,19 @@ ProgClient::~ProgClient()
     } catch (...) {
     }
 
-    // Wait for the child process to exit.
+    // Wait for the child processes to exit.  Closing the pipe makes the
+    // current child exit, and any old children have already been told to
+    // exit, so this shouldn't block for long.
 #ifndef __WIN32__
     waitpid(child, 0, 0);
+    for (pid_t old_child : old_children) {
+	waitpid(old_child, 0, 0);
+    }
 #else
     WaitForSingleObject(child, INFINITE);
+    for (HANDLE old_child : old_children) {
+	WaitForSingleObject(old_child, INFINITE);
+	CloseHandle(old_child);
+    }
 #endif
 }
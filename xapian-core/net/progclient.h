@@ -21,6 +21,8 @@
 #ifndef XAPIAN_INCLUDED_PROGCLIENT_H
 #define XAPIAN_INCLUDED_PROGCLIENT_H
 
+#include <string>
+#include <vector>
 #include <sys/types.h>
 
 #include "backends/remote/remote-database.h"
@@ -40,12 +42,27 @@ class ProgClient : public RemoteDatabase {
 
 #ifndef __WIN32__
     /// Process id of the child process.
-    pid_t child;
+    mutable pid_t child;
+
+    /// Child processes from abandoned connections which haven't exited yet.
+    mutable std::vector<pid_t> old_children;
 #else
     /// HANDLE of the child process.
-    HANDLE child;
+    mutable HANDLE child;
+
+    /// Child processes from abandoned connections which haven't exited yet.
+    mutable std::vector<HANDLE> old_children;
 #endif
 
+    /// The program used to create the connection.
+    std::string progname;
+
+    /// Any arguments to the program.
+    std::string args;
+
+    /// Reap any old children which have exited.
+    void reap_old_children() const;
+
     /** Start the child process.
      *
      *  @param progname	The program used to create the connection.
@@ -70,6 +87,8 @@ class ProgClient : public RemoteDatabase {
 #endif
 						   );
 
+    std::pair<int, std::string> open_connection() const;
+
   public:
     /** Constructor.
      *
@@ -79,15 +98,17 @@ class ProgClient : public RemoteDatabase {
      *  @param writable	Is this a WritableDatabase?
      *  @param flags	Xapian::DB_RETRY_LOCK or 0.
      */
-    ProgClient(const std::string& progname,
-	       const std::string& args,
+    ProgClient(const std::string& progname_,
+	       const std::string& args_,
 	       double timeout_,
 	       bool writable,
 	       int flags)
-	: RemoteDatabase(run_program(progname, args, child),
+	: RemoteDatabase(run_program(progname_, args_, child),
 			 timeout_,
 			 writable,
-			 flags)
+			 flags),
+	  progname(progname_),
+	  args(args_)
     {}
 
     /** Destructor. */
@@ -56,6 +56,26 @@ using namespace std;
 
 #define CHUNKSIZE 4096
 
+/** Flag set in the type byte of a compressed message.
+ *
+ *  All message and reply type codes are less than this.
+ */
+#define COMPRESSED_MESSAGE 0x80
+
+/** Don't try to compress messages smaller than this.
+ *
+ *  Small messages rarely shrink by enough to be worth the CPU time.
+ */
+#define COMPRESS_THRESHOLD 1024
+
+/** Largest ratio of decompressed to compressed size we accept.
+ *
+ *  This bounds how much memory a message can make us allocate compared to
+ *  its size on the wire.  send_message() doesn't compress messages which
+ *  shrink by more than this, so we never reject a message we sent.
+ */
+#define MAX_COMPRESSION_RATIO 256
+
 [[noreturn]]
 static void
 throw_database_closed()
@@ -241,18 +261,34 @@ RemoteConnection::send_message(char type, const string &message,
     if (fdout == -1)
 	throw_database_closed();
 
+    const char* body = message.data();
+    size_t body_size = message.size();
     string header;
+    if (compress_messages && body_size >= COMPRESS_THRESHOLD) {
+	const char* compressed = compressor.compress(body, &body_size);
+	if (compressed && message.size() / MAX_COMPRESSION_RATIO < body_size) {
+	    body = compressed;
+	    type |= COMPRESSED_MESSAGE;
+	} else {
+	    // The message didn't get smaller, or shrank so much the other end
+	    // would reject it.
+	    body_size = message.size();
+	}
+    }
     header += type;
-    pack_uint(header, message.size());
+    pack_uint(header, body_size);
+
+    // We send the header and then the body.
+    const char* data = header.data();
+    size_t size = header.size();
 
 #ifdef __WIN32__
     HANDLE hout = fd_to_handle(fdout);
-    const string * str = &header;
 
     size_t count = 0;
     while (true) {
 	DWORD n;
-	BOOL ok = WriteFile(hout, str->data() + count, str->size() - count, &n, &overlapped);
+	BOOL ok = WriteFile(hout, data + count, size - count, &n, &overlapped);
 	if (!ok) {
 	    int errcode = GetLastError();
 	    if (errcode != ERROR_IO_PENDING)
@@ -275,9 +311,10 @@ RemoteConnection::send_message(char type, const string &message,
 	// We must update the offset in the OVERLAPPED structure manually.
 	update_overlapped_offset(overlapped, n);
 
-	if (count == str->size()) {
-	    if (str == &message || message.empty()) return;
-	    str = &message;
+	if (count == size) {
+	    if (data == body || body_size == 0) return;
+	    data = body;
+	    size = body_size;
 	    count = 0;
 	}
     }
@@ -288,19 +325,18 @@ RemoteConnection::send_message(char type, const string &message,
 				   context, errno);
     }
 
-    const string * str = &header;
-
     size_t count = 0;
     while (true) {
 	// We've set write to non-blocking, so just try writing as there
 	// will usually be space.
-	ssize_t n = write(fdout, str->data() + count, str->size() - count);
+	ssize_t n = write(fdout, data + count, size - count);
 
 	if (n >= 0) {
 	    count += n;
-	    if (count == str->size()) {
-		if (str == &message || message.empty()) return;
-		str = &message;
+	    if (count == size) {
+		if (data == body || body_size == 0) return;
+		data = body;
+		size = body_size;
 		count = 0;
 	    }
 	    continue;
@@ -523,7 +559,7 @@ RemoteConnection::sniff_next_message_type(double end_time)
     if (!read_at_least(1, end_time))
 	RETURN(-1);
     unsigned char type = buffer[0];
-    RETURN(type);
+    RETURN(type & ~COMPRESSED_MESSAGE);
 }
 
 int
@@ -541,8 +577,14 @@ RemoteConnection::get_message(string &result, double end_time)
     if (len < 128) {
 	if (!read_at_least(len + 2, end_time))
 	    RETURN(-1);
-	result.assign(buffer.data() + 2, len);
 	unsigned char type = buffer[0];
+	if (type & COMPRESSED_MESSAGE) {
+	    buffer.erase(0, 2);
+	    if (!get_compressed_message(result, len, end_time))
+		RETURN(-1);
+	    RETURN(type & ~COMPRESSED_MESSAGE);
+	}
+	result.assign(buffer.data() + 2, len);
 	buffer.erase(0, len + 2);
 	RETURN(type);
     }
@@ -558,14 +600,62 @@ RemoteConnection::get_message(string &result, double end_time)
 	RETURN(-1);
     }
     size_t header_len = (p - buffer.data());
+    unsigned char type = buffer[0];
+    if (type & COMPRESSED_MESSAGE) {
+	buffer.erase(0, header_len);
+	if (!get_compressed_message(result, len, end_time))
+	    RETURN(-1);
+	RETURN(type & ~COMPRESSED_MESSAGE);
+    }
     if (!read_at_least(header_len + len, end_time))
 	RETURN(-1);
     result.assign(buffer.data() + header_len, len);
-    unsigned char type = buffer[0];
     buffer.erase(0, header_len + len);
     RETURN(type);
 }
 
+bool
+RemoteConnection::get_compressed_message(string& result, size_t len,
+					 double end_time)
+{
+    LOGCALL(REMOTE, bool, "RemoteConnection::get_compressed_message", result | len | end_time);
+
+    // Decompress the data as it arrives rather than waiting for the whole
+    // message first.
+    result.resize(0);
+    compressor.decompress_start();
+    size_t max_size = len * MAX_COMPRESSION_RATIO;
+    if (rare(max_size / MAX_COMPRESSION_RATIO != len)) {
+	max_size = string::npos;
+    }
+    bool done = false;
+    while (true) {
+	size_t n = min(buffer.size(), len);
+	if (n) {
+	    if (rare(done)) {
+		// There's data after the end of the compressed stream.
+		break;
+	    }
+	    try {
+		done = compressor.decompress_chunk(buffer.data(), int(n),
+						   result, max_size);
+	    } catch (const Xapian::DatabaseError& e) {
+		throw Xapian::NetworkError("Bad compressed message received: " +
+					   e.get_msg(), context);
+	    }
+	    buffer.erase(0, n);
+	    len -= n;
+	}
+	if (len == 0) {
+	    if (rare(!done)) break;
+	    RETURN(true);
+	}
+	if (!read_at_least(1, end_time))
+	    RETURN(false);
+    }
+    throw Xapian::NetworkError("Bad compressed message received", context);
+}
+
 int
 RemoteConnection::get_message_chunked(double end_time)
 {
@@ -737,6 +827,33 @@ RemoteConnection::do_close()
     }
 }
 
+void
+RemoteConnection::reset(int fdin_, int fdout_)
+{
+    LOGCALL_VOID(REMOTE, "RemoteConnection::reset", fdin_ | fdout_);
+
+    do_close();
+    fdin = fdin_;
+    fdout = fdout_;
+    buffer.clear();
+    chunked_data_left = 0;
+    compress_messages = false;
+}
+
+int
+RemoteConnection::release()
+{
+    LOGCALL(REMOTE, int, "RemoteConnection::release", NO_ARGS);
+
+    AssertEq(fdin, fdout);
+    if (!buffer.empty()) {
+	do_close();
+    }
+    int fd = fdin;
+    fdin = fdout = -1;
+    RETURN(fd);
+}
+
 #ifdef __WIN32__
 DWORD
 RemoteConnection::calc_read_wait_msecs(double end_time)
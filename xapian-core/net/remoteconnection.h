@@ -23,6 +23,7 @@
 
 #include <string>
 
+#include "compression_stream.h"
 #include "remoteprotocol.h"
 
 #ifdef __WIN32__
@@ -64,6 +65,19 @@ class RemoteConnection {
     /// Remaining bytes of message data still to come over fdin for a chunked read.
     off_t chunked_data_left;
 
+    /** Should send_message() try to compress messages?
+     *
+     *  Compressed messages are always understood by get_message().
+     */
+    bool compress_messages = false;
+
+    /** Compresses outgoing messages and decompresses incoming ones.
+     *
+     *  We favour speed over compression ratio here so that compression
+     *  doesn't become the bottleneck on faster links.
+     */
+    CompressionStream compressor{Z_DEFAULT_STRATEGY, Z_BEST_SPEED};
+
     /** Read until there are at least min_len bytes in buffer.
      *
      *  If for some reason this isn't possible, returns false upon EOF and
@@ -78,6 +92,21 @@ class RemoteConnection {
      */
     bool read_at_least(size_t min_len, double end_time);
 
+    /** Read and decompress the contents of a compressed message.
+     *
+     *  The message header must already have been removed from buffer.
+     *
+     *  @param[out] result	Decompressed message data.
+     *  @param len		Length of the compressed data.
+     *  @param end_time	If this time is reached, then a timeout
+     *			exception will be thrown.  If (end_time == 0.0),
+     *			then keep trying indefinitely.
+     *
+     *	@return false on EOF, otherwise true.
+     */
+    bool get_compressed_message(std::string& result, size_t len,
+				double end_time);
+
 #ifdef __WIN32__
     /** On Windows we use overlapped IO.  We share an overlapped structure
      *  for both reading and writing, as we know that we always wait for
@@ -113,6 +142,15 @@ class RemoteConnection {
     /** Return the underlying fd this remote connection reads from. */
     int get_read_fd() const { return fdin; }
 
+    /** Compress large messages sent from now on.
+     *
+     *  The other end must understand compressed messages, which means
+     *  protocol version 46.1 or later for the remote backend.  They aren't
+     *  supported by get_message_chunked(), so this shouldn't be used for
+     *  replication.
+     */
+    void enable_compression() { compress_messages = true; }
+
     /** Check what the next message type is.
      *
      *  This must not be called after a call to get_message_chunked() until
@@ -230,6 +268,27 @@ class RemoteConnection {
     /** Close the connection. */
     void do_close();
 
+    /** Switch to using a new connection.
+     *
+     *  The current connection is closed, and any input we've buffered from it
+     *  is discarded.  Compression is disabled until enable_compression() is
+     *  called again.
+     *
+     *  @param fdin_	The fd to read from.
+     *  @param fdout_	The fd to write to (may be the same as @a fdin_).
+     */
+    void reset(int fdin_, int fdout_);
+
+    /** Give up ownership of the connection's fd so it can be reused.
+     *
+     *  The connection must use the same fd in both directions.  If there's
+     *  unprocessed input, the connection can't be reused so is closed
+     *  instead.
+     *
+     *  @return The fd, or -1 if the connection has been closed.
+     */
+    int release();
+
     /** Return the context to report with errors. */
     const std::string& get_context() const { return context; }
 };
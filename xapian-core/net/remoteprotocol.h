@@ -58,8 +58,9 @@
 // 44.1: pre-1.5.0 MSG_RECONSTRUCTTEXT added
 // 45: pre-1.5.0 Remote support for sorters
 // 46: 1.5.0 Drop unused fields; front-code term names in serialised stats
+// 46.1: 1.5.0 MSG_COMPRESS added; compressed messages.
 #define XAPIAN_REMOTE_PROTOCOL_MAJOR_VERSION 46
-#define XAPIAN_REMOTE_PROTOCOL_MINOR_VERSION 0
+#define XAPIAN_REMOTE_PROTOCOL_MINOR_VERSION 1
 
 /** Message types (client -> server).
  *
@@ -106,6 +107,7 @@ enum message_type {
     MSG_ADDSYNONYM,		// Add a synonym
     MSG_REMOVESYNONYM,		// Remove a synonym
     MSG_CLEARSYNONYMS,		// Clear synonyms for a term
+    MSG_COMPRESS,		// Compress large replies
     MSG_MAX
 };
 
@@ -269,6 +269,9 @@ RemoteServer::run()
 		case MSG_CLEARSYNONYMS:
 		    msg_clearsynonyms(message);
 		    continue;
+		case MSG_COMPRESS:
+		    msg_compress(message);
+		    continue;
 		default: {
 		    // MSG_GETMSET - used during a conversation.
 		    // MSG_SHUTDOWN - handled by get_message().
@@ -609,7 +612,7 @@ RemoteServer::msg_query(const string &message_in)
 		    collapse_key, collapse_max,
 		    percent_threshold, weight_threshold,
 		    order, sort_key, sort_by, sort_value_forward, time_limit,
-		    matchspies);
+		    0.0, matchspies);
 
     send_message(REPLY_STATS, serialise_stats(local_stats));
 
@@ -689,6 +692,13 @@ RemoteServer::msg_document(const string &message)
     send_message(REPLY_DONE, string());
 }
 
+void
+RemoteServer::msg_compress(const string &)
+{
+    // No reply is sent, so the client doesn't have to wait for one.
+    enable_compression();
+}
+
 void
 RemoteServer::msg_keepalive(const string &)
 {
@@ -234,6 +234,10 @@ class XAPIAN_VISIBILITY_DEFAULT RemoteServer : private RemoteConnection {
     XAPIAN_VISIBILITY_INTERNAL
     void msg_clearsynonyms(const std::string& message);
 
+    // compress large replies from now on
+    XAPIAN_VISIBILITY_INTERNAL
+    void msg_compress(const std::string& message);
+
   public:
     /** Construct a RemoteServer.
      *
@@ -24,11 +24,71 @@
 
 #include <xapian/error.h>
 
+#include "realtime.h"
+#include "socket_utils.h"
 #include "str.h"
 #include "tcpclient.h"
 
+#include <mutex>
+#include <vector>
+
 using namespace std;
 
+namespace {
+
+/// An idle connection opened with Xapian::DB_POOL_CONNECTION.
+struct PooledConnection {
+    string hostname;
+
+    int port;
+
+    double timeout;
+
+    double timeout_connect;
+
+    pair<int, string> fd_and_context;
+
+    /// When the connection was returned to the pool.
+    double idle_since;
+};
+
+}
+
+/** Idle connections opened with Xapian::DB_POOL_CONNECTION, oldest first.
+ *
+ *  A connection is removed from the pool while a RemoteTcpClient is using it,
+ *  so a connection is never shared.
+ */
+static vector<PooledConnection> pool;
+
+/// Mutex protecting pool, which is shared by all threads.
+static mutex pool_mutex;
+
+/// The maximum number of idle connections to keep in the pool.
+static const size_t POOL_MAX_IDLE = 16;
+
+/** How long an idle connection is kept in the pool (in seconds).
+ *
+ *  This is less than xapian-tcpsrv's default idle timeout, so usually we'll
+ *  drop a connection before the server gives up on it.
+ */
+static const double POOL_IDLE_TIMEOUT = 30.0;
+
+/** Close idle connections which have been in the pool for too long.
+ *
+ *  pool_mutex must be locked by the caller.
+ */
+static void
+expire_idle_connections(double now)
+{
+    auto i = pool.begin();
+    while (i != pool.end() && now - i->idle_since >= POOL_IDLE_TIMEOUT) {
+	close_fd_or_socket(i->fd_and_context.first);
+	++i;
+    }
+    pool.erase(pool.begin(), i);
+}
+
 pair<int, string>
 RemoteTcpClient::open_socket(const string& hostname, int port,
 			     double timeout_connect)
@@ -44,8 +104,71 @@ RemoteTcpClient::open_socket(const string& hostname, int port,
 	    context};
 }
 
+pair<int, string>
+RemoteTcpClient::open_connection() const
+{
+    return open_socket(hostname, port, timeout_connect);
+}
+
+RemoteTcpClient*
+RemoteTcpClient::open_pooled(const string& hostname, int port,
+			     double timeout_, double timeout_connect)
+{
+    while (true) {
+	pair<int, string> fd_and_context{-1, string()};
+	{
+	    lock_guard<mutex> lock(pool_mutex);
+	    expire_idle_connections(RealTime::now());
+	    // Check out the most recently used matching connection.
+	    auto i = pool.end();
+	    while (i != pool.begin()) {
+		--i;
+		if (i->port == port &&
+		    i->timeout == timeout_ &&
+		    i->timeout_connect == timeout_connect &&
+		    i->hostname == hostname) {
+		    fd_and_context = std::move(i->fd_and_context);
+		    pool.erase(i);
+		    break;
+		}
+	    }
+	}
+	if (fd_and_context.first < 0) break;
+	try {
+	    return new RemoteTcpClient(std::move(fd_and_context),
+				       hostname, port,
+				       timeout_, timeout_connect);
+	} catch (const Xapian::Error&) {
+	    // The connection has failed, or the server has closed it.  It gets
+	    // closed at our end when the exception unwinds, so try the next.
+	}
+    }
+
+    auto db = new RemoteTcpClient(hostname, port, timeout_, timeout_connect,
+				  false, 0);
+    db->pooled = true;
+    return db;
+}
+
 RemoteTcpClient::~RemoteTcpClient()
 {
+    if (pooled) {
+	// Check the connection back in to the pool if it's still usable.
+	auto fd_and_context = release_connection();
+	if (fd_and_context.first >= 0) {
+	    lock_guard<mutex> lock(pool_mutex);
+	    double now = RealTime::now();
+	    expire_idle_connections(now);
+	    if (pool.size() == POOL_MAX_IDLE) {
+		close_fd_or_socket(pool.front().fd_and_context.first);
+		pool.erase(pool.begin());
+	    }
+	    pool.push_back({hostname, port, timeout, timeout_connect,
+			    std::move(fd_and_context), now});
+	    return;
+	}
+    }
+
     try {
 	do_close();
     } catch (...) {
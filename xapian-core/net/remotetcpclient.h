@@ -59,6 +59,32 @@ class RemoteTcpClient : SOCKET_INITIALIZER_MIXIN public RemoteDatabase {
 						   int port,
 						   double timeout_connect);
 
+    std::pair<int, std::string> open_connection() const;
+
+    /// The host to connect to.
+    std::string hostname;
+
+    /// The port to connect to.
+    int port;
+
+    /// Timeout for trying to connect (in seconds).
+    double timeout_connect;
+
+    /// Should the connection be returned to the pool when we're destroyed?
+    bool pooled = false;
+
+    /** Constructor for reusing a connection from the pool.
+     *
+     *  @param fd_and_context	A std::pair containing the file descriptor
+     *				for the connection and its context string.
+     */
+    RemoteTcpClient(std::pair<int, std::string> fd_and_context,
+		    const std::string& hostname_, int port_,
+		    double timeout_, double timeout_connect_)
+	: RemoteDatabase(fd_and_context, timeout_, false, 0, true),
+	  hostname(hostname_), port(port_), timeout_connect(timeout_connect_),
+	  pooled(true) { }
+
   public:
     /** Constructor.
      *
@@ -71,11 +97,22 @@ class RemoteTcpClient : SOCKET_INITIALIZER_MIXIN public RemoteDatabase {
      *	@param writable		Is this a WritableDatabase?
      *	@param flags		Xapian::DB_RETRY_LOCK or 0.
      */
-    RemoteTcpClient(const std::string & hostname, int port,
-		    double timeout_, double timeout_connect, bool writable,
+    RemoteTcpClient(const std::string & hostname_, int port_,
+		    double timeout_, double timeout_connect_, bool writable,
 		    int flags)
-	: RemoteDatabase(open_socket(hostname, port, timeout_connect),
-			 timeout_, writable, flags) { }
+	: RemoteDatabase(open_socket(hostname_, port_, timeout_connect_),
+			 timeout_, writable, flags),
+	  hostname(hostname_), port(port_), timeout_connect(timeout_connect_) { }
+
+    /** Open a read-only connection, reusing an idle one if possible.
+     *
+     *  This implements Xapian::DB_POOL_CONNECTION.  A connection is taken
+     *  out of the pool while in use, and returned to it by the destructor.
+     *  The parameters are as for the constructor.
+     */
+    static RemoteTcpClient* open_pooled(const std::string& hostname, int port,
+					double timeout_,
+					double timeout_connect);
 
     /** Destructor. */
     ~RemoteTcpClient();
@@ -62,6 +62,7 @@ TermGenerator::set_document(const Xapian::Document & doc)
 {
     internal->doc = doc;
     internal->cur_pos = 0;
+    internal->prev_term.resize(0);
 }
 
 const Xapian::Document &
@@ -30,6 +30,7 @@
 #include <xapian/stem.h>
 #include <xapian/unicode.h>
 
+#include "stopwordpair.h"
 #include "stringutils.h"
 
 #include <algorithm>
@@ -60,6 +61,82 @@ check_wordchar(unsigned ch)
     return 0;
 }
 
+/** Table mapping ASCII characters to their lower case form if they're word
+ *  characters, or 0 if they aren't.
+ *
+ *  This gives the same answers as check_wordchar() for ASCII characters, but
+ *  allows us to handle runs of ASCII bytes without decoding UTF-8 or looking
+ *  up Unicode character properties.
+ */
+struct AsciiWordchars {
+    unsigned char lower[128];
+
+    constexpr AsciiWordchars() : lower() {
+	for (unsigned ch = '0'; ch <= '9'; ++ch) lower[ch] = ch;
+	for (unsigned ch = 'a'; ch <= 'z'; ++ch) lower[ch] = ch;
+	for (unsigned ch = 'A'; ch <= 'Z'; ++ch) lower[ch] = ch | 0x20;
+	lower[unsigned('_')] = '_';
+    }
+};
+
+static constexpr AsciiWordchars ascii_wordchars;
+
+/** Skip to the next word character.
+ *
+ *  @return The lower-cased word character, or 0 if the end of the text is
+ *	    reached.
+ */
+static inline unsigned
+skip_to_wordchar(Utf8Iterator& itor)
+{
+    while (itor != Utf8Iterator()) {
+	// Skip a run of ASCII non-word characters without decoding them.
+	const unsigned char* p =
+	    reinterpret_cast<const unsigned char*>(itor.raw());
+	const unsigned char* end = p + itor.left();
+	const unsigned char* q = p;
+	while (q != end && *q < 128 && !ascii_wordchars.lower[*q]) ++q;
+	if (q != p) {
+	    itor.assign(reinterpret_cast<const char*>(q), end - q);
+	    if (q == end) break;
+	}
+	unsigned ch = check_wordchar(*itor);
+	if (ch) return ch;
+	++itor;
+    }
+    return 0;
+}
+
+/** Append a run of ASCII word characters to term.
+ *
+ *  The characters appended are lower-cased and itor is advanced past them.
+ *
+ *  @return The last character appended, or 0 if there wasn't a run.
+ */
+static inline unsigned
+append_ascii_wordchars(Utf8Iterator& itor, string& term)
+{
+    const char* p = itor.raw();
+    const char* end = p + itor.left();
+    const char* q = p;
+    unsigned ch = 0;
+    while (q != end) {
+	unsigned char byte = *q;
+	if (byte >= 128 || !ascii_wordchars.lower[byte]) break;
+	ch = ascii_wordchars.lower[byte];
+	++q;
+    }
+    if (q != p) {
+	size_t old_size = term.size();
+	term.append(p, q - p);
+	for (auto i = term.begin() + old_size; i != term.end(); ++i) {
+	    *i = ascii_wordchars.lower[static_cast<unsigned char>(*i)];
+	}
+	itor.assign(q, end - q);
+    }
+    return ch;
+}
+
 static inline bool
 should_stem(const std::string & term)
 {
@@ -185,13 +262,8 @@ parse_terms(Utf8Iterator itor, unsigned break_flags, bool with_positions,
 {
     while (true) {
 	// Advance to the start of the next term.
-	unsigned ch;
-	while (true) {
-	    if (itor == Utf8Iterator()) return;
-	    ch = check_wordchar(*itor);
-	    if (ch) break;
-	    ++itor;
-	}
+	unsigned ch = skip_to_wordchar(itor);
+	if (!ch) return;
 
 	string term;
 	// Look for initials separated by '.' (e.g. P.T.O., U.N.C.L.E).
@@ -219,20 +291,22 @@ parse_terms(Utf8Iterator itor, unsigned break_flags, bool with_positions,
 	    if (break_flags && is_unbroken_wordchar(*itor)) {
 		if (!break_words(itor, break_flags, with_positions, action))
 		    return;
-		while (true) {
-		    if (itor == Utf8Iterator()) return;
-		    ch = check_wordchar(*itor);
-		    if (ch) break;
-		    ++itor;
-		}
+		ch = skip_to_wordchar(itor);
+		if (!ch) return;
 		continue;
 	    }
 	    unsigned prevch;
 	    do {
 		Unicode::append_utf8(term, ch);
 		prevch = ch;
-		if (++itor == Utf8Iterator() ||
-		    (break_flags && is_unbroken_script(*itor)))
+		if (++itor == Utf8Iterator()) goto endofterm;
+		// ASCII characters are never in unbroken scripts.
+		ch = append_ascii_wordchars(itor, term);
+		if (ch) {
+		    prevch = ch;
+		    if (itor == Utf8Iterator()) goto endofterm;
+		}
+		if (break_flags && is_unbroken_script(*itor))
 		    goto endofterm;
 		ch = check_wordchar(*itor);
 	    } while (ch);
@@ -278,6 +352,22 @@ endofterm:
     }
 }
 
+void
+TermGenerator::Internal::add_stopword_pair(const string& term,
+					   const string& word)
+{
+    bool is_stopword = (*stopper)(word);
+    if ((is_stopword || prev_is_stopword) &&
+	!prev_term.empty() && prev_pos + 1 == cur_pos) {
+	string pair = make_stopword_pair_term(prev_term, term);
+	// Add as a boolean term so the document length isn't changed.
+	if (!pair.empty()) doc.add_boolean_term(pair);
+    }
+    prev_term = term;
+    prev_pos = cur_pos;
+    prev_is_stopword = is_stopword;
+}
+
 void
 TermGenerator::Internal::index_text(Utf8Iterator itor, termcount wdf_inc,
 				    const string & prefix, bool with_positions)
@@ -300,6 +390,8 @@ TermGenerator::Internal::index_text(Utf8Iterator itor, termcount wdf_inc,
 	current_stop_mode = stop_mode;
     }
 
+    bool stopword_pairs = (flags & FLAG_STOPWORD_PAIRS) && stopper;
+
     parse_terms(itor, break_flags, with_positions,
 	[=
 #if __cplusplus >= 201907L
@@ -320,6 +412,8 @@ TermGenerator::Internal::index_text(Utf8Iterator itor, termcount wdf_inc,
 		strategy == TermGenerator::STEM_SOME_FULL_POS) {
 		if (positional) {
 		    doc.add_posting(prefix + term, ++cur_pos, wdf_inc);
+		    if (stopword_pairs)
+			add_stopword_pair(prefix + term, term);
 		} else {
 		    doc.add_term(prefix + term, wdf_inc);
 		}
@@ -354,8 +448,16 @@ TermGenerator::Internal::index_text(Utf8Iterator itor, termcount wdf_inc,
 	    stemmed_term += prefix;
 	    stemmed_term += stem;
 	    if (strategy != TermGenerator::STEM_SOME && positional) {
-		if (strategy != TermGenerator::STEM_SOME_FULL_POS) ++cur_pos;
-		doc.add_posting(stemmed_term, cur_pos, wdf_inc);
+		if (strategy != TermGenerator::STEM_SOME_FULL_POS) {
+		    ++cur_pos;
+		    doc.add_posting(stemmed_term, cur_pos, wdf_inc);
+		    // Phrase searches use the stemmed terms for STEM_ALL and
+		    // STEM_ALL_Z.
+		    if (stopword_pairs)
+			add_stopword_pair(stemmed_term, term);
+		} else {
+		    doc.add_posting(stemmed_term, cur_pos, wdf_inc);
+		}
 	    } else {
 		doc.add_term(stemmed_term, wdf_inc);
 	    }
@@ -44,6 +44,26 @@ class TermGenerator::Internal : public Xapian::Internal::intrusive_base {
     unsigned max_word_length = 64;
     WritableDatabase db;
 
+    /// The last positional term indexed, for FLAG_STOPWORD_PAIRS.
+    std::string prev_term;
+
+    /// The position of prev_term.
+    termpos prev_pos = 0;
+
+    /// Was the word prev_term was generated from a stopword?
+    bool prev_is_stopword = false;
+
+    /** Note a positional term, for FLAG_STOPWORD_PAIRS.
+     *
+     *  If this term and the previous one are adjacent and either word is a
+     *  stopword, a boolean term for the pair is added to the document.
+     *
+     *  @param term	The positional term (as used by phrase searches).
+     *  @param word	The (unstemmed) word it was generated from.
+     */
+    void add_stopword_pair(const std::string& term,
+			   const std::string& word);
+
   public:
     Internal() { }
 
@@ -408,6 +408,39 @@ DEFINE_TESTCASE(expandweights8, backend) {
     TEST_REL(eset.back().get_weight(),>=,0);
 }
 
+// Check that terms rejected early using an upper bound on their weight
+// don't change the ESet.
+DEFINE_TESTCASE(expandweights9, backend) {
+    Xapian::Enquire enquire(get_database("apitest_simpledata"));
+    enquire.set_query(Xapian::Query("paragraph"));
+
+    Xapian::MSet mymset = enquire.get_mset(0, 10);
+
+    Xapian::RSet myrset;
+    Xapian::MSetIterator i = mymset.begin();
+    myrset.add_document(*i);
+    myrset.add_document(*(++i));
+
+    for (const char* scheme : { "trad", "bo1" }) {
+	enquire.set_expansion_scheme(scheme);
+	for (int flags : { 0, int(enquire.USE_EXACT_TERMFREQ) }) {
+	    Xapian::ESet all = enquire.get_eset(1000, myrset, flags, 0, -100);
+	    Xapian::ESet top = enquire.get_eset(5, myrset, flags, 0, -100);
+	    TEST_EQUAL(top.size(), 5);
+	    TEST_EQUAL(top.get_ebound(), all.get_ebound());
+	    double min_wt = top.back().get_weight();
+	    for (Xapian::termcount j = 0; j != top.size(); ++j) {
+		TEST_EQUAL_DOUBLE(top[j].get_weight(), all[j].get_weight());
+		// Which of several terms with equal weight make it into the
+		// ESet depends on maxitems.
+		if (top[j].get_weight() > min_wt) {
+		    TEST_EQUAL(*top[j], *all[j]);
+		}
+	    }
+	}
+    }
+}
+
 // tests that when specifying maxitems to get_eset, no more than
 // that are returned.
 DEFINE_TESTCASE(expandmaxitems1, backend) {
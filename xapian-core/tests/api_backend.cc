@@ -29,7 +29,10 @@
 #include "backendmanager.h"
 #include "errno_to_string.h"
 #include "filetests.h"
+#include "net/remoteprotocol.h"
 #include "net/resolver.h"
+#include "pack.h"
+#include "realtime.h"
 #include "str.h"
 #include "socket_utils.h"
 #include "testrunner.h"
@@ -49,9 +52,12 @@
 # include "safesyswait.h"
 #endif
 
+#include <algorithm>
 #include <cerrno>
 #include <fstream>
 #include <iterator>
+#include <sstream>
+#include <vector>
 
 using namespace std;
 
@@ -1206,6 +1212,81 @@ DEFINE_TESTCASE(notermlist1, glass) {
     TEST_EXCEPTION(Xapian::FeatureUnavailableError, db.termlist_begin(1));
 }
 
+#if defined __linux__ && defined HAVE_FDATASYNC
+# include <climits>
+# include <set>
+# include <sys/syscall.h>
+
+/// If non-NULL, the leafnames of files synced by fdatasync() are added.
+static set<string>* synced_files = NULL;
+
+/** Record the files the library syncs.
+ *
+ *  The library's calls to fdatasync() resolve to this definition since it is
+ *  exported from the executable.
+ */
+extern "C" XAPIAN_VISIBILITY_DEFAULT int
+fdatasync(int fd)
+{
+    if (synced_files) {
+	string link = "/proc/self/fd/" + str(fd);
+	char buf[PATH_MAX];
+	ssize_t r = readlink(link.c_str(), buf, sizeof(buf));
+	if (r > 0) {
+	    string path(buf, r);
+	    synced_files->insert(path.substr(path.rfind('/') + 1));
+	}
+    }
+    return int(syscall(SYS_fdatasync, fd));
+}
+
+/// Record the files synced while an object of this class exists.
+class RecordSyncedFiles {
+  public:
+    set<string> files;
+
+    RecordSyncedFiles() { synced_files = &files; }
+
+    ~RecordSyncedFiles() { synced_files = NULL; }
+};
+#endif
+
+/// Check glass only syncs the tables which a commit modified.
+DEFINE_TESTCASE(syncmodifiedtables1, glass) {
+#if defined __linux__ && defined HAVE_FDATASYNC
+    Xapian::WritableDatabase db = get_writable_database();
+    Xapian::Document doc;
+    doc.add_posting("hello", 1);
+    doc.set_data("world");
+    db.add_document(doc);
+    {
+	RecordSyncedFiles record;
+	db.commit();
+	if (record.files.empty()) {
+	    SKIP_TEST("Calls to fdatasync() weren't intercepted");
+	}
+	TEST(record.files.count("postlist.glass"));
+	TEST(record.files.count("docdata.glass"));
+	TEST(record.files.count("termlist.glass"));
+	TEST(record.files.count("position.glass"));
+    }
+
+    // Setting user metadata only modifies the postlist table.
+    db.set_metadata("key", "value");
+    {
+	RecordSyncedFiles record;
+	db.commit();
+	TEST(record.files.count("postlist.glass"));
+	TEST(!record.files.count("docdata.glass"));
+	TEST(!record.files.count("termlist.glass"));
+	TEST(!record.files.count("position.glass"));
+    }
+    TEST_EQUAL(db.get_metadata("key"), "value");
+#else
+    SKIP_TEST("Test needs to intercept fdatasync(), which is Linux-specific");
+#endif
+}
+
 /// Regression test for bug starting a new glass freelist block.
 DEFINE_TESTCASE(newfreelistblock1, writable) {
     Xapian::Document doc;
@@ -1559,6 +1640,39 @@ DEFINE_TESTCASE(embedded1, singlefile) {
     }
 }
 
+/// Check Xapian::DB_CACHE_DOCLENS works for a database opened from an fd.
+DEFINE_TESTCASE(cachedoclens3, singlefile) {
+    Xapian::Database db = get_database("apitest_simpledata");
+    const string & db_path = get_database_path("apitest_simpledata");
+    const string & tmp_path = db_path + "-cachedoclens3";
+    off_t offset = 1234;
+    ofstream out(tmp_path, fstream::trunc|fstream::binary);
+    out.seekp(offset);
+    out << ifstream(db_path, fstream::binary).rdbuf();
+    out.close();
+
+    Xapian::Database db_path_cache(db_path, Xapian::DB_CACHE_DOCLENS);
+    int fd = open(tmp_path.c_str(), O_RDONLY|O_BINARY);
+    lseek(fd, offset, SEEK_SET);
+    Xapian::Database db_fd_cache(fd, Xapian::DB_CACHE_DOCLENS);
+    for (Xapian::docid did = 1; did <= db.get_lastdocid(); ++did) {
+	TEST_EQUAL(db_path_cache.get_doclength(did), db.get_doclength(did));
+	TEST_EQUAL(db_fd_cache.get_doclength(did), db.get_doclength(did));
+    }
+    Xapian::docid after_last = db.get_lastdocid() + 1;
+    TEST_EXCEPTION(Xapian::DocNotFoundError,
+		   db_fd_cache.get_doclength(after_last));
+
+    Xapian::Enquire enq(db);
+    enq.set_query(Xapian::Query("paragraph"));
+    Xapian::MSet mset = enq.get_mset(0, 10);
+    Xapian::Enquire enq_fd_cache(db_fd_cache);
+    enq_fd_cache.set_query(Xapian::Query("paragraph"));
+    Xapian::MSet mset_fd_cache = enq_fd_cache.get_mset(0, 10);
+    TEST_EQUAL(mset.size(), mset_fd_cache.size());
+    TEST(mset_range_is_same_weights(mset, 0, mset_fd_cache, 0, mset.size()));
+}
+
 /// Regression test for bug fixed in 1.3.7.
 DEFINE_TESTCASE(exactxor1, backend) {
     Xapian::Database db = get_database("apitest_simpledata");
@@ -2043,3 +2157,453 @@ DEFINE_TESTCASE(unsupportedcheck3, !backend) {
 	TEST_EQUAL(e.get_error_string(), enoent_msg);
     }
 }
+
+/// Check large messages to and from the remote server are handled correctly.
+DEFINE_TESTCASE(remotecompress1, remote) {
+    Xapian::WritableDatabase db = get_writable_database();
+    // A message which compresses to less than 128 bytes, one which compresses
+    // to more, and one which doesn't compress.
+    string random_data;
+    unsigned seed = 42;
+    for (int i = 0; i != 5000; ++i) {
+	seed = seed * 1103515245 + 12345;
+	random_data += char(seed >> 16);
+    }
+    string big_data;
+    for (int i = 0; i != 10000; ++i) {
+	big_data += str(i);
+    }
+    const string datas[] = { string(2000, 'x'), big_data, random_data };
+    for (auto&& data : datas) {
+	Xapian::Document doc;
+	doc.set_data(data);
+	for (int i = 0; i != 500; ++i) {
+	    doc.add_term("term" + str(i));
+	}
+	db.add_document(doc);
+    }
+    db.commit();
+
+    Xapian::docid did = 1;
+    for (auto&& data : datas) {
+	TEST_EQUAL(db.get_document(did).get_data(), data);
+	TEST_EQUAL(db.get_doclength(did), 500);
+	Xapian::termcount n = 0;
+	for (auto t = db.termlist_begin(did); t != db.termlist_end(did); ++t) {
+	    ++n;
+	}
+	TEST_EQUAL(n, 500);
+	++did;
+    }
+}
+
+static void
+make_remotecompress2_db(Xapian::WritableDatabase& db, const string&)
+{
+    Xapian::Document doc;
+    doc.set_data(string(5000, 'x'));
+    doc.add_term("term0");
+    db.add_document(doc);
+}
+
+/** Return the types of the remote protocol messages in @a data.
+ *
+ *  Returns an empty vector if @a data isn't a sequence of whole messages.
+ */
+static vector<unsigned char>
+remote_message_types(const string& data)
+{
+    vector<unsigned char> types;
+    const char* p = data.data();
+    const char* end = p + data.size();
+    while (p != end) {
+	unsigned char type = *p++;
+	size_t len;
+	if (!unpack_uint(&p, end, &len) || size_t(end - p) < len)
+	    return vector<unsigned char>();
+	p += len;
+	types.push_back(type);
+    }
+    return types;
+}
+
+/// Check compression is negotiated and used on the wire.
+DEFINE_TESTCASE(remotecompress2, remote && !remotetcp && !multi) {
+#ifdef __WIN32__
+    SKIP_TEST("Test uses /bin/sh and tee");
+#else
+    string path = get_database_path("remotecompress2",
+				    make_remotecompress2_db);
+    // Run the server via a script which records what's sent each way.
+    mkdir(".stub", 0755);
+    const char* script = ".stub/remotecompress2.sh";
+    const char* c2s_file = ".stub/remotecompress2.c2s";
+    const char* s2c_file = ".stub/remotecompress2.s2c";
+    {
+	ofstream out(script);
+	TEST(out.is_open());
+	out << "tee " << c2s_file << " | "
+	    << BackendManager::get_xapian_progsrv_command() << " \"$@\" | "
+	    << "tee " << s2c_file << '\n';
+    }
+    {
+	Xapian::Database db = Xapian::Remote::open("/bin/sh",
+						   string(script) +
+						   " -t300000 " + path);
+	TEST_EQUAL(db.get_document(1).get_data(), string(5000, 'x'));
+	// A query which serialises to well over the compression threshold.
+	vector<Xapian::Query> subqs;
+	for (int i = 0; i != 500; ++i) {
+	    subqs.emplace_back("term" + str(i));
+	}
+	Xapian::Enquire enq(db);
+	enq.set_query(Xapian::Query(Xapian::Query::OP_OR,
+				    subqs.begin(), subqs.end()));
+	TEST_EQUAL(enq.get_mset(0, 10).size(), 1);
+    }
+
+    auto read_file = [](const char* file) {
+	ifstream in(file, ios::binary);
+	ostringstream data;
+	data << in.rdbuf();
+	return data.str();
+    };
+    const unsigned char COMPRESSED = 0x80;
+
+    // The client should ask for compression straight away, and then send
+    // the query compressed.
+    vector<unsigned char> types = remote_message_types(read_file(c2s_file));
+    TEST(!types.empty());
+    TEST_EQUAL(int(types[0]), int(MSG_COMPRESS));
+    TEST(find(types.begin(), types.end(), MSG_QUERY | COMPRESSED) !=
+	 types.end());
+
+    // The greeting is sent before the server knows to compress, but the
+    // document data should be sent compressed.
+    types = remote_message_types(read_file(s2c_file));
+    TEST(!types.empty());
+    TEST_EQUAL(int(types[0]), int(REPLY_UPDATE));
+    TEST(find(types.begin(), types.end(), REPLY_DOCDATA | COMPRESSED) !=
+	 types.end());
+#endif
+}
+
+/// Check Enquire::set_remote_time_limit() with a generous limit.
+DEFINE_TESTCASE(remotetimelimit1, backend) {
+    Xapian::Database db = get_database("apitest_simpledata");
+    db.add_database(get_database("apitest_simpledata2"));
+    Xapian::Enquire enq(db);
+    enq.set_query(Xapian::Query("this"));
+    Xapian::MSet mset1 = enq.get_mset(0, 10);
+    TEST_EQUAL(mset1.get_timed_out_shards(), 0);
+
+    enq.set_remote_time_limit(300.0);
+    Xapian::MSet mset2 = enq.get_mset(0, 10);
+    TEST_EQUAL(mset2.get_timed_out_shards(), 0);
+    TEST_EQUAL(mset1.get_matches_lower_bound(),
+	       mset2.get_matches_lower_bound());
+    TEST_EQUAL(mset1.get_matches_upper_bound(),
+	       mset2.get_matches_upper_bound());
+    TEST(mset_range_is_same(mset1, 0, mset2, 0, mset1.size()));
+}
+
+/** Check remote shards which miss the time limit are reported.
+ *
+ *  A shard which times out is reconnected to, but the servers for the
+ *  remotetcp backend only accept one connection.
+ */
+DEFINE_TESTCASE(remotetimelimit2, remote && !remotetcp && !multi) {
+    Xapian::Database db = get_database("apitest_simpledata");
+    db.add_database(get_database("apitest_simpledata2"));
+    Xapian::Enquire enq(db);
+    enq.set_query(Xapian::Query("this"));
+    Xapian::MSet mset1 = enq.get_mset(0, 10);
+    TEST(!mset1.empty());
+
+    // The time limit will have passed before we start to wait for the
+    // results.
+    enq.set_remote_time_limit(1e-9);
+    Xapian::MSet mset2 = enq.get_mset(0, 10);
+    TEST_EQUAL(mset2.get_timed_out_shards(), 2);
+    TEST(mset2.empty());
+    TEST_EQUAL(mset2.get_matches_lower_bound(), 0);
+    TEST_REL(mset2.get_matches_upper_bound(), >=,
+	     mset1.get_matches_upper_bound());
+    TEST_EQUAL(mset2.get_matches_upper_bound(), db.get_doccount());
+
+    // Check the unread results don't cause problems for the next search.
+    enq.set_remote_time_limit(0.0);
+    Xapian::MSet mset3 = enq.get_mset(0, 10);
+    TEST_EQUAL(mset3.get_timed_out_shards(), 0);
+    TEST(mset_range_is_same(mset1, 0, mset3, 0, mset1.size()));
+}
+
+static void
+make_remotetimelimit3_db(Xapian::WritableDatabase& db, const string&)
+{
+    for (Xapian::termcount wdf = 1; wdf != 6; ++wdf) {
+	Xapian::Document doc;
+	doc.add_term("this", wdf);
+	doc.add_term("that");
+	db.add_document(doc);
+    }
+}
+
+/// Check a slow remote shard doesn't hold up the next search.
+DEFINE_TESTCASE(remotetimelimit3, remote && !remotetcp && !multi) {
+#ifdef __WIN32__
+    SKIP_TEST("Test uses /bin/sh");
+#else
+    Xapian::Database db = get_database("apitest_simpledata");
+    string path = get_database_path("remotetimelimit3",
+				    make_remotetimelimit3_db);
+    // Run the server via a script which passes on the first message from
+    // the client (MSG_COMPRESS, which is 2 bytes) and then stalls for 3
+    // seconds, so each new connection misses the time limit.  The server's
+    // output goes through a pipe too, as the server makes its output fd
+    // non-blocking which would upset cat if it were the same socket.
+    mkdir(".stub", 0755);
+    const char* script = ".stub/remotetimelimit3.sh";
+    {
+	ofstream out(script);
+	TEST(out.is_open());
+	out << "{ dd bs=1 count=2 2>/dev/null; sleep 3; cat; } | "
+	    << BackendManager::get_xapian_progsrv_command() << " \"$@\" | "
+	    << "cat\n";
+    }
+    db.add_database(Xapian::Remote::open("/bin/sh",
+					 string(script) +
+					 " -t300000 " + path));
+    Xapian::Enquire enq(db);
+    enq.set_query(Xapian::Query("this"));
+    enq.set_remote_time_limit(0.5);
+
+    // Without the slow shard's connection being reopened, the second search
+    // would have to wait for the reply to the first.
+    for (int i = 0; i != 2; ++i) {
+	double start = RealTime::now();
+	Xapian::MSet mset = enq.get_mset(0, 10);
+	double elapsed = RealTime::now() - start;
+	tout << "Search " << i + 1 << " took " << elapsed << " seconds\n";
+	TEST_EQUAL(mset.get_timed_out_shards(), 1);
+	TEST(!mset.empty());
+	TEST_REL(elapsed, <, 2.0);
+    }
+
+    // Check the slow shard still works once we wait for it.
+    enq.set_remote_time_limit(0.0);
+    Xapian::MSet mset = enq.get_mset(0, 10);
+    TEST_EQUAL(mset.get_timed_out_shards(), 0);
+
+    Xapian::Database db2 = get_database("apitest_simpledata");
+    db2.add_database(get_database("remotetimelimit3",
+				  make_remotetimelimit3_db));
+    Xapian::Enquire enq2(db2);
+    enq2.set_query(Xapian::Query("this"));
+    Xapian::MSet mset2 = enq2.get_mset(0, 10);
+    TEST_EQUAL(mset.size(), mset2.size());
+    TEST(mset_range_is_same(mset, 0, mset2, 0, mset2.size()));
+#endif
+}
+
+/// Check Xapian::DB_POOL_CONNECTION.
+DEFINE_TESTCASE(remotepool1, remotetcp && !multi) {
+    int port;
+    Xapian::Database db = get_pooled_remote_database("apitest_simpledata",
+						     &port);
+    Xapian::doccount doccount = db.get_doccount();
+    auto open_pooled = [&]() {
+	return Xapian::Remote::open("127.0.0.1", port, 2000, 10000,
+				    Xapian::DB_POOL_CONNECTION);
+    };
+
+    // The server only accepts one connection, so while the pooled connection
+    // is in use we can't open another.
+    TEST_EXCEPTION_BASE_CLASS(Xapian::NetworkError, open_pooled());
+
+    // Once it's idle it should get reused.
+    db = Xapian::Database();
+    db = open_pooled();
+    TEST_EQUAL(db.get_doccount(), doccount);
+    {
+	Xapian::Enquire enq(db);
+	enq.set_query(Xapian::Query("this"));
+	TEST(!enq.get_mset(0, 10).empty());
+    }
+
+    // A connection with different timeouts shouldn't be reused.
+    db = Xapian::Database();
+    TEST_EXCEPTION_BASE_CLASS(Xapian::NetworkError,
+			      Xapian::Remote::open("127.0.0.1", port,
+						   3000, 10000,
+						   Xapian::DB_POOL_CONNECTION));
+
+    // A closed connection shouldn't be reused.
+    db = open_pooled();
+    db.close();
+    db = Xapian::Database();
+    TEST_EXCEPTION_BASE_CLASS(Xapian::NetworkError, open_pooled());
+
+    // Nor should one which was abandoned part way through a search.
+    db = get_pooled_remote_database("apitest_simpledata", &port);
+    {
+	Xapian::Database both;
+	both.add_database(db);
+	both.add_database(get_database("apitest_simpledata"));
+	Xapian::Enquire enq(both);
+	enq.set_query(Xapian::Query("this"));
+	enq.set_remote_time_limit(1e-9);
+	TEST_EQUAL(enq.get_mset(0, 10).get_timed_out_shards(), 2);
+    }
+    db = Xapian::Database();
+    TEST_EXCEPTION_BASE_CLASS(Xapian::NetworkError, open_pooled());
+}
+
+static void
+make_uniqueterms1_db(Xapian::WritableDatabase &db, const string &)
+{
+    // Lots of keys sharing their initial byte, as is typical for a boolean
+    // prefix used for unique ids, so honey uses a binary chop index.
+    for (unsigned i = 0; i < 5000; ++i) {
+	Xapian::Document doc;
+	doc.add_boolean_term("Q" + str(10000 + i * 3));
+	doc.add_term("all");
+	db.add_document(doc);
+    }
+}
+
+/// Check lookups in a table whose keys mostly share their first byte.
+DEFINE_TESTCASE(uniqueterms1, backend) {
+    Xapian::Database db = get_database("uniqueterms1", make_uniqueterms1_db);
+    TEST_EQUAL(db.get_doccount(), 5000);
+    // Look up in a scattered order so the index has to be used to jump both
+    // forwards and backwards.
+    for (unsigned i = 0; i < 5000; ++i) {
+	unsigned j = (i * 1237) % 5000;
+	string term = "Q" + str(10000 + j * 3);
+	TEST_EQUAL(db.get_termfreq(term), 1);
+	Xapian::PostingIterator p = db.postlist_begin(term);
+	TEST(p != db.postlist_end(term));
+	TEST_EQUAL(*p, j + 1);
+	TEST_EQUAL(db.get_termfreq(term + "0"), 0);
+	TEST_EQUAL(db.get_termfreq("Q" + str(10001 + j * 3)), 0);
+    }
+    TEST_EQUAL(db.get_termfreq("Q"), 0);
+    TEST_EQUAL(db.get_termfreq("Q0"), 0);
+    TEST_EQUAL(db.get_termfreq("Q99999"), 0);
+    TEST_EQUAL(db.get_termfreq("all"), 5000);
+
+    Xapian::TermIterator t = db.allterms_begin("Q");
+    t.skip_to("Q12000");
+    TEST(t != db.allterms_end("Q"));
+    TEST_EQUAL(*t, "Q12001");
+    t.skip_to("Q24996");
+    TEST(t != db.allterms_end("Q"));
+    TEST_EQUAL(*t, "Q24997");
+    ++t;
+    TEST(t == db.allterms_end("Q"));
+
+    Xapian::termcount count = 0;
+    for (t = db.allterms_begin("Q1"); t != db.allterms_end("Q1"); ++t) {
+	++count;
+    }
+    TEST_EQUAL(count, 3334);
+}
+
+static void
+make_andreorder1_db(Xapian::WritableDatabase &db, const string &)
+{
+    // Nearly all documents have value "b" in slot 0, but the bounds are
+    // much wider, so the termfreq estimate for a value range matching "b" is
+    // far too low and that value range is initially used to lead the AND.
+    for (unsigned i = 1; i <= 5000; ++i) {
+	Xapian::Document doc;
+	if (i == 1) {
+	    doc.add_value(0, "a");
+	} else if (i == 5000) {
+	    doc.add_value(0, "z");
+	} else {
+	    doc.add_value(0, "b");
+	}
+	if (i % 8 == 0) doc.add_term("rare");
+	if (i % 3 != 0) doc.add_term("common");
+	db.add_document(doc);
+    }
+}
+
+/// Check AND gives the right results when it reorders its subqueries.
+DEFINE_TESTCASE(andreorder1, backend) {
+    Xapian::Database db = get_database("andreorder1", make_andreorder1_db);
+    Xapian::Enquire enquire(db);
+    Xapian::Query query(Xapian::Query::OP_FILTER,
+			Xapian::Query(Xapian::Query::OP_AND,
+				      Xapian::Query("common"),
+				      Xapian::Query("rare")),
+			Xapian::Query(Xapian::Query::OP_VALUE_RANGE, 0,
+				      "b", "b"));
+    enquire.set_query(query);
+    enquire.set_weighting_scheme(Xapian::BoolWeight());
+    Xapian::MSet mset = enquire.get_mset(0, db.get_doccount());
+    vector<Xapian::docid> expected;
+    for (Xapian::docid did = 8; did < 5000; did += 8) {
+	if (did % 3 != 0) expected.push_back(did);
+    }
+    TEST_EQUAL(mset.size(), expected.size());
+    vector<Xapian::docid> actual(mset.begin(), mset.end());
+    sort(actual.begin(), actual.end());
+    TEST(actual == expected);
+}
+
+static void
+make_msetfetch1_db(Xapian::WritableDatabase &db, const string &)
+{
+    for (unsigned i = 1; i <= 100; ++i) {
+	Xapian::Document doc;
+	doc.set_data("doc " + str(i));
+	if (i % 2 == 0) doc.add_value(0, str(i));
+	doc.add_value(1, str(1000 - i));
+	doc.add_value(2, "x");
+	doc.add_term("all");
+	doc.add_term("Q" + str(i));
+	db.add_document(doc);
+    }
+}
+
+/// Check MSet::fetch() caches the right documents and values.
+DEFINE_TESTCASE(msetfetch1, backend) {
+    Xapian::Database db = get_database("msetfetch1", make_msetfetch1_db);
+    Xapian::Enquire enquire(db);
+    enquire.set_query(Xapian::Query("all"));
+    // Sort so the MSet isn't in docid order.
+    enquire.set_sort_by_value(1, false);
+    Xapian::MSet mset = enquire.get_mset(0, 100);
+    TEST_EQUAL(mset.size(), 100);
+
+    auto check = [&](Xapian::MSetIterator i) {
+	Xapian::Document doc = i.get_document();
+	Xapian::Document expected = db.get_document(*i);
+	TEST_EQUAL(doc.get_docid(), expected.get_docid());
+	TEST_EQUAL(doc.get_data(), expected.get_data());
+	for (Xapian::valueno slot = 0; slot != 4; ++slot) {
+	    TEST_EQUAL(doc.get_value(slot), expected.get_value(slot));
+	}
+	TEST_EQUAL(doc.values_count(), expected.values_count());
+	TEST_EQUAL(doc.termlist_count(), 2);
+	TEST_EQUAL(*doc.termlist_begin(), "Q" + str(*i));
+    };
+
+    mset.fetch(mset[10], mset[30], {0, 3});
+    for (Xapian::doccount n = 0; n != 40; ++n) {
+	check(mset[n]);
+    }
+
+    mset.fetch(mset[95]);
+    mset.fetch({2});
+    for (auto i = mset.begin(); i != mset.end(); ++i) {
+	check(i);
+    }
+
+    // An empty range shouldn't fetch anything.
+    mset.fetch(mset[50], mset[50]);
+    mset.fetch(mset.end(), mset.end());
+}
@@ -25,6 +25,9 @@
 
 #include <xapian.h>
 
+#include <map>
+#include <string>
+
 #include "apitest.h"
 #include "testsuite.h"
 #include "testutils.h"
@@ -153,6 +156,37 @@ DEFINE_TESTCASE(round_robin1, backend)
     }
 }
 
+/** KMeans Test
+ *  Test that each document ends up in exactly one cluster, and that each
+ *  cluster's centroid is consistent with the documents in it.
+ */
+DEFINE_TESTCASE(kmeans1, backend)
+{
+    Xapian::Database db = get_database("stemmed_cluster", make_stemmed_cluster_db);
+    Xapian::Enquire enq(db);
+    enq.set_query(Xapian::Query("cluster"));
+    Xapian::MSet matches = enq.get_mset(0, 4);
+
+    Xapian::KMeans kmeans(2);
+    Xapian::ClusterSet cset = kmeans.cluster(matches);
+    TEST_EQUAL(cset.size(), 2);
+    std::map<std::string, int> seen;
+    Xapian::CosineDistance d;
+    for (Xapian::doccount i = 0; i < cset.size(); ++i) {
+	Xapian::DocumentSet docs = cset[i].get_documents();
+	for (Xapian::doccount j = 0; j < docs.size(); ++j) {
+	    ++seen[docs[j].get_data()];
+	}
+	if (docs.size() == 1) {
+	    // The centroid of a single point is that point.
+	    TEST_EQUAL(d.similarity(cset[i][0], cset[i].get_centroid()), 0);
+	}
+    }
+    for (Xapian::MSetIterator m = matches.begin(); m != matches.end(); ++m) {
+	TEST_EQUAL(seen[m.get_document().get_data()], 1);
+    }
+}
+
 DEFINE_TESTCASE(stem_stopper1, !backend)
 {
     Xapian::Stem stemmer("english");
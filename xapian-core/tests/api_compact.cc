@@ -726,3 +726,88 @@ DEFINE_TESTCASE(compact1, compact && writable) {
 
     TEST_EQUAL(Xapian::Database(output).get_doccount(), 3);
 }
+
+/// Check DBCOMPACT_TERM_DICTIONARY gives the same answers.
+DEFINE_TESTCASE(compacttermdict1, compact) {
+    Xapian::Database indb(get_database("apitest_simpledata"));
+
+    string plain = get_compaction_output_path("compacttermdict1-plain");
+    rm_rf(plain);
+    indb.compact(plain, Xapian::DB_BACKEND_HONEY);
+
+    string dict = get_compaction_output_path("compacttermdict1-dict");
+    rm_rf(dict);
+    indb.compact(dict,
+		 Xapian::DB_BACKEND_HONEY | Xapian::DBCOMPACT_TERM_DICTIONARY);
+
+    string single = get_compaction_output_path("compacttermdict1-single");
+    rm_rf(single);
+    indb.compact(single,
+		 Xapian::DB_BACKEND_HONEY | Xapian::DBCOMPACT_TERM_DICTIONARY |
+		 Xapian::DBCOMPACT_SINGLE_FILE);
+
+    Xapian::Database plaindb(plain);
+    for (const string& path : { dict, single }) {
+	Xapian::Database db(path);
+	tout << path << '\n';
+
+	Xapian::TermIterator t = db.allterms_begin();
+	Xapian::TermIterator t_plain = plaindb.allterms_begin();
+	while (t_plain != plaindb.allterms_end()) {
+	    TEST(t != db.allterms_end());
+	    const string& term = *t_plain;
+	    TEST_EQUAL(*t, term);
+	    TEST_EQUAL(t.get_termfreq(), t_plain.get_termfreq());
+	    TEST(db.term_exists(term));
+	    TEST_EQUAL(db.get_termfreq(term), plaindb.get_termfreq(term));
+	    TEST_EQUAL(db.get_collection_freq(term),
+		       plaindb.get_collection_freq(term));
+	    // Check a term which sorts just after this one isn't found.
+	    string missing = term + '\0';
+	    TEST(!db.term_exists(missing));
+	    TEST_EQUAL(db.get_termfreq(missing), 0);
+	    TEST_EQUAL(db.get_collection_freq(missing), 0);
+	    TEST(db.postlist_begin(missing) == db.postlist_end(missing));
+	    ++t;
+	    ++t_plain;
+	}
+	TEST(t == db.allterms_end());
+	TEST(!db.term_exists("\x01"));
+	TEST(!db.term_exists("\xff\xff"));
+
+	// Check prefix restriction and skip_to().
+	for (const char* prefix : { "", "t", "th", "this", "zzz" }) {
+	    t = db.allterms_begin(prefix);
+	    t_plain = plaindb.allterms_begin(prefix);
+	    while (t_plain != plaindb.allterms_end(prefix)) {
+		TEST(t != db.allterms_end(prefix));
+		TEST_EQUAL(*t, *t_plain);
+		++t;
+		++t_plain;
+	    }
+	    TEST(t == db.allterms_end(prefix));
+	}
+	t = db.allterms_begin("t");
+	t_plain = plaindb.allterms_begin("t");
+	t.skip_to("th");
+	t_plain.skip_to("th");
+	TEST(t_plain != plaindb.allterms_end("t"));
+	TEST_EQUAL(*t, *t_plain);
+	t.skip_to("u");
+	TEST(t == db.allterms_end("t"));
+
+	// Check wildcard expansion and weights match.
+	Xapian::Query query(Xapian::Query::OP_OR,
+			    Xapian::Query(Xapian::Query::OP_WILDCARD, "th"),
+			    Xapian::Query("simpl"));
+	Xapian::Enquire enquire(db);
+	enquire.set_query(query);
+	Xapian::MSet mset = enquire.get_mset(0, 20);
+	Xapian::Enquire enquire_plain(plaindb);
+	enquire_plain.set_query(query);
+	Xapian::MSet mset_plain = enquire_plain.get_mset(0, 20);
+	TEST_EQUAL(mset.size(), mset_plain.size());
+	TEST(mset_range_is_same(mset, 0, mset_plain, 0, mset_plain.size()));
+	TEST_EQUAL(mset.get_max_possible(), mset_plain.get_max_possible());
+    }
+}
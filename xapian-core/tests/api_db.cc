@@ -1506,6 +1506,69 @@ DEFINE_TESTCASE(glassdatabaseopen1, glass) {
 #endif
 }
 
+/// Test Xapian::DB_CACHE_DOCLENS.
+DEFINE_TESTCASE(cachedoclens1, glass) {
+    Xapian::WritableDatabase wdb =
+	get_named_writable_database("cachedoclens1");
+    Xapian::Document doc;
+    doc.add_term("foo", 3);
+    wdb.add_document(doc);
+    wdb.add_document(Xapian::Document());
+    doc.add_term("bar", 297);
+    wdb.replace_document(5, doc);
+    wdb.commit();
+
+    string path = get_named_writable_database_path("cachedoclens1");
+    Xapian::Database db(path, Xapian::DB_CACHE_DOCLENS);
+    TEST_EQUAL(db.get_doclength(1), 3);
+    TEST_EQUAL(db.get_doclength(2), 0);
+    TEST_EQUAL(db.get_doclength(5), 300);
+    TEST_EXCEPTION(Xapian::DocNotFoundError, db.get_doclength(3));
+    TEST_EXCEPTION(Xapian::DocNotFoundError, db.get_doclength(6));
+
+    // Check weights match those calculated without the cache.
+    Xapian::Enquire enq(db);
+    enq.set_query(Xapian::Query("foo"));
+    Xapian::MSet mset = enq.get_mset(0, 10);
+    Xapian::Enquire enq_nocache{Xapian::Database(path)};
+    enq_nocache.set_query(Xapian::Query("foo"));
+    Xapian::MSet mset_nocache = enq_nocache.get_mset(0, 10);
+    TEST_EQUAL(mset.size(), 2);
+    TEST(mset_range_is_same_weights(mset, 0, mset_nocache, 0, 2));
+
+    // The cache should be reread when we move to a new revision.
+    doc.add_term("baz", 100000);
+    wdb.add_document(doc);
+    wdb.delete_document(1);
+    wdb.commit();
+    TEST(db.reopen());
+    TEST_EQUAL(db.get_doclength(6), 100300);
+    TEST_EQUAL(db.get_doclength(5), 300);
+    TEST_EXCEPTION(Xapian::DocNotFoundError, db.get_doclength(1));
+}
+
+/// Test Xapian::DB_CACHE_DOCLENS with sparse document ids.
+DEFINE_TESTCASE(cachedoclens2, glass) {
+    Xapian::WritableDatabase wdb =
+	get_named_writable_database("cachedoclens2");
+    Xapian::Document doc;
+    doc.add_term("foo", 3);
+    wdb.add_document(doc);
+    // A cache covering this range would need 4GB, so the lengths shouldn't
+    // be cached, but looking them up should still work.
+    const Xapian::docid big_did = 0xfffffff0;
+    doc.add_term("bar", 4);
+    wdb.replace_document(big_did, doc);
+    wdb.commit();
+
+    string path = get_named_writable_database_path("cachedoclens2");
+    Xapian::Database db(path, Xapian::DB_CACHE_DOCLENS);
+    TEST_EQUAL(db.get_doclength(1), 3);
+    TEST_EQUAL(db.get_doclength(big_did), 7);
+    TEST_EXCEPTION(Xapian::DocNotFoundError, db.get_doclength(2));
+    TEST_EXCEPTION(Xapian::DocNotFoundError, db.get_doclength(big_did + 1));
+}
+
 // feature test for Enquire:
 // set_sort_by_value
 // set_sort_by_value_then_relevance
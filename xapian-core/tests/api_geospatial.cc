@@ -421,3 +421,102 @@ DEFINE_TESTCASE(latlongkeymaker1, !backend) {
     TEST_EQUAL(k3, k3b);
     TEST_REL(k3b, >, k4b);
 }
+
+/// Test LatLongCells::geohash() and LatLongCells::index().
+DEFINE_TESTCASE(latlongcells1, !backend) {
+    LatLongCoord c1(57.64911, 10.40744);
+    TEST_EQUAL(LatLongCells::geohash(c1, 11), "u4pruydqqvj");
+    TEST_EQUAL(LatLongCells::geohash(c1, 1), "u");
+    // Longitudes are stored in the range [0, 360).
+    LatLongCoord c2(-25.382708, -49.265506);
+    TEST_EQUAL(LatLongCells::geohash(c2, 12), "6gkzwgjzn820");
+    TEST_EQUAL(LatLongCells::geohash(LatLongCoord(90, 179.9), 2), "zz");
+    // Longitude 180 is the same as -180.
+    TEST_EQUAL(LatLongCells::geohash(LatLongCoord(90, 180), 2), "bp");
+    TEST_EQUAL(LatLongCells::geohash(LatLongCoord(-90, -180), 2), "00");
+
+    TEST_EXCEPTION(Xapian::InvalidArgumentError,
+		   LatLongCells::geohash(c1, 0));
+    TEST_EXCEPTION(Xapian::InvalidArgumentError,
+		   LatLongCells::geohash(c1, 13));
+    TEST_EXCEPTION(Xapian::InvalidArgumentError, LatLongCells("XG", 0));
+    TEST_EXCEPTION(Xapian::InvalidArgumentError, LatLongCells("XG", 13));
+
+    LatLongCells cells("XG", 3);
+    Xapian::Document doc;
+    LatLongCoords coords(c1);
+    coords.append(c2);
+    cells.index(doc, coords);
+    string terms;
+    for (auto t = doc.termlist_begin(); t != doc.termlist_end(); ++t) {
+	terms += *t;
+	terms += ' ';
+    }
+    TEST_STRINGS_EQUAL(terms, "XG6 XG6g XG6gk XGu XGu4 XGu4p ");
+}
+
+static void
+builddb_coords2(Xapian::WritableDatabase &db, const string &)
+{
+    LatLongCells cells("XG");
+    // Use a simple LCG so the coordinates are the same every time.
+    unsigned seed = 42;
+    auto rnd = [&seed]() {
+	seed = seed * 1103515245 + 12345;
+	return ((seed >> 8) & 0xffff) / 65536.0;
+    };
+    for (int i = 0; i != 1000; ++i) {
+	LatLongCoords coords;
+	if (i % 4 == 0) {
+	    // Cluster some points around the centres used by latlongcells2.
+	    static const double centres[][2] = {
+		{ 51.5, -0.1 }, { 0.0, 179.9 }, { 89.9, 0 }, { -33.9, 151.2 }
+	    };
+	    const double* c = centres[(i / 4) % 4];
+	    double lat = max(-90.0, min(90.0, c[0] + (rnd() - 0.5) * 0.4));
+	    coords.append(LatLongCoord(lat, c[1] + (rnd() - 0.5) * 0.4));
+	} else {
+	    coords.append(LatLongCoord(rnd() * 180 - 90, rnd() * 360 - 180));
+	}
+	Xapian::Document doc;
+	doc.add_value(0, coords.serialise());
+	cells.index(doc, coords);
+	db.add_document(doc);
+    }
+}
+
+/// Check LatLongCells::get_query() doesn't exclude any documents in range.
+DEFINE_TESTCASE(latlongcells2, backend && !remote && !inmemory) {
+    Xapian::Database db = get_database("coords2", builddb_coords2, "");
+    LatLongCells cells("XG");
+    Xapian::Enquire enquire(db);
+    static const double centres[][2] = {
+	{ 51.5, -0.1 }, { 0.0, 179.9 }, { 89.9, 0 }, { -33.9, 151.2 },
+	{ 0, 0 }
+    };
+    static const double ranges[] = { 0, 100, 5000, 20000, 1e6, 3e7 };
+    for (auto&& c : centres) {
+	LatLongCoord centre(c[0], c[1]);
+	for (double max_range : ranges) {
+	    tout << centre.get_description() << " " << max_range << '\n';
+	    LatLongDistancePostingSource ps(0, centre, max_range);
+	    enquire.set_query(Xapian::Query(&ps));
+	    Xapian::MSet mset1 = enquire.get_mset(0, db.get_doccount());
+
+	    Xapian::Query cell_query = cells.get_query(centre, max_range);
+	    enquire.set_query(Xapian::Query(Xapian::Query::OP_FILTER,
+					    Xapian::Query(&ps),
+					    cell_query));
+	    Xapian::MSet mset2 = enquire.get_mset(0, db.get_doccount());
+	    TEST(mset_range_is_same(mset1, 0, mset2, 0, mset1.size()));
+	    TEST_EQUAL(mset1.size(), mset2.size());
+
+	    if (max_range > 0 && max_range <= 20000) {
+		// The cells should exclude most of the documents.
+		enquire.set_query(cell_query);
+		Xapian::MSet mset3 = enquire.get_mset(0, 0);
+		TEST_REL(mset3.get_matches_upper_bound(), <, 100);
+	    }
+	}
+    }
+}
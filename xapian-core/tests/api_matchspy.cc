@@ -169,6 +169,22 @@ DEFINE_TESTCASE(matchspy2, backend)
     TEST_STRINGS_EQUAL(values_to_repr(spy0), results[0]);
     TEST_STRINGS_EQUAL(values_to_repr(spy1), results[1]);
     TEST_STRINGS_EQUAL(values_to_repr(spy3), results[2]);
+
+    // Check that further counts are added to those already read back.
+    mset = enq.get_mset(0, 10);
+
+    TEST_EQUAL(spy0.get_total(), 50);
+    TEST_EQUAL(spy1.get_total(), 50);
+    TEST_EQUAL(spy3.get_total(), 50);
+
+    static const char * const results2[] = {
+	"|1:2|2:18|3:6|4:14|5:2|6:6|8:2|",
+	"|0:4|1:6|2:6|3:6|4:6|5:6|6:4|7:4|8:4|9:4|",
+	"|1:18|2:32|",
+    };
+    TEST_STRINGS_EQUAL(values_to_repr(spy0), results2[0]);
+    TEST_STRINGS_EQUAL(values_to_repr(spy1), results2[1]);
+    TEST_STRINGS_EQUAL(values_to_repr(spy3), results2[2]);
 }
 
 DEFINE_TESTCASE(matchspy4, backend)
@@ -27,7 +27,10 @@
 
 #include <xapian.h>
 
+#include <cmath>
+#include <memory>
 #include <string>
+#include <vector>
 #include "safeunistd.h"
 
 #include "str.h"
@@ -895,3 +898,287 @@ DEFINE_TESTCASE(estimaterounding1, backend && !multi && !remote) {
 	TEST_EQUAL(mset.get_matches_estimated(), t.exp);
     }
 }
+
+static void
+make_vectorsource1_db(Xapian::WritableDatabase &db, const string &)
+{
+    // Documents 1 to 20 have unit vectors at increasing angles from (1,0,0).
+    for (int i = 1; i <= 20; ++i) {
+	double angle = i * M_PI / 40;
+	vector<float> v = { float(cos(angle)), float(sin(angle)), 0.0f };
+	Xapian::Document doc;
+	doc.add_term(i % 2 ? "odd" : "even");
+	// Scaling the vector shouldn't affect the similarity.
+	if (i % 3 == 0) {
+	    for (float& x : v) x *= 7.0f;
+	}
+	doc.add_value(1, Xapian::VectorPostingSource::serialise_vector(v));
+	db.add_document(doc);
+    }
+    // Wrong number of dimensions.
+    Xapian::Document doc;
+    doc.add_term("odd");
+    doc.add_value(1, Xapian::VectorPostingSource::serialise_vector({1, 0}));
+    db.add_document(doc);
+    // All zeros.
+    doc.add_value(1, Xapian::VectorPostingSource::serialise_vector({0, 0, 0}));
+    db.add_document(doc);
+    // No vector.
+    doc.remove_value(1);
+    db.add_document(doc);
+}
+
+// Test VectorPostingSource.
+DEFINE_TESTCASE(vectorsource1, backend) {
+    Xapian::Database db = get_database("vectorsource1",
+				       make_vectorsource1_db);
+    Xapian::Enquire enq(db);
+
+    Xapian::VectorPostingSource src(1, { 2.0f, 0.0f, 0.0f });
+    enq.set_query(Xapian::Query(&src));
+    Xapian::MSet mset = enq.get_mset(0, 30);
+    TEST_EQUAL(mset.size(), 20);
+    // Cosine similarity can't exceed 1.
+    TEST_EQUAL_DOUBLE(mset.get_max_possible(), 1.0);
+    Xapian::docid expect = 1;
+    for (auto i = mset.begin(); i != mset.end(); ++i) {
+	TEST_EQUAL(*i, expect);
+	// The vectors are stored as floats so only expect float precision.
+	TEST_REL(fabs(i.get_weight() - cos(expect * M_PI / 40)), <, 1e-6);
+	++expect;
+    }
+
+    // Check min_similarity.  cos(i * pi / 40) >= 0.5 for i <= 13.
+    Xapian::VectorPostingSource src2(1, { 1.0f, 0.0f, 0.0f }, 0.5);
+    enq.set_query(Xapian::Query(&src2));
+    mset = enq.get_mset(0, 30);
+    TEST_EQUAL(mset.size(), 13);
+    TEST_EQUAL(*mset[12], 13);
+
+    // Check combining with a text query.  Every document matching "even" has
+    // the same text weight, so the vector similarity decides the order.
+    Xapian::Query q(Xapian::Query::OP_AND_MAYBE,
+		    Xapian::Query("even"),
+		    Xapian::Query(&src));
+    enq.set_query(q);
+    mset = enq.get_mset(0, 5);
+    mset_expect_order(mset, 2, 4, 6, 8, 10);
+
+    // With OP_OR, the top documents should match both.
+    q = Xapian::Query(Xapian::Query::OP_OR,
+		      Xapian::Query("even"),
+		      Xapian::Query(&src));
+    enq.set_query(q);
+    mset = enq.get_mset(0, 3);
+    mset_expect_order(mset, 2, 4, 6);
+
+    // Check a query vector pointing the other way matches nothing.
+    Xapian::VectorPostingSource src3(1, { -1.0f, -1.0f, 0.0f });
+    enq.set_query(Xapian::Query(&src3));
+    mset = enq.get_mset(0, 30);
+    TEST_EQUAL(mset.size(), 0);
+}
+
+// Test VectorPostingSource serialisation and parameter checking.
+DEFINE_TESTCASE(vectorsource2, !backend) {
+    vector<float> v = { 1.5f, -2.25f, 0.0f, 1e30f };
+    string s = Xapian::VectorPostingSource::serialise_vector(v);
+    TEST_EQUAL(s.size(), 16);
+    TEST(Xapian::VectorPostingSource::unserialise_vector(s) == v);
+    TEST_EXCEPTION(Xapian::SerialisationError,
+	Xapian::VectorPostingSource::unserialise_vector("abc"));
+
+    Xapian::VectorPostingSource src(3, v, 0.25);
+    Xapian::Registry reg;
+    const Xapian::PostingSource* ps =
+	reg.get_posting_source("Xapian::VectorPostingSource");
+    TEST(ps);
+    unique_ptr<Xapian::PostingSource> src2(ps->unserialise(src.serialise()));
+    TEST_EQUAL(src2->get_description(), src.get_description());
+    TEST_EQUAL(src2->serialise(), src.serialise());
+
+    TEST_EXCEPTION(Xapian::InvalidArgumentError,
+	Xapian::VectorPostingSource(0, vector<float>()));
+    TEST_EXCEPTION(Xapian::InvalidArgumentError,
+	Xapian::VectorPostingSource(0, { 0.0f, 0.0f }));
+    TEST_EXCEPTION(Xapian::InvalidArgumentError,
+	Xapian::VectorPostingSource(0, { 1.0f }, -0.5));
+    TEST_EXCEPTION(Xapian::InvalidArgumentError,
+	Xapian::VectorPostingSource(0, { 1.0f }, 1.5));
+}
+
+static void
+make_vectorindex1_db(Xapian::WritableDatabase &db, const string &)
+{
+    // Four groups of vectors, each close to a different axis.
+    for (int i = 0; i != 80; ++i) {
+	vector<float> v(4);
+	for (int j = 0; j != 4; ++j) {
+	    v[j] = float(((i * (j + 3)) % 7 - 3) * 0.03);
+	}
+	v[i % 4] = 1.0f;
+	Xapian::Document doc;
+	doc.add_term(i % 2 ? "odd" : "even");
+	doc.add_value(1, Xapian::VectorPostingSource::serialise_vector(v));
+	db.add_document(doc);
+    }
+    // No vector.
+    Xapian::Document doc;
+    doc.add_term("odd");
+    db.add_document(doc);
+
+    Xapian::VectorIndex index(db, "XV");
+    index.build(db, 1, 4);
+}
+
+// Test VectorPostingSource with a VectorIndex.
+DEFINE_TESTCASE(vectorindex1, backend) {
+    Xapian::Database db = get_database("vectorindex1",
+				       make_vectorindex1_db);
+    Xapian::VectorIndex index(db, "XV");
+    TEST_EQUAL(index.get_num_clusters(), 4);
+    TEST_EQUAL(index.get_dimensions(), 4);
+    TEST_EQUAL(index.get_slot(), 1);
+    // Each group should be a cluster, whatever order the documents are in.
+    for (unsigned c = 0; c != 4; ++c) {
+	TEST_EQUAL(db.get_termfreq("XV" + str(c)), 20);
+    }
+    // The cluster terms are boolean, so don't change the document length.
+    TEST_EQUAL(db.get_doclength(1), 1);
+
+    Xapian::Enquire enq(db);
+    static const vector<float> queries[] = {
+	{ 1.0f, 0.05f, 0.0f, 0.0f },
+	{ 0.2f, -0.1f, 0.3f, 1.0f },
+	{ 1.0f, 1.0f, 0.0f, 0.0f },
+    };
+    for (const vector<float>& query : queries) {
+	tout << "query " << (&query - queries) << '\n';
+	Xapian::VectorPostingSource exact(1, query);
+	Xapian::VectorPostingSource all(1, query);
+	all.set_index(index, 4);
+	Xapian::VectorPostingSource nearest(1, query);
+	nearest.set_index(index, 1);
+
+	// Searching every cluster should give exactly the same results as
+	// checking every vector, on its own or combined with a text query.
+	for (auto op : { Xapian::Query::OP_OR,
+			 Xapian::Query::OP_AND,
+			 Xapian::Query::OP_AND_MAYBE }) {
+	    enq.set_query(Xapian::Query(op,
+					Xapian::Query("even"),
+					Xapian::Query(&exact)));
+	    Xapian::MSet mset_exact = enq.get_mset(0, 100);
+	    enq.set_query(Xapian::Query(op,
+					Xapian::Query("even"),
+					Xapian::Query(&all)));
+	    Xapian::MSet mset = enq.get_mset(0, 100);
+	    TEST_EQUAL(mset.size(), mset_exact.size());
+	    TEST(mset_range_is_same(mset, 0, mset_exact, 0, mset.size()));
+	}
+
+	enq.set_query(Xapian::Query(&exact));
+	Xapian::MSet mset_exact = enq.get_mset(0, 10);
+	enq.set_query(Xapian::Query(&all));
+	Xapian::MSet mset = enq.get_mset(0, 10);
+	TEST(mset_range_is_same(mset, 0, mset_exact, 0, 10));
+	TEST_REL(mset.get_max_possible(), >=, mset.get_max_attained());
+
+	// Only the nearest cluster is searched, which should still find the
+	// most similar vectors unless the query is between two groups.
+	enq.set_query(Xapian::Query(&nearest));
+	mset = enq.get_mset(0, 10);
+	TEST_EQUAL(mset.get_matches_upper_bound(), 20);
+	if (&query != &queries[2]) {
+	    TEST(mset_range_is_same(mset, 0, mset_exact, 0, 10));
+	}
+	TEST_REL(mset.get_max_possible(), >=, mset.get_max_attained());
+    }
+
+    // For a query between two groups, the clusters bound the weight.
+    Xapian::VectorPostingSource src(1, queries[2]);
+    src.set_index(index, 2);
+    enq.set_query(Xapian::Query(&src));
+    Xapian::MSet mset = enq.get_mset(0, 10);
+    TEST_REL(mset.get_max_possible(), <, 0.9);
+    TEST_REL(mset.get_max_possible(), >=, mset.get_max_attained());
+}
+
+// Test building and updating a VectorIndex.
+DEFINE_TESTCASE(vectorindex2, writable) {
+    Xapian::WritableDatabase db = get_writable_database();
+    Xapian::VectorIndex index(db, "XV");
+    TEST_EQUAL(index.get_num_clusters(), 0);
+    Xapian::Document doc;
+    TEST_EXCEPTION(Xapian::InvalidOperationError,
+	index.index(db, doc, { 1.0f, 0.0f }));
+    TEST_EXCEPTION(Xapian::InvalidArgumentError,
+	Xapian::VectorIndex(db, string()));
+    TEST_EXCEPTION(Xapian::InvalidArgumentError,
+	index.build(db, 0, 0));
+
+    // Unit vectors at angles from 0 to 87 degrees.
+    for (int i = 0; i != 30; ++i) {
+	double angle = i * M_PI / 60;
+	vector<float> v = { float(cos(angle)), float(sin(angle)) };
+	doc.add_value(0, Xapian::VectorPostingSource::serialise_vector(v));
+	db.add_document(doc);
+    }
+    index.build(db, 0, 3);
+    db.commit();
+    TEST_EQUAL(index.get_num_clusters(), 3);
+    TEST_EQUAL(db.get_termfreq("XV0") + db.get_termfreq("XV1") +
+	       db.get_termfreq("XV2"), 30);
+
+    Xapian::VectorPostingSource src(0, { -1.0f, 0.0f });
+    TEST_EXCEPTION(Xapian::InvalidArgumentError, src.set_index(index, 0));
+    Xapian::VectorPostingSource src_slot(1, { -1.0f, 0.0f });
+    TEST_EXCEPTION(Xapian::InvalidArgumentError,
+	src_slot.set_index(index, 1));
+    Xapian::VectorPostingSource src_dims(0, { -1.0f, 0.0f, 0.0f });
+    TEST_EXCEPTION(Xapian::InvalidArgumentError,
+	src_dims.set_index(index, 1));
+
+    // Index a vector further from its cluster's centroid than any so far,
+    // which needs the cluster's bound increasing for it to get its full
+    // weight.
+    Xapian::Document doc2;
+    doc2.add_term("new");
+    vector<float> v = { -1.0f, 0.2f };
+    index.index(db, doc2, v);
+    Xapian::docid did = db.add_document(doc2);
+    db.commit();
+    TEST_EQUAL(db.get_doclength(did), 1);
+
+    src.set_index(Xapian::VectorIndex(db, "XV"), 1);
+    Xapian::Enquire enq(db);
+    enq.set_query(Xapian::Query(&src));
+    Xapian::MSet mset = enq.get_mset(0, 10);
+    TEST(!mset.empty());
+    TEST_EQUAL(*mset[0], did);
+    TEST_REL(fabs(mset[0].get_weight() - 1.0 / sqrt(1.04)), <, 1e-6);
+
+    // Check the index is included when the source is serialised.
+    Xapian::Registry reg;
+    const Xapian::PostingSource* ps =
+	reg.get_posting_source("Xapian::VectorPostingSource");
+    unique_ptr<Xapian::PostingSource> src2(ps->unserialise(src.serialise()));
+    TEST_EQUAL(src2->serialise(), src.serialise());
+    TEST_EQUAL(src2->get_description(),
+	       "Xapian::VectorPostingSource(slot=0, dimensions=2, "
+	       "clusters=1)");
+
+    // Rebuilding with fewer clusters removes the old cluster terms and
+    // metadata, as does removing a document's vector.
+    doc2 = db.get_document(did);
+    doc2.remove_value(0);
+    db.replace_document(did, doc2);
+    index.build(db, 0, 2);
+    db.commit();
+    TEST_EQUAL(index.get_num_clusters(), 2);
+    TEST_EQUAL(db.get_termfreq("XV0") + db.get_termfreq("XV1"), 30);
+    TEST_EQUAL(db.get_termfreq("XV2"), 0);
+    TEST_EQUAL(db.get_metadata("XV2"), string());
+    TEST_EQUAL(Xapian::VectorIndex(db, "XV").get_num_clusters(), 2);
+    TEST_EQUAL(db.get_unique_terms(did), 1);
+}
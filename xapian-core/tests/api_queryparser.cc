@@ -3230,3 +3230,81 @@ DEFINE_TESTCASE(qp_nopos, !backend) {
 	TEST_STRINGS_EQUAL(parsed, expect);
     }
 }
+
+DEFINE_TESTCASE(qp_stopword_pairs1, !backend) {
+    static const test tests[] = {
+	{ "\"the who\"", "((the@1 PHRASE 2 who@2) FILTER \\x01the\\x00who)" },
+	// A repeated pair is only checked once.
+	{ "\"to be or not to be\"",
+	  "((to@1 PHRASE 6 be@2 PHRASE 6 or@3 PHRASE 6 not@4 PHRASE 6 to@5 PHRASE 6 be@6) FILTER (\\x01to\\x00be AND \\x01be\\x00or AND \\x01or\\x00not AND \\x01not\\x00to))" },
+	// No stopwords, so no pairs.
+	{ "\"rolling stones\"", "(rolling@1 PHRASE 2 stones@2)" },
+	// Only pairs involving a stopword are used.
+	{ "\"rolling in the deep\"",
+	  "((rolling@1 PHRASE 4 in@2 PHRASE 4 the@3 PHRASE 4 deep@4) FILTER (\\x01rolling\\x00in AND \\x01in\\x00the AND \\x01the\\x00deep))" },
+	// Not exact phrases.
+	{ "the NEAR who", "(the@1 NEAR 11 who@2)" },
+	{ "the ADJ who", "(the@1 PHRASE 11 who@2)" },
+	{ "title:\"the who\"",
+	  "((XTthe@1 PHRASE 2 XTwho@2) FILTER \\x01XTthe\\x00XTwho)" },
+    };
+    Xapian::QueryParser qp;
+    Xapian::SimpleStopper stopper;
+    for (const char* w : { "the", "to", "be", "or", "not", "in" }) {
+	stopper.add(w);
+    }
+    qp.set_stopper(&stopper);
+    qp.add_prefix("title", "XT");
+    const auto flags = qp.FLAG_DEFAULT | qp.FLAG_STOPWORD_PAIRS;
+    for (const test& p : tests) {
+	string expect = string("Query(") + p.expect + ')';
+	string parsed = qp.parse_query(p.query, flags).get_description();
+	tout << "Query: " << p.query << '\n';
+	TEST_STRINGS_EQUAL(parsed, expect);
+    }
+}
+
+// Check FLAG_STOPWORD_PAIRS gives the same results as without.
+DEFINE_TESTCASE(qp_stopword_pairs2, writable) {
+    Xapian::WritableDatabase db = get_writable_database();
+    Xapian::SimpleStopper stopper;
+    for (const char* w : { "the", "to", "be", "or", "not", "of" }) {
+	stopper.add(w);
+    }
+    Xapian::TermGenerator termgen;
+    termgen.set_stopper(&stopper);
+    termgen.set_stopper_strategy(termgen.STOP_NONE);
+    termgen.set_flags(termgen.FLAG_STOPWORD_PAIRS);
+    static const char* const texts[] = {
+	"to be or not to be, that is the question",
+	"the who played at the festival",
+	"who is the doctor",
+	"the question of who to be",
+	"be not afraid of greatness",
+	"to be honest, or not",
+    };
+    for (const char* text : texts) {
+	Xapian::Document doc;
+	termgen.set_document(doc);
+	termgen.index_text(text);
+	db.add_document(doc);
+    }
+    db.commit();
+
+    Xapian::QueryParser qp;
+    qp.set_stopper(&stopper);
+    Xapian::Enquire enquire(db);
+    for (const char* q : { "\"to be\"", "\"to be or not to be\"",
+			   "\"the who\"", "\"of who\"", "\"the question\"",
+			   "\"or not\" question", "\"not afraid\"",
+			   "\"who is\"" }) {
+	tout << q << '\n';
+	enquire.set_query(qp.parse_query(q));
+	Xapian::MSet mset = enquire.get_mset(0, 10);
+	enquire.set_query(qp.parse_query(q, qp.FLAG_DEFAULT |
+					     qp.FLAG_STOPWORD_PAIRS));
+	Xapian::MSet mset_pairs = enquire.get_mset(0, 10);
+	TEST_EQUAL(mset.size(), mset_pairs.size());
+	TEST(mset_range_is_same(mset, 0, mset_pairs, 0, mset.size()));
+    }
+}
@@ -399,3 +399,96 @@ DEFINE_TESTCASE(sort_existing_mset_by_relevance, backend) {
     TEST_EQUAL_DOUBLE(mymset.get_max_attained(), weights[1]);
     TEST_EQUAL_DOUBLE(mymset.get_max_possible(), weights[1]);
 }
+
+/// Check Database::cache_values() doesn't change sorting or collapsing.
+DEFINE_TESTCASE(cachevalues1, backend) {
+    Xapian::Database db = get_database("apitest_sortrel");
+    Xapian::Enquire enquire(db);
+    enquire.set_query(Xapian::Query("woman"));
+
+    Xapian::MultiValueKeyMaker sorter;
+    sorter.add_value(10); // Value 10 isn't always set.
+    sorter.add_value(1, true);
+
+    vector<Xapian::MSet> msets;
+    for (int cached = 0; cached != 2; ++cached) {
+	if (cached) {
+	    db.cache_values(1);
+	    db.cache_values(3);
+	    db.cache_values(10);
+	    // Value 100 isn't set in any document.
+	    db.cache_values(100);
+	}
+
+	enquire.set_sort_by_key(&sorter, true);
+	msets.push_back(enquire.get_mset(0, 10));
+
+	enquire.set_sort_by_value(3, false);
+	msets.push_back(enquire.get_mset(0, 10));
+
+	enquire.set_sort_by_value_then_relevance(100, true);
+	msets.push_back(enquire.get_mset(0, 10));
+
+	enquire.set_sort_by_relevance();
+	enquire.set_collapse_key(3);
+	msets.push_back(enquire.get_mset(0, 10));
+
+	enquire.set_collapse_key(10);
+	msets.push_back(enquire.get_mset(0, 10));
+	enquire.set_collapse_key(Xapian::BAD_VALUENO);
+    }
+
+    mset_expect_order(msets[0], 8, 9, 4, 5, 1, 3, 7, 6, 2);
+    size_t n = msets.size() / 2;
+    for (size_t i = 0; i != n; ++i) {
+	const Xapian::MSet& a = msets[i];
+	const Xapian::MSet& b = msets[i + n];
+	TEST_EQUAL(a.size(), b.size());
+	TEST(mset_range_is_same(a, 0, b, 0, a.size()));
+	for (Xapian::doccount j = 0; j != a.size(); ++j) {
+	    TEST_EQUAL(a[j].get_sort_key(), b[j].get_sort_key());
+	    TEST_EQUAL(a[j].get_collapse_key(), b[j].get_collapse_key());
+	    TEST_EQUAL(a[j].get_collapse_count(), b[j].get_collapse_count());
+	}
+    }
+}
+
+/// Check the values cached by cache_values() are reread after reopen().
+DEFINE_TESTCASE(cachevalues2, writable && !inmemory) {
+    Xapian::WritableDatabase wdb = get_writable_database();
+    for (const char* value : { "b", "a", "c" }) {
+	Xapian::Document doc;
+	doc.add_term("t");
+	doc.add_value(1, value);
+	wdb.add_document(doc);
+    }
+    wdb.commit();
+
+    Xapian::Database db = get_writable_database_as_database();
+    db.cache_values(1);
+    Xapian::Enquire enquire(db);
+    enquire.set_query(Xapian::Query("t"));
+    enquire.set_sort_by_value(1, false);
+    Xapian::MSet mset = enquire.get_mset(0, 10);
+    mset_expect_order(mset, 2, 1, 3);
+    TEST_EQUAL(mset[0].get_sort_key(), "a");
+
+    // Change a value and add a document with a new value which sorts first.
+    Xapian::Document doc;
+    doc.add_term("t");
+    doc.add_value(1, "z");
+    wdb.replace_document(2, doc);
+    doc.add_value(1, "0");
+    wdb.add_document(doc);
+    wdb.commit();
+
+    // Until reopen() we should still see the old revision.
+    mset = enquire.get_mset(0, 10);
+    mset_expect_order(mset, 2, 1, 3);
+
+    TEST(db.reopen());
+    mset = enquire.get_mset(0, 10);
+    mset_expect_order(mset, 4, 1, 3, 2);
+    TEST_EQUAL(mset[0].get_sort_key(), "0");
+    TEST_EQUAL(mset[3].get_sort_key(), "z");
+}
@@ -114,3 +114,73 @@ DEFINE_TESTCASE(stemlangs2, !backend) {
     TEST(stem.is_none());
     TEST_EQUAL(stem.get_description(), "Xapian::Stem(none)");
 }
+
+/// Test caching of stemmed forms.
+DEFINE_TESTCASE(stemcache1, !backend) {
+    Xapian::Stem stem("english");
+    // Caching is off by default.
+    TEST_EQUAL(stem("jumping"), "jump");
+    TEST_EQUAL(stem.get_cache_hits(), 0);
+    TEST_EQUAL(stem.get_cache_misses(), 0);
+
+    stem.set_cache_size(4);
+    TEST_EQUAL(stem("jumping"), "jump");
+    TEST_EQUAL(stem("jumping"), "jump");
+    TEST_EQUAL(stem("jumped"), "jump");
+    TEST_EQUAL(stem.get_cache_hits(), 1);
+    TEST_EQUAL(stem.get_cache_misses(), 2);
+
+    // The cache should be shared with copies, including those held by a
+    // TermGenerator.
+    Xapian::TermGenerator tg;
+    Xapian::Document doc;
+    tg.set_document(doc);
+    tg.set_stemmer(stem);
+    tg.index_text("jumping jumped jumps");
+    TEST_EQUAL(stem.get_cache_hits(), 3);
+    TEST_EQUAL(stem.get_cache_misses(), 3);
+    TEST_EQUAL(doc.termlist_count(), 4);
+
+    // Check the size is bounded and that the results are still correct when
+    // entries get discarded.
+    static const char* const words[] = {
+	"cats", "dogs", "running", "ran", "happily", "cats", "dogs"
+    };
+    for (int pass = 0; pass != 3; ++pass) {
+	for (auto word : words) {
+	    TEST_EQUAL(stem(word), Xapian::Stem("english")(word));
+	}
+    }
+
+    // A cache of size 1 should only hold the last word.
+    stem.set_cache_size(1);
+    TEST_EQUAL(stem("cats"), "cat");
+    TEST_EQUAL(stem("dogs"), "dog");
+    TEST_EQUAL(stem("cats"), "cat");
+    TEST_EQUAL(stem.get_cache_hits(), 0);
+    TEST_EQUAL(stem.get_cache_misses(), 3);
+    TEST_EQUAL(stem("cats"), "cat");
+    TEST_EQUAL(stem.get_cache_hits(), 1);
+
+    // Disabling the cache doesn't affect copies which share it.
+    Xapian::Stem copy = stem;
+    stem.set_cache_size(0);
+    TEST_EQUAL(copy("cats"), "cat");
+    TEST_EQUAL(copy.get_cache_hits(), 2);
+    TEST_EQUAL(stem.get_cache_hits(), 0);
+    TEST_EQUAL(stem.get_description(), copy.get_description());
+
+    // Setting the size resets the statistics.
+    stem.set_cache_size(10);
+    TEST_EQUAL(stem.get_cache_hits(), 0);
+    TEST_EQUAL(stem.get_cache_misses(), 0);
+    stem.set_cache_size(0);
+    TEST_EQUAL(stem("jumping"), "jump");
+    TEST_EQUAL(stem.get_cache_misses(), 0);
+
+    // No-op stemmer.
+    Xapian::Stem none;
+    none.set_cache_size(100);
+    TEST_EQUAL(none("jumping"), "jumping");
+    TEST_EQUAL(none.get_cache_misses(), 0);
+}
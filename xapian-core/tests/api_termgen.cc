@@ -28,6 +28,7 @@
 
 #include <string>
 #include <array>
+#include <vector>
 
 #include "apitest.h"
 #include "str.h"
@@ -91,6 +92,10 @@ static const test test_simple[] = {
     { "cont,weight=2",
 	  "simple-example", "example:3[2,104] simple:3[1,103]" },
 
+    // Test mixing runs of ASCII and non-ASCII characters.
+    { "", "CAFÉbar naïve_Test ..X9 \u00a0A&W",
+	  "a&w[4] cafébar[1] naïve_test[2] x9[3]" },
+
     // Test parsing of initials
     { "", "I.B.M.", "ibm[1]" },
     { "", "I.B.M", "ibm[1]" },
@@ -937,3 +942,117 @@ DEFINE_TESTCASE(tg_max_word_length1, !backend) {
     TEST_STRINGS_EQUAL(format_doc_termlist(doc),
 		       "Zcup:1 Zmug:1 cups[1] mugs[2]");
 }
+
+/// Build the term FLAG_STOPWORD_PAIRS uses for a pair of positional terms.
+static string
+stopword_pair(const string& first, const string& second)
+{
+    string pair(1, '\x01');
+    pair += first;
+    pair += '\0';
+    pair += second;
+    return pair;
+}
+
+DEFINE_TESTCASE(tg_stopword_pairs1, !backend) {
+    Xapian::TermGenerator termgen;
+    Xapian::SimpleStopper stopper;
+    for (const char* w : { "the", "to", "be", "or", "not" }) {
+	stopper.add(w);
+    }
+    termgen.set_stopper(&stopper);
+    termgen.set_stopper_strategy(termgen.STOP_NONE);
+    termgen.set_flags(termgen.FLAG_STOPWORD_PAIRS);
+
+    Xapian::Document doc;
+    termgen.set_document(doc);
+    termgen.index_text("The Who said to be or not");
+    // A pair can span index_text() calls if the positions are adjacent...
+    termgen.index_text("the end");
+    // ...but not if there's a gap.
+    termgen.increase_termpos();
+    termgen.index_text("to", 1, "S");
+    termgen.index_text("big", 1, "S");
+
+    vector<string> pairs;
+    for (auto t = doc.termlist_begin(); t != doc.termlist_end(); ++t) {
+	if ((*t)[0] == '\x01') {
+	    pairs.push_back(*t);
+	    TEST_EQUAL(t.get_wdf(), 0);
+	    TEST_EQUAL(t.positionlist_count(), 0);
+	}
+    }
+    vector<string> expected = {
+	stopword_pair("Sto", "Sbig"),
+	stopword_pair("be", "or"),
+	stopword_pair("not", "the"),
+	stopword_pair("or", "not"),
+	stopword_pair("said", "to"),
+	stopword_pair("the", "end"),
+	stopword_pair("the", "who"),
+	stopword_pair("to", "be"),
+    };
+    TEST(pairs == expected);
+
+    // Check the pair terms don't affect the other terms.
+    termgen.set_flags(0, ~termgen.FLAG_STOPWORD_PAIRS);
+    Xapian::Document doc2;
+    termgen.set_document(doc2);
+    termgen.index_text("The Who said to be or not");
+    termgen.index_text("the end");
+    termgen.increase_termpos();
+    termgen.index_text("to", 1, "S");
+    termgen.index_text("big", 1, "S");
+    TEST_EQUAL(doc.termlist_count(), doc2.termlist_count() + pairs.size());
+
+    // Check the stemmed terms are used for STEM_ALL.
+    termgen.set_flags(termgen.FLAG_STOPWORD_PAIRS);
+    termgen.set_stemmer(Xapian::Stem("en"));
+    termgen.set_stemming_strategy(termgen.STEM_ALL);
+    Xapian::Document doc3;
+    termgen.set_document(doc3);
+    termgen.index_text("the cups");
+    TEST(doc3.termlist_begin() != doc3.termlist_end());
+    TEST_EQUAL(*doc3.termlist_begin(), stopword_pair("the", "cup"));
+}
+
+/// Check pair terms don't change document lengths or appear in an ESet.
+DEFINE_TESTCASE(tg_stopword_pairs2, writable) {
+    Xapian::WritableDatabase db = get_writable_database();
+    Xapian::TermGenerator termgen;
+    Xapian::SimpleStopper stopper;
+    for (const char* w : { "the", "to", "be", "or", "not" }) {
+	stopper.add(w);
+    }
+    termgen.set_stopper(&stopper);
+    termgen.set_stopper_strategy(termgen.STOP_NONE);
+
+    auto index = [&](const char* text, Xapian::TermGenerator::flags flags) {
+	termgen.set_flags(flags);
+	Xapian::Document doc;
+	termgen.set_document(doc);
+	termgen.index_text(text, 2);
+	db.add_document(doc);
+    };
+    const char* text = "To be or not to be, that is the question";
+    index(text, 0);
+    index(text, termgen.FLAG_STOPWORD_PAIRS);
+    index("The answer to the question", termgen.FLAG_STOPWORD_PAIRS);
+    db.commit();
+
+    TEST_EQUAL(db.get_doclength(1), 20);
+    TEST_EQUAL(db.get_doclength(2), db.get_doclength(1));
+    TEST_EQUAL(db.get_doclength(3), 10);
+    TEST_EQUAL(db.get_total_length(), 50);
+    TEST_EQUAL(db.get_termfreq(stopword_pair("to", "be")), 1);
+
+    Xapian::Enquire enquire(db);
+    Xapian::RSet rset;
+    rset.add_document(2);
+    rset.add_document(3);
+    Xapian::ESet eset = enquire.get_eset(100, rset);
+    TEST(!eset.empty());
+    for (const string& term : eset) {
+	TEST_NOT_EQUAL(term[0], '\x01');
+    }
+}
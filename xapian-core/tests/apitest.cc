@@ -117,6 +117,14 @@ get_remote_database(const string& dbname,
     return backendmanager->get_remote_database(dbnames, timeout, port_ptr);
 }
 
+Xapian::Database
+get_pooled_remote_database(const string& dbname, int* port_ptr)
+{
+    vector<string> dbnames;
+    dbnames.push_back(dbname);
+    return backendmanager->get_pooled_remote_database(dbnames, port_ptr);
+}
+
 void
 kill_remote(const Xapian::Database& db)
 {
@@ -55,6 +55,14 @@ Xapian::Database get_remote_database(const std::string& db,
 				     unsigned timeout,
 				     int* port_ptr = nullptr);
 
+/** Get a remotetcp database opened with Xapian::DB_POOL_CONNECTION.
+ *
+ *  The server only accepts one connection, and the database is opened with
+ *  a timeout of 2000ms and the default connect_timeout.
+ */
+Xapian::Database get_pooled_remote_database(const std::string& db,
+					    int* port_ptr);
+
 /** Kill the server associated with remote database @a db.
  *
  *  Currently only supported for remotetcp and only for a database with a
@@ -258,6 +258,16 @@ BackendManager::get_remote_database(const vector<string>&,
     throw Xapian::InvalidOperationError(msg);
 }
 
+Xapian::Database
+BackendManager::get_pooled_remote_database(const vector<string>&, int*)
+{
+    string msg = "BackendManager::get_pooled_remote_database() called for "
+		 "non-remotetcp database (type is ";
+    msg += get_dbtype();
+    msg += ')';
+    throw Xapian::InvalidOperationError(msg);
+}
+
 string
 BackendManager::get_writable_database_args(const std::string&,
 					   unsigned int)
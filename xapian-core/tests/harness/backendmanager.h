@@ -148,6 +148,11 @@ class BackendManager {
 			unsigned int timeout,
 			int* port_ptr);
 
+    /// Get a remote database opened with Xapian::DB_POOL_CONNECTION.
+    virtual Xapian::Database
+    get_pooled_remote_database(const std::vector<std::string>& files,
+			       int* port_ptr);
+
     /** Get the args for opening a writable remote database with the
      *  specified timeout.
      */
@@ -377,11 +377,12 @@ try_next_port:
 #endif
 
 static Xapian::Database
-get_remotetcp_db(const string& args, int* port_ptr = nullptr)
+get_remotetcp_db(const string& args, int* port_ptr = nullptr,
+		 unsigned timeout = 10000, int flags = 0)
 {
     auto [port, server] = launch_xapian_tcpsrv(args);
     if (port_ptr) *port_ptr = port;
-    auto db = Xapian::Remote::open(LOCALHOST, port);
+    auto db = Xapian::Remote::open(LOCALHOST, port, timeout, 10000, flags);
     server.set_db_internal(db.internal.get());
     return db;
 }
@@ -423,6 +424,14 @@ BackendManagerRemoteTcp::get_remote_database(const vector<string> & files,
     return get_remotetcp_db(get_remote_database_args(files, timeout), port_ptr);
 }
 
+Xapian::Database
+BackendManagerRemoteTcp::get_pooled_remote_database(const vector<string>& files,
+						    int* port_ptr)
+{
+    return get_remotetcp_db(get_remote_database_args(files, 300000), port_ptr,
+			    2000, Xapian::DB_POOL_CONNECTION);
+}
+
 Xapian::Database
 BackendManagerRemoteTcp::get_database_by_path(const string& path)
 {
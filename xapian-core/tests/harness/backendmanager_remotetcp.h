@@ -58,6 +58,11 @@ class BackendManagerRemoteTcp : public BackendManagerRemote {
 					 unsigned int timeout,
 					 int* port_ptr);
 
+    /// Create a RemoteTcp Xapian::Database using a pooled connection.
+    Xapian::Database
+    get_pooled_remote_database(const std::vector<std::string>& files,
+			       int* port_ptr);
+
     /// Get a RemoteTcp Xapian::Database instance of the database at path
     Xapian::Database get_database_by_path(const std::string& path);
 
@@ -27,12 +27,112 @@
 
 #include "backendmanager.h"
 #include "perftest.h"
+#include "str.h"
 #include "testrunner.h"
 #include "testsuite.h"
 #include "testutils.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <utility>
+#include <vector>
+
 using namespace std;
 
+/** Straightforward implementation of Diversify::get_dmset() to compare with.
+ *
+ *  This is the implementation Diversify used before it was optimised, which
+ *  looks up pairwise similarities in a std::map and re-evaluates the whole
+ *  candidate set for each replacement tried.  It uses the default MPT
+ *  parameters and returns the docids of the diversified top-k.
+ */
+static vector<Xapian::docid>
+reference_dmset(const Xapian::MSet& mset, unsigned k, unsigned r)
+{
+    const double lambda = 0.5, b = 5.0, sigma_sqr = 1e-3;
+    map<Xapian::docid, Xapian::Point> points;
+    map<Xapian::docid, double> scores;
+    vector<Xapian::docid> main_dmset;
+    Xapian::TermListGroup tlg(mset);
+    for (auto it = mset.begin(); it != mset.end(); ++it) {
+	points.emplace(*it, Xapian::Point(tlg, it.get_document()));
+	scores[*it] = it.get_weight();
+	if (main_dmset.size() < k)
+	    main_dmset.push_back(*it);
+    }
+
+    Xapian::LCDClusterer lc(unsigned(main_dmset.size()));
+    Xapian::ClusterSet cset = lc.cluster(mset);
+    Xapian::CosineDistance d;
+    map<pair<Xapian::docid, unsigned>, double> pairwise_sim;
+    for (auto& p : points) {
+	for (unsigned c = 0; c < cset.size(); ++c) {
+	    pairwise_sim[make_pair(p.first, c)] =
+		d.similarity(p.second, cset[c].get_centroid());
+	}
+    }
+
+    auto evaluate = [&](const vector<Xapian::docid>& dmset) {
+	double score_1 = 0, score_2 = 0;
+	for (auto doc_id : dmset)
+	    score_1 += scores[doc_id];
+	for (unsigned c = 0; c < cset.size(); ++c) {
+	    double min_dist = numeric_limits<double>::max();
+	    unsigned pos = 1;
+	    for (auto doc_id : dmset) {
+		double sim = pairwise_sim[make_pair(doc_id, c)];
+		double weight = 2 * b * sigma_sqr / log(1 + pos) * (1 - sim);
+		min_dist = min(min_dist, weight);
+		++pos;
+	    }
+	    score_2 += min_dist;
+	}
+	return -lambda * score_1 + (1 - lambda) * score_2;
+    };
+
+    vector<Xapian::docid> topc;
+    for (unsigned c = 0; c < cset.size(); ++c) {
+	auto documents = cset[c].get_documents();
+	for (unsigned i = 0; i < r && i < documents.size(); ++i)
+	    topc.push_back(documents[i].get_docid());
+    }
+
+    vector<Xapian::docid> curr_dmset = main_dmset;
+    while (true) {
+	bool found_better_dmset = false;
+	for (unsigned i = 0; i < main_dmset.size(); ++i) {
+	    auto curr_doc = main_dmset[i];
+	    double best_score = evaluate(curr_dmset);
+	    bool found_better_doc = false;
+	    for (auto candidate : topc) {
+		if (find(curr_dmset.begin(), curr_dmset.end(), candidate) !=
+		    curr_dmset.end()) {
+		    continue;
+		}
+		auto temp_doc = curr_dmset[i];
+		curr_dmset[i] = candidate;
+		double score = evaluate(curr_dmset);
+		if (score < best_score) {
+		    curr_doc = candidate;
+		    best_score = score;
+		    found_better_doc = true;
+		}
+		curr_dmset[i] = temp_doc;
+	    }
+	    if (found_better_doc) {
+		curr_dmset[i] = curr_doc;
+		found_better_dmset = true;
+	    }
+	}
+	if (!found_better_dmset)
+	    break;
+	main_dmset = curr_dmset;
+    }
+    return main_dmset;
+}
+
 // Test that diversified document set is not empty
 DEFINE_TESTCASE(perfdiversify1, writable && !remote && !inmemory)
 {
@@ -63,3 +163,54 @@ DEFINE_TESTCASE(perfdiversify1, writable && !remote && !inmemory)
 
     logger.testcase_end();
 }
+
+// Compare the time taken to diversify a larger result set with the
+// straightforward implementation.
+DEFINE_TESTCASE(perfdiversify2, writable && !remote && !inmemory)
+{
+    Xapian::Database db;
+    db = backendmanager->get_database("etext");
+
+    logger.testcase_begin("perfdiversify2");
+    Xapian::Enquire enq(db);
+
+    static const char* const terms[] = { "king", "prussia", "war" };
+    Xapian::Query query(Xapian::Query::OP_OR, begin(terms), end(terms));
+
+    logger.searching_start("Diversification");
+    logger.search_start();
+    enq.set_query(query);
+    Xapian::MSet matches = enq.get_mset(0, 200);
+    logger.search_end(query, matches);
+    logger.searching_end();
+
+    for (unsigned k : {10, 20, 50}) {
+	logger.diversifying_start("Diversification with k=" + str(k));
+	unsigned r = 3;
+	Xapian::Diversify d(k, r);
+	logger.diversify_start();
+	Xapian::DocumentSet dset = d.get_dmset(matches);
+	logger.diversify_end(k, r, dset);
+
+	TEST_EQUAL(dset.size(), matches.size());
+	logger.diversifying_end();
+
+	logger.diversifying_start("Reference diversification with k=" +
+				  str(k));
+	logger.diversify_start();
+	vector<Xapian::docid> ref = reference_dmset(matches, k, r);
+	Xapian::DocumentSet ref_dset;
+	for (Xapian::docid did : ref)
+	    ref_dset.add_document(db.get_document(did));
+	logger.diversify_end(k, r, ref_dset);
+	logger.diversifying_end();
+
+	// Both should pick the same documents.
+	TEST_EQUAL(ref.size(), k);
+	for (unsigned i = 0; i != k; ++i) {
+	    TEST_EQUAL(dset[i].get_docid(), ref[i]);
+	}
+    }
+
+    logger.testcase_end();
+}
@@ -0,0 +1,174 @@
+/** @file
+ * @brief performance tests for vector similarity search
+ */
+/* Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+
+#include <config.h>
+
+#include "perftest/perftest_vectorsearch.h"
+
+#include <xapian.h>
+
+#include "backendmanager.h"
+#include "perftest.h"
+#include "str.h"
+#include "testrunner.h"
+#include "testsuite.h"
+#include "testutils.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <set>
+#include <vector>
+
+using namespace std;
+
+/// Number of dimensions of the vectors.
+static const unsigned DIMENSIONS = 64;
+
+/// Number of groups the vectors are generated in.
+static const unsigned GROUPS = 200;
+
+/** Generate a random double in range -1.0 <= v < 1.0
+ */
+static double
+rand_11()
+{
+    return 2.0 * (rand() / (RAND_MAX + 1.0)) - 1.0;
+}
+
+/** Generate a random vector near one of the group centres.
+ *
+ *  The centres are generated the first time this is called.
+ */
+static vector<float>
+gen_vector()
+{
+    static vector<vector<float>> centres;
+    if (centres.empty()) {
+	for (unsigned i = 0; i != GROUPS; ++i) {
+	    vector<float> centre;
+	    for (unsigned j = 0; j != DIMENSIONS; ++j) {
+		centre.push_back(float(rand_11()));
+	    }
+	    centres.push_back(centre);
+	}
+    }
+    vector<float> v = centres[unsigned(rand()) % GROUPS];
+    for (float& x : v) {
+	x += float(0.4 * rand_11());
+    }
+    return v;
+}
+
+static void
+builddb_vectorsearch1(Xapian::WritableDatabase &db, const string & dbname)
+{
+    logger.testcase_begin(dbname);
+    unsigned int runsize = 50000;
+    unsigned int n_clusters = 224;
+    srand(42);
+
+    std::map<std::string, std::string> params;
+    params["runsize"] = str(runsize);
+    params["dimensions"] = str(DIMENSIONS);
+    params["groups"] = str(GROUPS);
+    logger.indexing_begin(dbname, params);
+    for (unsigned int i = 0; i < runsize; ++i) {
+	Xapian::Document doc;
+	doc.add_value(0, Xapian::VectorPostingSource::serialise_vector(
+			     gen_vector()));
+	db.add_document(doc);
+	logger.indexing_add();
+    }
+    db.commit();
+    logger.indexing_end();
+
+    params.clear();
+    params["clusters"] = str(n_clusters);
+    logger.indexing_begin(dbname + " VectorIndex", params);
+    Xapian::VectorIndex index(db, "XV");
+    index.build(db, 0, n_clusters);
+    db.commit();
+    logger.indexing_end();
+    logger.testcase_end();
+}
+
+// Compare searching a VectorIndex with checking every vector.
+DEFINE_TESTCASE(vectorsearch1, writable && !remote && !inmemory) {
+    Xapian::Database db;
+    db = backendmanager->get_database("vectorsearch1", builddb_vectorsearch1,
+				      "vectorsearch1");
+
+    logger.testcase_begin("vectorsearch1");
+    Xapian::Enquire enquire(db);
+    Xapian::VectorIndex index(db, "XV");
+    TEST_REL(index.get_num_clusters(), >, 0);
+
+    srand(1234);
+    vector<vector<float>> queries;
+    for (int i = 0; i != 20; ++i) {
+	queries.push_back(gen_vector());
+    }
+
+    // The exact top 10 for each query.
+    vector<set<Xapian::docid>> exact_top;
+    logger.searching_start("Check every vector");
+    for (const vector<float>& v : queries) {
+	Xapian::VectorPostingSource src(0, v);
+	Xapian::Query query(&src);
+	logger.search_start();
+	enquire.set_query(query);
+	Xapian::MSet mset = enquire.get_mset(0, 10);
+	logger.search_end(query, mset);
+	TEST_EQUAL(mset.size(), 10);
+	exact_top.emplace_back(mset.begin(), mset.end());
+    }
+    logger.searching_end();
+
+    double previous_recall = 0.0;
+    for (unsigned n_probe : { 1, 4, 16 }) {
+	logger.searching_start("VectorIndex searching " + str(n_probe) +
+			       " clusters");
+	Xapian::doccount found = 0;
+	for (size_t i = 0; i != queries.size(); ++i) {
+	    Xapian::VectorPostingSource src(0, queries[i]);
+	    src.set_index(index, n_probe);
+	    Xapian::Query query(&src);
+	    logger.search_start();
+	    enquire.set_query(query);
+	    Xapian::MSet mset = enquire.get_mset(0, 10);
+	    logger.search_end(query, mset);
+	    for (Xapian::docid did : mset) {
+		found += exact_top[i].count(did);
+	    }
+	}
+	logger.searching_end();
+
+	// Check the proportion of the exact top 10 which were found.
+	double recall = found / (10.0 * queries.size());
+	tout << "Recall with " << n_probe << " clusters: " << recall << '\n';
+	TEST_REL(recall, >=, previous_recall);
+	previous_recall = recall;
+    }
+    TEST_REL(previous_recall, >=, 0.9);
+
+    logger.testcase_end();
+}
@@ -87,8 +87,14 @@ using namespace std;
 #include "../net/serialise-error.cc"
 #include "../api/error.cc"
 #include "../api/sortable-serialise.cc"
+#include "../api/editdistance.cc"
+#include "../unicode/utf8itor.cc"
 #include "../include/xapian/intrusive_ptr.h"
 
+#ifdef XAPIAN_HAS_REMOTE_BACKEND
+#include "../common/compression_stream.cc"
+#endif
+
 // fileutils.cc uses opendir(), etc though not in a function we currently test.
 #include "../common/msvc_dirent.cc"
 
@@ -971,6 +977,149 @@ static void test_ioblock1()
     io_unlink(tmp_file);
 }
 
+/// Straightforward dynamic programming edit distance to check against.
+static int
+ref_edit_distance(const string& a_utf8, const string& b_utf8)
+{
+    using Xapian::Utf8Iterator;
+    vector<unsigned> a, b;
+    a.assign(Utf8Iterator(a_utf8), Utf8Iterator());
+    b.assign(Utf8Iterator(b_utf8), Utf8Iterator());
+    size_t cols = b.size() + 1;
+    vector<int> d((a.size() + 1) * cols);
+    for (size_t i = 0; i <= a.size(); ++i) d[i * cols] = int(i);
+    for (size_t j = 0; j <= b.size(); ++j) d[j] = int(j);
+    for (size_t i = 1; i <= a.size(); ++i) {
+	for (size_t j = 1; j <= b.size(); ++j) {
+	    int cost = (a[i - 1] != b[j - 1]);
+	    int v = min(d[(i - 1) * cols + j] + 1, d[i * cols + j - 1] + 1);
+	    v = min(v, d[(i - 1) * cols + j - 1] + cost);
+	    if (i > 1 && j > 1 && a[i - 1] == b[j - 2] && a[i - 2] == b[j - 1]) {
+		v = min(v, d[(i - 2) * cols + j - 2] + 1);
+	    }
+	    d[i * cols + j] = v;
+	}
+    }
+    return d[a.size() * cols + b.size()];
+}
+
+/// Test EditDistanceCalculator.
+static void test_editdistance1()
+{
+    static const struct { const char* a; const char* b; int dist; } cases[] = {
+	{ "", "", 0 },
+	{ "", "abc", 3 },
+	{ "abc", "", 3 },
+	{ "abc", "abc", 0 },
+	{ "abc", "acb", 1 },
+	{ "abcd", "badc", 2 },
+	{ "kitten", "sitting", 3 },
+	{ "ca", "abc", 3 },
+	{ "caf\xc3\xa9", "cafe", 1 },
+	{ "\xc3\xa9" "caf", "caf\xc3\xa9", 2 },
+	{ "\xe2\x82\xac\xc2\xa3", "\xc2\xa3\xe2\x82\xac", 1 },
+    };
+    for (auto& t : cases) {
+	EditDistanceCalculator edcalc(t.a);
+	tout << t.a << " vs " << t.b << '\n';
+	TEST_EQUAL(edcalc(t.b, 10), t.dist);
+	TEST_EQUAL(ref_edit_distance(t.a, t.b), t.dist);
+    }
+
+    // Compare against the reference implementation with random strings, using
+    // a small alphabet (including some non-ASCII characters) so there are lots
+    // of matches and transpositions, and lengths which exercise both the
+    // single word and blocked versions.
+    static const char* const alphabet[] = {
+	"a", "b", "c", "\xc3\xa9", "\xe2\x82\xac"
+    };
+    unsigned seed = 42;
+    auto rnd = [&seed](unsigned n) {
+	seed = seed * 1103515245 + 12345;
+	return (seed >> 16) % n;
+    };
+    auto random_string = [&](size_t len) {
+	string s;
+	for (size_t i = 0; i != len; ++i) s += alphabet[rnd(5)];
+	return s;
+    };
+    for (int i = 0; i != 500; ++i) {
+	size_t len = (i % 5 == 4) ? 60 + rnd(150) : rnd(12);
+	string target = random_string(len);
+	string candidate = target;
+	if (i & 1) {
+	    candidate = random_string(len + rnd(5));
+	} else {
+	    // Make a few edits.
+	    vector<unsigned> u;
+	    u.assign(Xapian::Utf8Iterator(candidate), Xapian::Utf8Iterator());
+	    unsigned edits = rnd(4);
+	    while (edits--) {
+		size_t pos = u.empty() ? 0 : rnd(u.size());
+		switch (rnd(4)) {
+		    case 0:
+			u.insert(u.begin() + pos, 'b');
+			break;
+		    case 1:
+			if (!u.empty()) u.erase(u.begin() + pos);
+			break;
+		    case 2:
+			if (!u.empty()) u[pos] = 0xe9;
+			break;
+		    case 3:
+			if (pos + 1 < u.size()) swap(u[pos], u[pos + 1]);
+			break;
+		}
+	    }
+	    candidate.clear();
+	    for (unsigned ch : u) Xapian::Unicode::append_utf8(candidate, ch);
+	}
+	int expect = ref_edit_distance(target, candidate);
+	EditDistanceCalculator edcalc(target);
+	for (int max_distance : { 0, 1, 2, 3, 1000 }) {
+	    int result = edcalc(candidate, max_distance);
+	    if (expect <= max_distance) {
+		TEST_EQUAL(result, expect);
+	    } else {
+		TEST_REL(result, >, max_distance);
+	    }
+	}
+    }
+}
+
+#ifdef XAPIAN_HAS_REMOTE_BACKEND
+/// Check CompressionStream reports bad and oversized compressed data.
+static void test_compressionstream1()
+{
+    const string data(100000, 'x');
+    CompressionStream comp;
+    size_t size = data.size();
+    const char* p = comp.compress(data.data(), &size);
+    TEST(p != NULL);
+    const string compressed(p, size);
+
+    string out;
+    comp.decompress_start();
+    TEST(comp.decompress_chunk(compressed.data(), int(compressed.size()), out,
+			       data.size()));
+    TEST(out == data);
+
+    out.resize(0);
+    comp.decompress_start();
+    TEST_EXCEPTION(Xapian::DatabaseError,
+	comp.decompress_chunk(compressed.data(), int(compressed.size()), out,
+			      data.size() - 1));
+    TEST_REL(out.size(), <, data.size() + 8192);
+
+    // A deflate block header with the reserved block type 3.
+    const string bad("\x07\x00\x00\x00", 4);
+    out.resize(0);
+    comp.decompress_start();
+    TEST_EXCEPTION(Xapian::DatabaseError,
+	comp.decompress_chunk(bad.data(), int(bad.size()), out));
+}
+#endif
+
 static const test_desc tests[] = {
     TESTCASE(simple_exceptions_work1),
     TESTCASE(class_exceptions_work1),
@@ -981,6 +1130,7 @@ static const test_desc tests[] = {
     TESTCASE(packstring2),
 #ifdef XAPIAN_HAS_REMOTE_BACKEND
     TESTCASE(serialiseerror1),
+    TESTCASE(compressionstream1),
 #endif
     TESTCASE(sortableserialise1),
     TESTCASE(tostring1),
@@ -995,6 +1145,7 @@ static const test_desc tests[] = {
     TESTCASE(parseunsigned1),
     TESTCASE(parsesigned1),
     TESTCASE(ioblock1),
+    TESTCASE(editdistance1),
     END_OF_TESTCASES
 };
 
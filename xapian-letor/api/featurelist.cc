@@ -73,15 +73,14 @@ FeatureList::~FeatureList()
 }
 
 void
-FeatureList::normalise(std::vector<FeatureVector>& fvec) const
+FeatureList::normalise(std::vector<double>& fmatrix, size_t num_features) const
 {
-    LOGCALL_VOID(API, "FeatureList::normalise", fvec);
-    int num_features = fvec[0].get_fcount();
-    for (int j = 0; j < num_features; ++j) {
+    LOGCALL_VOID(API, "FeatureList::normalise", fmatrix | num_features);
+    for (size_t j = 0; j < num_features; ++j) {
 	// Find the maximum value of this feature.
 	double max_fval = 0.0;
-	for (const auto& v : fvec) {
-	    max_fval = max(max_fval, v.get_fvals()[j]);
+	for (size_t k = j; k < fmatrix.size(); k += num_features) {
+	    max_fval = max(max_fval, fmatrix[k]);
 	}
 
 	if (max_fval == 0.0) {
@@ -90,8 +89,8 @@ FeatureList::normalise(std::vector<FeatureVector>& fvec) const
 	}
 
 	// Scale all values of this feature such that the max is 1.
-	for (auto& v : fvec) {
-	    v.set_feature_value(j, v.get_feature_value(j) / max_fval);
+	for (size_t k = j; k < fmatrix.size(); k += num_features) {
+	    fmatrix[k] /= max_fval;
 	}
     }
 }
@@ -104,32 +103,55 @@ FeatureList::create_feature_vectors(const Xapian::MSet & mset,
     LOGCALL(API, std::vector<FeatureVector>, "FeatureList::create_feature_vectors", mset | letor_query | letor_db);
     if (mset.empty())
 	return vector<FeatureVector>();
-    std::vector<FeatureVector> fvec;
     Assert(!internal->feature.empty());
 
+    internal->set_database(letor_db);
+    internal->set_query(letor_query);
+    // A single Feature::Internal is shared by all the documents - the
+    // query-level stats are computed once here, and only the document-level
+    // stats are updated for each document.
+    Xapian::Internal::intrusive_ptr<Feature::Internal> internal_feature(
+	new Feature::Internal(letor_db, letor_query, Xapian::Document()));
+    internal->populate_query_stats(internal_feature.get());
+    for (Feature* it : internal->feature) {
+	it->internal = internal_feature;
+    }
+
+    // Feature values for all the documents, one row per document.
+    std::vector<double> fmatrix;
+    std::vector<Xapian::docid> dids;
+    dids.reserve(mset.size());
+    size_t num_features = 0;
     for (Xapian::MSetIterator i = mset.begin(); i != mset.end(); ++i) {
 	Xapian::Document doc = i.get_document();
-	std::vector<double> fvals;
-	internal->set_data(letor_query, letor_db, doc);
-	auto internal_feature = new Feature::Internal(letor_db,
-						      letor_query, doc);
+	internal->set_doc(doc);
 	// Computes and populates the Feature::Internal with required stats.
-	internal->populate_feature_internal(internal_feature);
+	internal->populate_doc_stats(internal_feature.get());
 	for (Feature* it : internal->feature) {
-	    it->internal = internal_feature;
 	    const vector<double>& values = it->get_values();
 	    // Append feature values
-	    fvals.insert(fvals.end(), values.begin(), values.end());
+	    fmatrix.insert(fmatrix.end(), values.begin(), values.end());
 	}
 	double wt = i.get_weight();
 	// Weight is added as a feature by default.
-	fvals.push_back(wt);
-	Xapian::docid did = doc.get_docid();
-	// construct a FeatureVector object using did and fvals.
-	Xapian::FeatureVector fv(did, fvals);
-	fvec.push_back(fv);
+	fmatrix.push_back(wt);
+	if (num_features == 0) {
+	    num_features = fmatrix.size();
+	    fmatrix.reserve(num_features * mset.size());
+	}
+	dids.push_back(doc.get_docid());
+    }
+    normalise(fmatrix, num_features);
+
+    std::vector<FeatureVector> fvec;
+    fvec.reserve(dids.size());
+    auto row = fmatrix.begin();
+    for (Xapian::docid did : dids) {
+	// construct a FeatureVector object using did and its feature values.
+	std::vector<double> fvals(row, row + num_features);
+	fvec.emplace_back(did, fvals);
+	row += num_features;
     }
-    normalise(fvec);
     return fvec;
 }
 
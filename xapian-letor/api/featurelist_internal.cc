@@ -32,33 +32,43 @@
 #include <cstdlib>
 #include <cstring>
 #include "debuglog.h"
+#include "stringutils.h"
 
 using namespace std;
 using namespace Xapian;
 
 void
-FeatureList::Internal::set_data(const Xapian::Query & letor_query,
-				const Xapian::Database & letor_db,
-				const Xapian::Document & letor_doc)
+FeatureList::Internal::compute_doc_stats(map<string, Xapian::termcount>* tf,
+					 map<string, Xapian::termcount>* len)
+    const
 {
-    set_query(letor_query);
-    set_doc(letor_doc);
-    set_database(letor_db);
-}
-
-std::map<std::string, Xapian::termcount>
-FeatureList::Internal::compute_termfreq() const
-{
-    std::map<std::string, Xapian::termcount> tf;
+    Xapian::termcount title_len = 0;
+    auto qt = query_terms.begin();
+    auto qt_end = tf ? query_terms.end() : qt;
+    Xapian::TermIterator dt = featurelist_doc.termlist_begin();
+    for ( ; dt != featurelist_doc.termlist_end(); ++dt) {
+	const string& term = *dt;
+	if (len && startswith(term, 'S')) {
+	    // Title terms have prefix "S".
+	    title_len += dt.get_wdf();
+	} else if (qt == qt_end && (!len || term > "S")) {
+	    // Nothing else of interest remains in the termlist.
+	    break;
+	}
+	while (qt != qt_end && *qt < term) ++qt;
+	if (qt != qt_end && *qt == term) {
+	    (*tf)[term] = dt.get_wdf();
+	    ++qt;
+	}
+    }
 
-    Xapian::TermIterator docterms = featurelist_doc.termlist_begin();
-    for (Xapian::TermIterator qt = featurelist_query.get_unique_terms_begin();
-	 qt != featurelist_query.get_terms_end(); ++qt) {
-	docterms.skip_to(*qt);
-	if (docterms != featurelist_doc.termlist_end() && *qt == *docterms)
-	    tf[*qt] = docterms.get_wdf();
+    if (len) {
+	(*len)["title"] = title_len;
+	Xapian::termcount whole_len =
+		featurelist_db.get_doclength(featurelist_doc.get_docid());
+	(*len)["whole"] = whole_len;
+	(*len)["body"] = whole_len - title_len;
     }
-    return tf;
 }
 
 std::map<std::string, double>
@@ -67,39 +77,14 @@ FeatureList::Internal::compute_inverse_doc_freq() const
     std::map<std::string, double> idf;
     Xapian::doccount totaldocs = featurelist_db.get_doccount();
 
-    for (Xapian::TermIterator qt = featurelist_query.get_unique_terms_begin();
-	 qt != featurelist_query.get_terms_end(); ++qt) {
-	Xapian::doccount df = featurelist_db.get_termfreq(*qt);
+    for (const string& qt : query_terms) {
+	Xapian::doccount df = featurelist_db.get_termfreq(qt);
 	if (df != 0)
-	    idf[*qt] = log10((double)totaldocs / (double)(1 + df));
+	    idf[qt] = log10((double)totaldocs / (double)(1 + df));
     }
     return idf;
 }
 
-std::map<std::string, Xapian::termcount>
-FeatureList::Internal::compute_doc_length() const
-{
-    std::map<std::string, Xapian::termcount> len;
-
-    Xapian::termcount title_len = 0;
-    Xapian::TermIterator dt = featurelist_doc.termlist_begin();
-    // reach the iterator to the start of the title terms i.e. prefix "S"
-    dt.skip_to("S");
-    for ( ; dt != featurelist_doc.termlist_end(); ++dt) {
-	if ((*dt)[0] != 'S') {
-	    // We've reached the end of the S-prefixed terms.
-	    break;
-	}
-	title_len += dt.get_wdf();
-    }
-    len["title"] = title_len;
-    Xapian::termcount whole_len =
-	    featurelist_db.get_doclength(featurelist_doc.get_docid());
-    len["whole"] = whole_len;
-    len["body"] = whole_len - title_len;
-    return len;
-}
-
 std::map<std::string, Xapian::termcount>
 FeatureList::Internal::compute_collection_length() const
 {
@@ -136,28 +121,21 @@ FeatureList::Internal::compute_collection_termfreq() const
 {
     std::map<std::string, Xapian::termcount> tf;
 
-    for (Xapian::TermIterator qt = featurelist_query.get_unique_terms_begin();
-	 qt != featurelist_query.get_terms_end(); ++qt) {
-	Xapian::termcount coll_tf = featurelist_db.get_collection_freq(*qt);
+    for (const string& qt : query_terms) {
+	Xapian::termcount coll_tf = featurelist_db.get_collection_freq(qt);
 	if (coll_tf != 0)
-	    tf[*qt] = coll_tf;
+	    tf[qt] = coll_tf;
     }
     return tf;
 }
 
 void
-FeatureList::Internal::populate_feature_internal(Feature::Internal*
-						 internal_feature)
+FeatureList::Internal::populate_query_stats(Feature::Internal*
+					    internal_feature)
 {
-    if (stats_needed & TERM_FREQUENCY) {
-	internal_feature->set_termfreq(compute_termfreq());
-    }
     if (stats_needed & INVERSE_DOCUMENT_FREQUENCY) {
 	internal_feature->set_inverse_doc_freq(compute_inverse_doc_freq());
     }
-    if (stats_needed & DOCUMENT_LENGTH) {
-	internal_feature->set_doc_length(compute_doc_length());
-    }
     if (stats_needed & COLLECTION_LENGTH) {
 	internal_feature->set_collection_length(compute_collection_length());
     }
@@ -166,3 +144,22 @@ FeatureList::Internal::populate_feature_internal(Feature::Internal*
 			  compute_collection_termfreq());
     }
 }
+
+void
+FeatureList::Internal::populate_doc_stats(Feature::Internal* internal_feature)
+{
+    internal_feature->set_document(featurelist_doc);
+    if (!(stats_needed & (TERM_FREQUENCY | DOCUMENT_LENGTH)))
+	return;
+
+    map<string, Xapian::termcount> tf;
+    map<string, Xapian::termcount> len;
+    compute_doc_stats((stats_needed & TERM_FREQUENCY) ? &tf : nullptr,
+		      (stats_needed & DOCUMENT_LENGTH) ? &len : nullptr);
+    if (stats_needed & TERM_FREQUENCY) {
+	internal_feature->set_termfreq(std::move(tf));
+    }
+    if (stats_needed & DOCUMENT_LENGTH) {
+	internal_feature->set_doc_length(std::move(len));
+    }
+}
@@ -28,6 +28,8 @@
 #include "api/feature_internal.h"
 
 #include <map>
+#include <string>
+#include <vector>
 
 namespace Xapian {
 
@@ -61,15 +63,8 @@ class FeatureList::Internal : public Xapian::Internal::intrusive_base {
     /// Xapian::Document using which features will be calculated.
     Document featurelist_doc;
 
-    /** This method finds the frequency of the query terms in the
-     *  specified documents.
-     *
-     *  This method is a helper method and statistics gathered through
-     *  this method are used in feature value calculation.
-     *
-     *  @return A map from query terms to their term frequencies.
-     */
-    std::map<std::string, Xapian::termcount> compute_termfreq() const;
+    /// The unique terms of featurelist_query, in ascending order.
+    std::vector<std::string> query_terms;
 
     /** This method calculates the inverse document frequency(idf) of query
      *  terms in the database.
@@ -87,14 +82,20 @@ class FeatureList::Internal : public Xapian::Internal::intrusive_base {
      */
     std::map<std::string, double> compute_inverse_doc_freq() const;
 
-    /** This method calculates the length of the documents as number of 'terms'.
-     *  It calculates the length for three different parts:
-     *  title, body and whole document.
+    /** This method finds the frequency of the query terms in the specified
+     *  document and the length of the document as number of 'terms'.
+     *
+     *  Both statistics are gathered from a single pass over the document's
+     *  termlist, which stops as soon as nothing further is needed from it.
+     *  The length is calculated for three different parts: title, body and
+     *  whole document.
      *
      *  This method is a helper method and statistics gathered through
      *  this method are used in feature value calculation.
      *
-     *  @return A map from query terms to their document lengths.
+     *  @param[out] tf	If non-null, filled with a map from query terms to
+     *			their term frequencies.
+     *  @param[out] len	If non-null, filled with the document lengths.
      *  @code
      *  map<string, long int> len;
      *  len["title"];
@@ -102,7 +103,8 @@ class FeatureList::Internal : public Xapian::Internal::intrusive_base {
      *  len["whole"];
      *  @endcode
      */
-    std::map<std::string, Xapian::termcount> compute_doc_length() const;
+    void compute_doc_stats(std::map<std::string, Xapian::termcount>* tf,
+			   std::map<std::string, Xapian::termcount>* len) const;
 
     /** This method calculates the length of the collection in number of terms
      *  for different parts like 'title', 'body' and 'whole'.
@@ -150,6 +152,8 @@ class FeatureList::Internal : public Xapian::Internal::intrusive_base {
      */
     void set_query(const Xapian::Query& query) {
 	featurelist_query = query;
+	query_terms.assign(query.get_unique_terms_begin(),
+			   query.get_terms_end());
     }
 
     /** Specify the document to use for feature building.
@@ -160,8 +164,15 @@ class FeatureList::Internal : public Xapian::Internal::intrusive_base {
 	featurelist_doc = doc;
     }
 
-    /// Computes and populates the stats needed by a Feature.
-    void populate_feature_internal(Feature::Internal* internal_feature);
+    /** Computes and populates the query-level stats needed by a Feature.
+     *
+     *  These only depend on the query and the database, so only need to be
+     *  computed once however many documents are being processed.
+     */
+    void populate_query_stats(Feature::Internal* internal_feature);
+
+    /// Computes and populates the document-level stats needed by a Feature.
+    void populate_doc_stats(Feature::Internal* internal_feature);
 
   public:
 
@@ -169,11 +180,6 @@ class FeatureList::Internal : public Xapian::Internal::intrusive_base {
      *  Each will be used to return feature value.
      */
     std::vector<Feature *> feature;
-
-    /// This method sets all the data members required for computing stats.
-    void set_data(const Xapian::Query& query,
-		  const Xapian::Database& db,
-		  const Xapian::Document& doc);
 };
 
 }
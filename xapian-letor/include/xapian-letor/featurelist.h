@@ -91,8 +91,13 @@ class XAPIAN_VISIBILITY_DEFAULT FeatureList {
 			   const Xapian::Database & letor_db) const;
 
   private:
-    /// Perform query-level normalisation of FeatureVectors.
-    void normalise(std::vector<FeatureVector> & fvec) const;
+    /** Perform query-level normalisation of feature values.
+     *
+     *  @param fmatrix		Feature values for every document in the MSet,
+     *				stored row-major with one row per document.
+     *  @param num_features	Number of feature values for each document.
+     */
+    void normalise(std::vector<double> & fmatrix, size_t num_features) const;
 };
 
 }
@@ -1,5 +1,6 @@
 noinst_HEADERS +=\
-	common/serialise-double.h
+	common/serialise-double.h\
+	ranker/featurematrix.h
 
 EXTRA_DIST +=\
 	ranker/Makefile
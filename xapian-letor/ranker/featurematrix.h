@@ -0,0 +1,139 @@
+/** @file
+ * @brief Feature values of a list of FeatureVectors stored contiguously
+ */
+/* Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+
+#ifndef XAPIAN_INCLUDED_FEATUREMATRIX_H
+#define XAPIAN_INCLUDED_FEATUREMATRIX_H
+
+#include "xapian-letor/featurevector.h"
+#include "xapian/error.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace Xapian {
+
+/** Feature values and labels of a list of FeatureVectors.
+ *
+ *  The rankers make many passes over the feature values of each query's
+ *  documents, but FeatureVector::get_fvals() returns a copy of the values
+ *  each time it is called.  This copies them once into a single row-major
+ *  block, with one row per FeatureVector.
+ *
+ *  All the FeatureVectors are assumed to have the same number of features
+ *  as the first.
+ */
+class FeatureMatrix {
+    /// Number of feature values in each row.
+    size_t num_features = 0;
+
+    /// The feature values.
+    std::vector<double> fvals;
+
+    /// The label of each row.
+    std::vector<double> labels;
+
+  public:
+    /// Construct from a list of FeatureVectors.
+    explicit FeatureMatrix(const std::vector<FeatureVector>& fvv) {
+	if (fvv.empty()) return;
+	num_features = fvv[0].get_fcount();
+	fvals.reserve(num_features * fvv.size());
+	labels.reserve(fvv.size());
+	for (auto&& fv : fvv) {
+	    const std::vector<double>& v = fv.get_fvals();
+	    fvals.insert(fvals.end(), v.begin(), v.end());
+	    labels.push_back(fv.get_label());
+	}
+    }
+
+    /** Build a FeatureMatrix for each query's list of FeatureVectors.
+     *
+     *  Queries with no documents are skipped, since there's nothing to learn
+     *  from them.
+     *
+     *  @param training_data	The FeatureVectors for each query.
+     *  @param compare		If non-NULL, each query's FeatureVectors are
+     *				first sorted using this comparison function.
+     *
+     *  @exception InvalidArgumentError if there are no FeatureVectors, or
+     *		   they don't all have the same number of features.
+     */
+    static std::vector<FeatureMatrix>
+    from_training_data(const std::vector<std::vector<FeatureVector>>& training_data,
+		       bool (*compare)(const FeatureVector&,
+				       const FeatureVector&) = nullptr) {
+	std::vector<FeatureMatrix> result;
+	result.reserve(training_data.size());
+	for (auto& item : training_data) {
+	    if (item.empty())
+		continue;
+	    for (auto& fv : item) {
+		if (fv.get_fcount() != item[0].get_fcount() ||
+		    (!result.empty() &&
+		     size_t(fv.get_fcount()) != result[0].get_fcount())) {
+		    throw InvalidArgumentError("Cannot train: training data "
+					       "has uneven set of features. "
+					       "Make sure that you are using "
+					       "the same set of Features for "
+					       "all the queries");
+		}
+	    }
+	    if (compare) {
+		std::vector<FeatureVector> sorted = item;
+		std::sort(sorted.begin(), sorted.end(), compare);
+		result.emplace_back(sorted);
+	    } else {
+		result.emplace_back(item);
+	    }
+	}
+	if (result.empty())
+	    throw InvalidArgumentError("Cannot train: no training data");
+	return result;
+    }
+
+    /// Number of rows.
+    size_t size() const { return labels.size(); }
+
+    /// Number of feature values in each row.
+    size_t get_fcount() const { return num_features; }
+
+    /// The feature values for row @a i.
+    const double* get_fvals(size_t i) const {
+	return fvals.data() + i * num_features;
+    }
+
+    /// The label for row @a i.
+    double get_label(size_t i) const { return labels[i]; }
+
+    /// Calculate the inner product of row @a i and @a parameters.
+    double inner_product(size_t i,
+			 const std::vector<double>& parameters) const {
+	const double* row = get_fvals(i);
+	double result = 0.0;
+	for (size_t j = 0; j < num_features; ++j)
+	    result += parameters[j] * row[j];
+	return result;
+    }
+};
+
+}
+
+#endif // XAPIAN_INCLUDED_FEATUREMATRIX_H
@@ -31,6 +31,7 @@
 #include "xapian-letor/ranker.h"
 
 #include "debuglog.h"
+#include "featurematrix.h"
 #include "serialise-double.h"
 
 #include <xapian.h>
@@ -54,47 +55,37 @@ label_comparer(const FeatureVector& firstfv,
     return firstfv.get_label() > secondfv.get_label();
 }
 
-static double
-calculate_inner_product(const vector<double>& parameters,
-			const vector<double>& feature_sets)
-{
-    double inner_product = 0.0;
-    for (size_t i = 0; i < parameters.size(); ++i) {
-	inner_product += parameters[i] * feature_sets[i];
-    }
-    return inner_product;
-}
-
 static vector<double>
-calculate_gradient(const vector<FeatureVector>& sorted_feature_vectors,
+calculate_gradient(const FeatureMatrix& sorted_feature_vectors,
 		   const vector<double>& new_parameters)
 {
-    vector<double> gradient(sorted_feature_vectors[0].get_fcount(), 0);
+    size_t feature_cnt = sorted_feature_vectors.get_fcount();
+    vector<double> gradient(feature_cnt, 0);
 
     size_t list_length = sorted_feature_vectors.size();
 
     vector<double> exponents;
+    exponents.reserve(list_length);
     double expsum = 0.0;
 
     for (size_t i = 0; i < list_length; ++i) {
-	const auto& fvals = sorted_feature_vectors[i].get_fvals();
-	double exponent = exp(calculate_inner_product(new_parameters, fvals));
+	double exponent =
+	    exp(sorted_feature_vectors.inner_product(i, new_parameters));
 	exponents.push_back(exponent);
 	expsum += exponent;
     }
 
     for (size_t i = 0; i < list_length; ++i) {
-	vector<double> feature_sets = sorted_feature_vectors[i].get_fvals();
-	for (size_t j = 0; j < feature_sets.size() - 1; ++j) {
+	const double* feature_sets = sorted_feature_vectors.get_fvals(i);
+	for (size_t j = 0; j < feature_cnt - 1; ++j) {
 	    gradient[j] += feature_sets[j] * exponents[i] / expsum;
 	}
     }
 
-    vector<double> first_place_in_ground_truth_feature_sets =
-	    sorted_feature_vectors[0].get_fvals();
+    const double* first_place_in_ground_truth_feature_sets =
+	    sorted_feature_vectors.get_fvals(0);
 
-    for (size_t i = 0; i < first_place_in_ground_truth_feature_sets.size() - 1;
-	 ++i) {
+    for (size_t i = 0; i < feature_cnt - 1; ++i) {
 	gradient[i] -= first_place_in_ground_truth_feature_sets[i];
     }
 
@@ -116,12 +107,12 @@ update_parameters(vector<double>& new_parameters,
  * new_parameters(w) is updated as: w = w - gradient * learningRate
  */
 static void
-batch_learning(vector<FeatureVector> feature_vectors,
+batch_learning(const FeatureMatrix& sorted_feature_vectors,
 	       vector<double> & new_parameters,
 	       double learning_rate)
 {
-    sort(feature_vectors.begin(), feature_vectors.end(), label_comparer);
-    const auto& gradient = calculate_gradient(feature_vectors, new_parameters);
+    const auto& gradient = calculate_gradient(sorted_feature_vectors,
+					      new_parameters);
     update_parameters(new_parameters, gradient, learning_rate);
 }
 
@@ -129,29 +120,17 @@ void
 ListMLERanker::train(const vector<vector<FeatureVector>>& training_data)
 {
     LOGCALL_VOID(API, "ListMLERanker::train", training_data);
-    if (training_data.empty() || training_data[0].empty())
-	throw InvalidArgumentError("Cannot train: no training data");
-    int feature_cnt = training_data[0][0].get_fcount();
+    // Sort each query's documents by label and copy the feature values into
+    // contiguous storage once up front, since we iterate over them many
+    // times.
+    vector<FeatureMatrix> queries =
+	FeatureMatrix::from_training_data(training_data, label_comparer);
 
     // Initialize the parameters for neural network
-    vector<double> new_parameters;
-    for (int feature_num = 0; feature_num < feature_cnt; ++feature_num) {
-	new_parameters.push_back(0.0);
-    }
-
-    for (auto& item1 : training_data) {
-	for (auto& item2 : item1) {
-	    if (item2.get_fcount() != feature_cnt) {
-		throw InvalidArgumentError("Cannot train: training data has "
-					   "uneven set of features. Make sure "
-					   "that you are using the same set "
-					   "of Features for all the queries");
-	    }
-	}
-    }
+    vector<double> new_parameters(queries[0].get_fcount(), 0.0);
 
     for (int iter_num = 1; iter_num <= iterations; ++iter_num) {
-	for (auto& item : training_data) {
+	for (auto& item : queries) {
 	    batch_learning(item, new_parameters, learning_rate);
 	}
     }
@@ -200,18 +179,21 @@ std::vector<FeatureVector>
 ListMLERanker::rank_fvv(const std::vector<FeatureVector>& fvv) const
 {
     LOGCALL(API, std::vector<FeatureVector>, "ListMLERanker::rank_fvv", fvv);
-    std::vector<FeatureVector> testfvv = fvv;
-    for (size_t i = 0; i < testfvv.size(); ++i) {
-	double listmle_score = 0;
-	const auto& fvals = testfvv[i].get_fvals();
-	if (fvals.size() != parameters.size())
+    for (auto&& fv : fvv) {
+	if (size_t(fv.get_fcount()) != parameters.size())
 	    throw InvalidArgumentError("Model incompatible. Make sure that "
 				       "you are using the same set of "
 				       "Features using which the model "
 				       "was created.");
+    }
+    std::vector<FeatureVector> testfvv = fvv;
+    for (auto&& fv : testfvv) {
+	// get_fvals() returns a copy, so only call it once per document.
+	const std::vector<double> fvals = fv.get_fvals();
+	double listmle_score = 0;
 	for (size_t j = 0; j < fvals.size(); ++j)
 	    listmle_score += fvals[j] * parameters[j];
-	testfvv[i].set_score(listmle_score);
+	fv.set_score(listmle_score);
     }
     return testfvv;
 }
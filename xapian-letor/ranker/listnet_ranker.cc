@@ -31,6 +31,7 @@
 #include "xapian-letor/ranker.h"
 
 #include "debuglog.h"
+#include "featurematrix.h"
 #include "serialise-double.h"
 
 #include <algorithm>
@@ -52,55 +53,54 @@ ListNETRanker::~ListNETRanker() {
     LOGCALL_DTOR(API, "ListNETRanker");
 }
 
-static double
-calculate_inner_product(const vector<double> &parameters, const vector<double> &fvals) {
-    LOGCALL_STATIC_VOID(API, "calculate_inner_product", parameters | fvals);
-    double inner_product = 0.0;
-    for (size_t i = 0; i < fvals.size(); ++i)
-	inner_product += parameters[i] * fvals[i];
-    return inner_product;
-}
-
 // From Theorem (8) in Cao et al. "Learning to rank: from pairwise approach to listwise approach."
 static prob_distrib_vector
-init_probability(const vector<FeatureVector> &feature_vectors, const vector<double> &new_parameters) {
+init_probability(const FeatureMatrix &feature_vectors, const vector<double> &new_parameters) {
     LOGCALL_STATIC_VOID(API, "init_probability", feature_vectors | new_parameters);
 
     // probability distribution, y is ground truth, while z is predict score
+    size_t list_length = feature_vectors.size();
     vector<double> prob_y;
     vector<double> prob_z;
+    prob_y.reserve(list_length);
+    prob_z.reserve(list_length);
     double expsum_y = 0.0;
     double expsum_z = 0.0;
 
-    for (auto&& v : feature_vectors) {
-	expsum_y += exp(v.get_label());
-	expsum_z += exp(calculate_inner_product(new_parameters, v.get_fvals()));
+    for (size_t i = 0; i < list_length; ++i) {
+	double exp_y = exp(feature_vectors.get_label(i));
+	double exp_z = exp(feature_vectors.inner_product(i, new_parameters));
+	prob_y.push_back(exp_y);
+	prob_z.push_back(exp_z);
+	expsum_y += exp_y;
+	expsum_z += exp_z;
     }
-    for (auto&& v : feature_vectors) {
-	prob_y.push_back(exp(v.get_label()) / expsum_y);
-	prob_z.push_back(exp(calculate_inner_product(new_parameters, v.get_fvals())) / expsum_z);
+    for (size_t i = 0; i < list_length; ++i) {
+	prob_y[i] /= expsum_y;
+	prob_z[i] /= expsum_z;
     }
     vector<vector<double>> prob;
-    prob.push_back(prob_y);
-    prob.push_back(prob_z);
+    prob.push_back(std::move(prob_y));
+    prob.push_back(std::move(prob_z));
     return prob;
 }
 
 // Equation (6) in paper Cao et al. "Learning to rank: from pairwise approach to listwise approach."
 static vector<double>
-calculate_gradient(const vector<FeatureVector> &feature_vectors, const prob_distrib_vector &prob) {
+calculate_gradient(const FeatureMatrix &feature_vectors, const prob_distrib_vector &prob) {
     LOGCALL_STATIC_VOID(API, "calculate_gradient", feature_vectors | prob);
 
-    vector<double> gradient(feature_vectors[0].get_fcount(), 0);
+    size_t feature_cnt = feature_vectors.get_fcount();
+    vector<double> gradient(feature_cnt, 0);
 
     // Hold ground truth probability distribution
-    const vector<double> prob_y(prob[0]);
+    const vector<double>& prob_y = prob[0];
     // Hold prediction score probability distribution
-    const vector<double> prob_z(prob[1]);
+    const vector<double>& prob_z = prob[1];
 
     for (size_t i = 0; i < feature_vectors.size(); ++i) {
-	vector<double> fvals = feature_vectors[i].get_fvals();
-	for (size_t k = 0; k < fvals.size(); ++k) {
+	const double* fvals = feature_vectors.get_fvals(i);
+	for (size_t k = 0; k < feature_cnt; ++k) {
 	    double first_term = - prob_y[i] * fvals[k];
 	    gradient[k] += first_term;
 
@@ -130,26 +130,17 @@ void
 ListNETRanker::train(const vector<vector<Xapian::FeatureVector>>& training_data)
 {
     LOGCALL_VOID(API, "ListNETRanker::train", training_data);
-    if (training_data.empty() || training_data[0].empty())
-	throw InvalidArgumentError("Cannot train: no training data");
-    int feature_cnt = training_data[0][0].get_fcount();
+    // Copy the feature values into contiguous storage once up front, since
+    // we iterate over them many times.
+    vector<FeatureMatrix> queries =
+	FeatureMatrix::from_training_data(training_data);
 
     // initialize the parameters for neural network
-    vector<double> new_parameters(feature_cnt, 0.0);
-
-    for (auto& item1 : training_data) {
-	for (auto& item2 : item1) {
-	    if (item2.get_fcount() != feature_cnt) {
-		throw InvalidArgumentError("Cannot train: training data has "
-					   "uneven set of features. Make sure "
-					   "that you are using the same set "
-					   "of Features for all the queries");
-	    }
-	}
-    }
+    vector<double> new_parameters(queries[0].get_fcount(), 0.0);
+
     // iterations
     for (int iter_num = 1; iter_num <= iterations; ++iter_num) {
-	for (auto& item : training_data) {
+	for (auto& item : queries) {
 	    // Initialize probability distributions of y and z.
 	    prob_distrib_vector prob = init_probability(item, new_parameters);
 	    // Compute gradient
@@ -202,16 +193,19 @@ ListNETRanker::load_model_from_metadata(const string & model_key) {
 std::vector<FeatureVector>
 ListNETRanker::rank_fvv(const std::vector<FeatureVector> & fvv) const {
     LOGCALL(API, std::vector<FeatureVector>, "ListNETRanker::rank_fvv", fvv);
-    std::vector<FeatureVector> testfvv = fvv;
-    for (size_t i = 0; i < testfvv.size(); ++i) {
-	double listnet_score = 0;
-	std::vector<double> fvals = testfvv[i].get_fvals();
-	if (fvals.size() != parameters.size())
+    for (auto&& fv : fvv) {
+	if (size_t(fv.get_fcount()) != parameters.size())
 	    throw LetorInternalError("Model incompatible. Make sure that you are using "
 				     "the same set of Features using which the model was created.");
+    }
+    std::vector<FeatureVector> testfvv = fvv;
+    for (auto&& fv : testfvv) {
+	// get_fvals() returns a copy, so only call it once per document.
+	const std::vector<double> fvals = fv.get_fvals();
+	double listnet_score = 0;
 	for (size_t j = 0; j < fvals.size(); ++j)
 	    listnet_score += fvals[j] * parameters[j];
-	testfvv[i].set_score(listnet_score);
+	fv.set_score(listnet_score);
     }
     return testfvv;
 }
@@ -23,6 +23,8 @@
 
 #include "api_letor.h"
 
+#include <algorithm>
+#include <cmath>
 #include <cstdlib>
 #include <fstream>
 #include <sstream>
@@ -269,6 +271,52 @@ DEFINE_TESTCASE(createfeaturevectorthree, generated)
     TEST_EQUAL(fv[1].get_fcount(), 19);
 }
 
+/// Check feature values for a query with title and body terms.
+DEFINE_TESTCASE(createfeaturevectortf, generated)
+{
+    vector<Xapian::Feature*> f;
+    f.push_back(new Xapian::TfFeature());
+    Xapian::FeatureList fl(f);
+    Xapian::Database db = get_database("db_index_three_documents",
+				       db_index_three_documents);
+    const char* terms[] = { "Sscore", "XDscore", "score", "tigers" };
+    Xapian::Query query(Xapian::Query::OP_OR, terms, terms + 4);
+    Xapian::Enquire enquire(db);
+    enquire.set_query(query);
+    Xapian::MSet mset = enquire.get_mset(0, 10);
+    TEST_EQUAL(mset.size(), 3);
+    auto fv = fl.create_feature_vectors(mset, query, db);
+    TEST_EQUAL(fv.size(), 3);
+
+    // Calculate the expected values by looking up each term separately.
+    vector<vector<double>> expected;
+    vector<double> max_values(4);
+    for (Xapian::MSetIterator i = mset.begin(); i != mset.end(); ++i) {
+	Xapian::Document doc = i.get_document();
+	vector<double> values(4);
+	for (const char* term : terms) {
+	    Xapian::TermIterator t = doc.termlist_begin();
+	    t.skip_to(term);
+	    if (t == doc.termlist_end() || *t != term) continue;
+	    double v = log10(1 + t.get_wdf());
+	    values[term[0] == 'S' ? 0 : 1] += v;
+	    values[2] += v;
+	}
+	values[3] = i.get_weight();
+	for (size_t j = 0; j != values.size(); ++j)
+	    max_values[j] = max(max_values[j], values[j]);
+	expected.push_back(values);
+    }
+    for (size_t k = 0; k != fv.size(); ++k) {
+	TEST_EQUAL(fv[k].get_fcount(), 4);
+	for (size_t j = 0; j != 4; ++j) {
+	    double e = expected[k][j];
+	    if (max_values[j] != 0.0) e /= max_values[j];
+	    TEST_EQUAL_DOUBLE(fv[k].get_feature_value(j), e);
+	}
+    }
+}
+
 DEFINE_TESTCASE(emptyfeaturelist, !backend)
 {
     vector<Xapian::Feature*> f;
@@ -905,6 +953,44 @@ DEFINE_TESTCASE(different_no_features, generated && path && writable)
 		   ranker.train_model(training_data, "ListNet_Ranker"));
 }
 
+// Check the rankers reject training data and models which don't match the
+// features used.
+DEFINE_TESTCASE(rankerfeatures1, generated && path && writable)
+{
+    string db_path = get_database_path("db_index_two_documents",
+				       db_index_two_documents);
+    Xapian::Enquire enquire((Xapian::Database(db_path)));
+    enquire.set_query(Xapian::Query("lions"));
+    string data_directory = test_driver::get_srcdir() + "/testdata/";
+    string training_data = data_directory + "training_data.txt";
+    // The model is trained on 19 features, so ranking using just one
+    // feature should fail.
+    vector<Xapian::Feature*> f;
+    f.push_back(new Xapian::TfFeature());
+    Xapian::FeatureList flist(f);
+
+    Xapian::ListNETRanker listnet;
+    listnet.set_database_path(db_path);
+    listnet.set_query(Xapian::Query("lions"));
+    listnet.train_model(training_data, "ListNet_Ranker");
+    Xapian::MSet mset = enquire.get_mset(0, 10);
+    TEST_EXCEPTION(Xapian::LetorInternalError,
+		   listnet.rank(mset, "ListNet_Ranker", flist));
+
+    Xapian::ListMLERanker listmle;
+    listmle.set_database_path(db_path);
+    listmle.set_query(Xapian::Query("lions"));
+    listmle.train_model(training_data, "ListMLE_Ranker");
+    mset = enquire.get_mset(0, 10);
+    TEST_EXCEPTION(Xapian::InvalidArgumentError,
+		   listmle.rank(mset, "ListMLE_Ranker", flist));
+
+    string uneven_data = data_directory +
+			 "training_data_different_no_features.txt";
+    TEST_EXCEPTION(Xapian::InvalidArgumentError,
+		   listmle.train_model(uneven_data, "ListMLE_Ranker"));
+}
+
 // Test createfeaturevector method for TfFeature
 DEFINE_TESTCASE(createfeaturevector_tffeature, generated)
 {